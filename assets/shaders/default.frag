@@ -3,8 +3,10 @@
 #extension GL_ARB_shader_storage_buffer_object : require
 #extension GL_ARB_shader_image_load_store : require
 #extension GL_ARB_gpu_shader_int64 : enable
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(set = 0, binding = 2) uniform sampler2D textures[256];
+// Bindless texture array (only slots of existing textures are written)
+layout(set = 0, binding = 2) uniform sampler2D textures[];
 
 layout(location = 0) in VS_OUT
 {
@@ -21,7 +23,7 @@ layout(location = 0) out vec4 outColor;
 void
 main(void)
 {
-    vec4 base = texture(textures[fs_in.fDiffSampl], fs_in.fTexCoord);
-    vec4 mask = texture(textures[fs_in.fExtraSampl], fs_in.fTexCoord);
+    vec4 base = texture(textures[nonuniformEXT(fs_in.fDiffSampl)], fs_in.fTexCoord);
+    vec4 mask = texture(textures[nonuniformEXT(fs_in.fExtraSampl)], fs_in.fTexCoord);
     outColor = fs_in.fColor * base * mask;
 }
@@ -11,11 +11,19 @@ layout(set = 0, binding = 0) uniform UniformBufferObject
 }
 ubo;
 
+// Packed 2D instance (see PerInstanceBuffer in types.hpp)
 struct BufferData
 {
-   mat4 modelMat;
-   vec4 color;
-   vec4 texSamples;
+   vec2 position;
+   vec2 halfSize;
+   // sin and cos of the rotation angle
+   vec2 rotation;
+   // RGBA8
+   uint color;
+   // Diffuse (low 16 bits) and extra (high 16 bits) texture IDs
+   uint textures;
+   // Offset (x) and scale (y) of texture coordinates, 2x unorm16 each
+   uvec2 uvRect;
 };
 
 layout(std430, set = 0, binding = 1) readonly buffer Block
@@ -23,8 +31,15 @@ layout(std430, set = 0, binding = 1) readonly buffer Block
    BufferData Transforms[];
 };
 
+// Sprites that passed the view culling, listed from layer's first slot
+layout(std430, set = 0, binding = 3) readonly buffer VisibleBlock
+{
+   uint VisibleInstances[];
+};
+
+// Unit quad, shared by all sprites (its z is the layer's depth)
 layout(location = 0) in vec3 a_position;
-layout(location = 1) in vec3 a_texCoordDrawID;
+layout(location = 1) in vec3 a_texCoord;
 
 layout(location = 0) out VS_OUT
 {
@@ -43,17 +58,25 @@ layout (push_constant) uniform PushConstants {
 void
 main(void)
 {
-   float drawID = a_texCoordDrawID.z;
-   BufferData curInstanceData = Transforms[int(drawID)];
+   // Layers are drawn with firstInstance at their first slot, so this is sprite's entry
+   // in the list of visible instances
+   BufferData curInstanceData = Transforms[VisibleInstances[gl_InstanceIndex]];
 
-   vs_out.fTexCoord = a_texCoordDrawID.xy;
-   vs_out.fColor = curInstanceData.color;
+   // Sprites packed into an atlas only sample their region of the page
+   vec2 uvOffset = unpackUnorm2x16(curInstanceData.uvRect.x);
+   vec2 uvScale = unpackUnorm2x16(curInstanceData.uvRect.y);
+   vs_out.fTexCoord = uvOffset + a_texCoord.xy * uvScale;
+   vs_out.fColor = unpackUnorm4x8(curInstanceData.color);
 
-   vs_out.fDiffSampl = int(curInstanceData.texSamples.x);
-   vs_out.fExtraSampl = int(curInstanceData.texSamples.y);
+   vs_out.fDiffSampl = int(curInstanceData.textures & 0xFFFFu);
+   vs_out.fExtraSampl = int(curInstanceData.textures >> 16);
 
-   mat4 modelMat = curInstanceData.modelMat;
-   vec3 position = a_position;
+   // Unit quad spans [-0.5, 0.5], scale it to sprite's size, rotate and translate
+   vec2 scaled = a_position.xy * 2.0f * curInstanceData.halfSize;
+   float s = curInstanceData.rotation.x;
+   float c = curInstanceData.rotation.y;
+   vec2 position = vec2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c)
+                   + curInstanceData.position;
 
-   gl_Position = ubo.u_projectionMat * ubo.u_viewMat * modelMat * vec4(position.xyz, 1.0f);
+   gl_Position = ubo.u_projectionMat * ubo.u_viewMat * vec4(position, a_position.z, 1.0f);
 }
@@ -2,12 +2,17 @@
 #include "enemy.hpp"
 #include "game.hpp"
 #include "input_manager.hpp"
+#include "level_binary.hpp"
+#include "level_journal.hpp"
+#include "navigation_bake.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/shader.hpp"
 #include "renderer/sprite.hpp"
+#include "renderer/texture.hpp"
 #include "renderer/vulkan_common.hpp"
 #include "renderer/window/window.hpp"
 #include "utils/file_manager.hpp"
+#include "utils/hash.hpp"
 #include "utils/time/scoped_timer.hpp"
 #include "utils/time/stopwatch.hpp"
 
@@ -15,6 +20,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vulkan/vulkan.h>
 
+#include <filesystem>
 #include <memory>
 #include <set>
 #include <string>
@@ -138,7 +144,8 @@ Editor::MouseScrollCallback(MouseScrollEvent& event)
 void
 Editor::MouseButtonCallback(MouseButtonEvent& event)
 {
-   if (playGame_ or EditorGUI::IsBlockingEvents() or not levelLoaded_)
+   // Objects can't be selected/modified until the level is fully loaded
+   if (playGame_ or EditorGUI::IsBlockingEvents() or not levelLoaded_ or IsLevelLoading())
    {
       return;
    }
@@ -948,6 +955,8 @@ Editor::ActionOnObject(Editor::ACTION action, Object::ID object)
                   stl::find_if(animationPoints_, [object](const auto& animationPoint) {
                      return animationPoint.GetID() == object;
                   });
+               currentLevel_->ObjectModified(currentySelectedObj.GetLinkedObjectID());
+
                animationIt->GetSprite().ClearData();
                animationPoints_.erase(animationIt);
             }
@@ -975,11 +984,16 @@ Editor::ActionOnObject(Editor::ACTION action, Object::ID object)
 }
 
 void
-Editor::Render(VkCommandBuffer cmdBuffer)
+Editor::Render(std::vector< renderer::DrawPass >& passes)
 {
+   // Every layer is a separate pass, followed by lines and UI
+   constexpr uint32_t linesPass = renderer::NUM_LAYERS;
+   constexpr uint32_t uiPass = renderer::NUM_LAYERS + 1;
+
    if (levelLoaded_)
    {
-      auto& renderData = renderer::Data::renderData_[renderer::GetCurrentlyBoundType()];
+      const auto& renderData = renderer::Data::renderData_[renderer::GetCurrentlyBoundType()];
+      const auto frame = renderer::Data::currentFrame_;
 
       currentLevel_->GetSprite().Render();
 
@@ -989,13 +1003,6 @@ Editor::Render(VkCommandBuffer cmdBuffer)
 
       gizmo_.Render();
 
-
-      vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipeline);
-
-      auto offsets = std::to_array< const VkDeviceSize >({0});
-      vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipelineLayout,
-                              0, 1, &renderData.descriptorSets[renderer::Data::currentFrame_], 0,
-                              nullptr);
       renderer::QuadShader::PushConstants pushConstants = {};
       pushConstants.selectedIdx = -1.0f;
 
@@ -1006,14 +1013,20 @@ Editor::Render(VkCommandBuffer cmdBuffer)
          pushConstants.selectedIdx = static_cast< float >(tmpIdx);
       }
 
-      vkCmdPushConstants(cmdBuffer, renderData.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                         sizeof(renderer::QuadShader::PushConstants), &pushConstants);
+      // Draw parameters are in the indirect buffer, so layers are only recorded again
+      // when one of the bound objects (or the selection) changes
+      auto quadKey = utils::HashValue(renderData.pipeline);
+      quadKey = utils::HashValue(renderData.descriptorSets[frame], quadKey);
+      quadKey = utils::HashValue(renderData.quadVertexBuffer.buffer_, quadKey);
+      quadKey = utils::HashValue(renderData.quadIndexBuffer.buffer_, quadKey);
+      quadKey = utils::HashValue(renderData.indirectDrawBuffer.at(frame).buffer_, quadKey);
+      quadKey = utils::HashValue(pushConstants, quadKey);
 
       const auto renderAllLayers = renderLayerToDraw_ == -1;
       for (int32_t layer = renderer::NUM_LAYERS - 1; layer >= 0; --layer)
       {
          const auto idx = static_cast< size_t >(layer);
-         const auto& numObjects = renderData.numMeshes.at(idx);
+         const auto& numObjects = renderData.numVisible.at(idx);
 
          const auto renderThisLayer =
             (renderAllLayers or layer == 0) ? true : renderLayerToDraw_ == layer;
@@ -1023,49 +1036,88 @@ Editor::Render(VkCommandBuffer cmdBuffer)
             continue;
          }
 
-         vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderData.vertexBuffer.at(idx).buffer_,
-                                offsets.data());
+         // Visible sprites of the layer, commands are stored far layer first
+         const auto commandIdx = renderer::NUM_LAYERS - 1 - idx;
+         const auto record = [&renderData, frame, pushConstants,
+                              commandIdx](VkCommandBuffer cmdBuffer) {
+            vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipeline);
 
-         vkCmdBindIndexBuffer(cmdBuffer, renderData.indexBuffer.at(idx).buffer_, 0,
-                              VK_INDEX_TYPE_UINT32);
+            auto offsets = std::to_array< const VkDeviceSize >({0});
+            vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    renderData.pipelineLayout, 0, 1,
+                                    &renderData.descriptorSets[frame], 0, nullptr);
 
-         vkCmdDrawIndexed(cmdBuffer, numObjects * renderer::INDICES_PER_SPRITE, 1, 0, 0, 0);
+            vkCmdPushConstants(cmdBuffer, renderData.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                               0, sizeof(renderer::QuadShader::PushConstants), &pushConstants);
+
+            vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderData.quadVertexBuffer.buffer_,
+                                   offsets.data());
+            vkCmdBindIndexBuffer(cmdBuffer, renderData.quadIndexBuffer.buffer_, 0,
+                                 VK_INDEX_TYPE_UINT32);
+
+            vkCmdDrawIndexedIndirect(cmdBuffer, renderData.indirectDrawBuffer.at(frame).buffer_,
+                                     commandIdx * sizeof(VkDrawIndexedIndirectCommand), 1,
+                                     sizeof(VkDrawIndexedIndirectCommand));
+         };
+
+         passes.push_back({static_cast< uint32_t >(layer), quadKey, record});
       }
 
       // DRAW LINES
-      vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                        renderer::EditorData::linePipeline_);
+      const auto numGridLines = renderer::EditorData::numGridLines;
+      const auto numDynamicIndices = renderer::EditorData::curDynLineIdx;
+      const auto drawGrid = drawGrid_;
+
+      auto linesKey = utils::HashValue(renderer::EditorData::linePipeline_);
+      linesKey = utils::HashValue(renderer::EditorData::lineVertexBuffer.buffer_, linesKey);
+      linesKey = utils::HashValue(renderer::EditorData::lineIndexBuffer.buffer_, linesKey);
+      linesKey =
+         utils::HashValue(renderer::EditorData::lineDescriptorSets_[frame], linesKey);
+      linesKey = utils::HashValue(numGridLines, linesKey);
+      linesKey = utils::HashValue(numDynamicIndices, linesKey);
+      linesKey = utils::HashValue(drawGrid, linesKey);
+
+      const auto recordLines = [frame, numGridLines, numDynamicIndices,
+                                drawGrid](VkCommandBuffer cmdBuffer) {
+         vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                           renderer::EditorData::linePipeline_);
+
+         auto offsets = std::to_array< const VkDeviceSize >({0});
+         vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderer::EditorData::lineVertexBuffer.buffer_,
+                                offsets.data());
 
-      vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderer::EditorData::lineVertexBuffer.buffer_,
-                             offsets.data());
+         vkCmdBindIndexBuffer(cmdBuffer, renderer::EditorData::lineIndexBuffer.buffer_, 0,
+                              VK_INDEX_TYPE_UINT32);
 
-      vkCmdBindIndexBuffer(cmdBuffer, renderer::EditorData::lineIndexBuffer.buffer_, 0,
-                           VK_INDEX_TYPE_UINT32);
+         vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                 renderer::EditorData::linePipelineLayout_, 0, 1,
+                                 &renderer::EditorData::lineDescriptorSets_[frame], 0, nullptr);
 
-      vkCmdBindDescriptorSets(
-         cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderer::EditorData::linePipelineLayout_, 0,
-         1, &renderer::EditorData::lineDescriptorSets_[renderer::Data::currentFrame_], 0, nullptr);
+         renderer::LineShader::PushConstants linePushConstants = {};
+         linePushConstants.color = glm::vec4(0.4f, 0.5f, 0.6f, static_cast< float >(drawGrid));
 
-      renderer::LineShader::PushConstants linePushConstants = {};
-      linePushConstants.color = glm::vec4(0.4f, 0.5f, 0.6f, static_cast< float >(drawGrid_));
+         vkCmdPushConstants(cmdBuffer, renderer::EditorData::linePipelineLayout_,
+                            VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                            sizeof(renderer::LineShader::PushConstants), &linePushConstants);
 
-      vkCmdPushConstants(cmdBuffer, renderer::EditorData::linePipelineLayout_,
-                         VK_SHADER_STAGE_FRAGMENT_BIT, 0,
-                         sizeof(renderer::LineShader::PushConstants), &linePushConstants);
+         vkCmdDrawIndexed(cmdBuffer, numGridLines * renderer::INDICES_PER_LINE, 1, 0, 0, 0);
 
-      vkCmdDrawIndexed(cmdBuffer, renderer::EditorData::numGridLines * renderer::INDICES_PER_LINE,
-                       1, 0, 0, 0);
+         // DYNAMIC LINES
+         linePushConstants.color = glm::vec4(0.5f, 0.0f, 0.0f, 1.0f);
+         vkCmdPushConstants(cmdBuffer, renderer::EditorData::linePipelineLayout_,
+                            VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                            sizeof(renderer::LineShader::PushConstants), &linePushConstants);
+         vkCmdDrawIndexed(cmdBuffer, numDynamicIndices, 1,
+                          numGridLines * renderer::INDICES_PER_LINE, 0, 0);
+      };
 
-      // DYNAMIC LINES
-      linePushConstants.color = glm::vec4(0.5f, 0.0f, 0.0f, 1.0f);
-      vkCmdPushConstants(cmdBuffer, renderer::EditorData::linePipelineLayout_,
-                         VK_SHADER_STAGE_FRAGMENT_BIT, 0,
-                         sizeof(renderer::LineShader::PushConstants), &linePushConstants);
-      vkCmdDrawIndexed(cmdBuffer, renderer::EditorData::curDynLineIdx, 1,
-                       renderer::EditorData::numGridLines * renderer::INDICES_PER_LINE, 0, 0);
+      passes.push_back({linesPass, linesKey, recordLines});
    }
 
-   gui_.Render(cmdBuffer);
+   // UI changes every frame, its buffers are filled here and only the recording is deferred
+   gui_.UpdateBuffers();
+   passes.push_back({uiPass, renderer::DrawPass::ALWAYS_RECORD,
+                     [this](VkCommandBuffer cmdBuffer) { gui_.Render(cmdBuffer); }});
 }
 
 void
@@ -1212,6 +1264,8 @@ Editor::FreeLevelData()
          UnselectGameObject(currentSelectedGameObject_, false);
       }
 
+      FinishLevelSaving();
+      levelLoader_.reset();
       currentLevel_.reset();
       pathfinderNodes_.clear();
       animationPoints_.clear();
@@ -1235,6 +1289,9 @@ Editor::CreateLevel(const std::string& name, const glm::ivec2& size)
    levelFileName_ = (LEVELS_DIR / (name + ".dgl")).string();
    gui_.LevelLoaded(currentLevel_);
 
+   // New level doesn't have a file yet, so the first save has to write it whole
+   currentLevel_->EnableChangeTracking({}, true);
+
    currentLevel_->GenerateTextureForCollision();
 
    SetupRendererData();
@@ -1243,20 +1300,26 @@ Editor::CreateLevel(const std::string& name, const glm::ivec2& size)
 void
 Editor::LoadLevel(const std::string& levelPath)
 {
+   if (!CanLoadLevelFile(levelPath))
+   {
+      Logger::Warn("Level {} uses an outdated binary format and can't be loaded!", levelPath);
+      return;
+   }
+
    FreeLevelData();
 
    renderer::SetAppMarker(renderer::ApplicationType::EDITOR);
 
    {
-      SCOPED_TIMER("Total level load");
+      SCOPED_TIMER("Level environment load");
 
       levelFileName_ = levelPath;
 
       // Should we actually compute total num points?
       animationPoints_.reserve(1000);
 
-      currentLevel_ = std::make_shared< Level >();
-      currentLevel_->Load(this, levelPath);
+      // Objects are loaded over the next frames (see 'LevelLoaded')
+      StartLevelLoading(levelPath);
 
       {
          SCOPED_TIMER("Animation points setup");
@@ -1283,18 +1346,7 @@ Editor::LoadLevel(const std::string& levelPath)
 
       levelLoaded_ = true;
 
-      // for (const auto obj : currentLevel_->GetObjects())
-      //{
-      //    gui_.ObjectAdded(obj.GetID());
-      // }
-      // for (const auto enemy : currentLevel_->GetEnemies())
-      //{
-      //    gui_.ObjectAdded(enemy.GetID());
-      // }
-      // gui_.ObjectAdded(currentLevel_->GetPlayer().GetID());
-
-      gui_.LevelLoaded(currentLevel_);
-
+      // Collision texture is updated as the objects get loaded
       currentLevel_->GenerateTextureForCollision();
 
       window_.MakeFocus();
@@ -1305,14 +1357,118 @@ Editor::LoadLevel(const std::string& levelPath)
    SetupRendererData();
 }
 
+void
+Editor::LevelLoaded()
+{
+   // for (const auto obj : currentLevel_->GetObjects())
+   //{
+   //    gui_.ObjectAdded(obj.GetID());
+   // }
+   // for (const auto enemy : currentLevel_->GetEnemies())
+   //{
+   //    gui_.ObjectAdded(enemy.GetID());
+   // }
+   // gui_.ObjectAdded(currentLevel_->GetPlayer().GetID());
+
+   gui_.LevelLoaded(currentLevel_);
+
+   // Journal (if present) was applied on load, so the level differs from its file
+   const auto recovered = HasLevelJournal(levelFileName_);
+   if (recovered)
+   {
+      Logger::Info("Editor: Recovered unsaved changes for {}", levelFileName_);
+   }
+
+   currentLevel_->EnableChangeTracking(levelFileName_, recovered);
+}
+
 void
 Editor::SaveLevel(const std::string& levelPath)
 {
+   // Make sure we don't save partially loaded level
+   FinishLevelLoading();
+   FinishLevelSaving();
+
    levelFileName_ = levelPath;
-   currentLevel_->Save(levelFileName_);
+   StartLevelSaving(levelFileName_);
    gui_.SaveConfigFile();
 }
 
+bool
+Editor::IsLevelSaving() const
+{
+   return levelSaver_ != nullptr;
+}
+
+float
+Editor::GetLevelSaveProgress() const
+{
+   return levelSaver_ ? levelSaver_->GetProgress() : 1.0f;
+}
+
+void
+Editor::SetAutosave(bool autosave)
+{
+   autosave_ = autosave;
+   autosaveTimer_ = 0.0f;
+}
+
+bool
+Editor::GetAutosave() const
+{
+   return autosave_;
+}
+
+void
+Editor::BakeNavigation()
+{
+   FinishLevelLoading();
+
+   if (currentLevel_->HasUnsavedChanges() or !std::filesystem::exists(levelFileName_))
+   {
+      SaveLevel(levelFileName_);
+   }
+   FinishLevelSaving();
+
+   BakeNavigationFile(levelFileName_, currentLevel_->GetTileSize());
+}
+
+void
+Editor::StartLevelSaving(const std::string& levelPath)
+{
+   // Updating only the modified objects is fast enough to be done right away
+   if (!currentLevel_->SaveInPlace(levelPath))
+   {
+      levelSaver_ = std::make_unique< LevelSaver >(GetThreadPool(), currentLevel_, levelPath);
+   }
+
+   autosaveTimer_ = 0.0f;
+}
+
+void
+Editor::FinishLevelSaving()
+{
+   if (levelSaver_)
+   {
+      levelSaver_->Finish();
+      levelSaver_.reset();
+   }
+}
+
+void
+Editor::Autosave()
+{
+   // Level that was never saved doesn't have a file to save into yet
+   if (!autosave_ or !levelLoaded_ or IsLevelLoading() or IsLevelSaving()
+       or !currentLevel_->HasUnsavedChanges() or !std::filesystem::exists(levelFileName_))
+   {
+      return;
+   }
+
+   Logger::Debug("Editor: Autosaving {}", levelFileName_);
+   StartLevelSaving(levelFileName_);
+}
+
 void
 Editor::AddGameObject(ObjectType objectType, const glm::vec2& position)
 {
@@ -1382,6 +1538,7 @@ Editor::AddObject(ObjectType objectType)
    auto& newObject = animationPoints_.emplace_back(this, newNode.m_end, glm::ivec2(20, 20),
                                                    "NodeSprite.png", newNode.GetID());
    animatable.ResetAnimation();
+   currentLevel_->ObjectModified(currentSelectedGameObject_);
 
    shouldUpdateRenderer_ = true;
 
@@ -1403,9 +1560,15 @@ Editor::IsObjectAnimated() const
 void
 Editor::PlayLevel()
 {
-   // TODO: For future we'd want to check if anything got changed,
-   //       so we don't always save (this can get costly later!)
-   currentLevel_->Save(levelFileName_);
+   FinishLevelLoading();
+   FinishLevelSaving();
+
+   // Game loads the level from file, so save it only if anything got changed
+   if (currentLevel_->HasUnsavedChanges())
+   {
+      currentLevel_->Save(levelFileName_);
+   }
+
    playGame_ = true;
 }
 
@@ -1508,6 +1671,7 @@ Editor::Update()
    renderData.projMat = camera_.projectionMatrix_;
    renderData.projNoZoomMat = camera_.projectionWithoutZoom_;
 
+   renderer::TextureLibrary::UpdateResidency(threadPool_);
    renderer::UpdateData();
 }
 
@@ -1522,6 +1686,7 @@ Editor::UpdateAnimationData(Object::ID object)
    {
       animatable->SetAnimationStartLocation(gameObject.GetPosition());
       animatable->UpdateAnimationData();
+      currentLevel_->ObjectModified(object);
    }
 }
 
@@ -1586,6 +1751,17 @@ Editor::MainLoop()
 
             Update();
 
+            // Persist this frame's changes, so they can be recovered after a crash
+            if (levelLoaded_)
+            {
+               currentLevel_->WriteJournal();
+            }
+
+            if (levelSaver_ and levelSaver_->IsFinished())
+            {
+               FinishLevelSaving();
+            }
+
             const time::ScopedTimer renderTimer(&renderTime_);
             renderer::Render(this);
          }
@@ -1602,6 +1778,13 @@ Editor::MainLoop()
          ++frames_;
          frameTimer_ += TARGET_TIME_S;
 
+         autosaveTimer_ += TARGET_TIME_S;
+         if (autosaveTimer_ >= AUTOSAVE_INTERVAL_S)
+         {
+            autosaveTimer_ = 0.0f;
+            Autosave();
+         }
+
          renderer::EditorData::curDynLineIdx = 0;
          if (levelLoaded_ and currentLevel_->GetPathfinder().IsInitialized())
          {
@@ -1617,6 +1800,8 @@ Editor::MainLoop()
          timer_.ToggleTimer();
       }
    }
+
+   renderer::FreeData(renderer::ApplicationType::EDITOR, true);
 }
 
 } // namespace looper
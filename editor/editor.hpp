@@ -5,6 +5,7 @@
 #include "gizmo.hpp"
 #include "gui/editor_gui.hpp"
 #include "level.hpp"
+#include "level_saver.hpp"
 #include "logger.hpp"
 #include "object.hpp"
 #include "player.hpp"
@@ -67,7 +68,7 @@ class Editor : public Application
    MouseScrollCallback(MouseScrollEvent& event) override;
 
    void
-   Render(VkCommandBuffer cmdBuffer) override;
+   Render(std::vector< renderer::DrawPass >& passes) override;
 
    // EDITOR SPECIFIC FUNCTIONS
    void
@@ -79,6 +80,30 @@ class Editor : public Application
    void
    SaveLevel(const std::string& levelPath);
 
+   [[nodiscard]] bool
+   IsLevelSaving() const;
+
+   /**
+    * \brief Get progress of the level save that's running in the background
+    *
+    * \return Value in range [0, 1]
+    */
+   [[nodiscard]] float
+   GetLevelSaveProgress() const;
+
+   void
+   SetAutosave(bool autosave);
+
+   [[nodiscard]] bool
+   GetAutosave() const;
+
+   /**
+    * \brief Bake navigation data for the current level (see navigation_bake.hpp).
+    * The bake is made from the level file, so the level is saved first if it has unsaved changes.
+    */
+   void
+   BakeNavigation();
+
    void
    AddGameObject(ObjectType objectType, const glm::vec2& position);
 
@@ -171,13 +196,6 @@ class Editor : public Application
    AddToWorkQueue(
       const WorkQueue::WorkUnit& work, const WorkQueue::Precondition& prec = [] { return true; });
 
-   template < class F, class... Args >
-   auto
-   AddToThreadPool(F&& f, Args&&... args)
-   {
-      return threadPool_.enqueue(std::forward< F >(f), std::forward< Args >(args)...);
-   }
-
    void
    Shutdown();
 
@@ -220,6 +238,9 @@ class Editor : public Application
    [[nodiscard]] bool
    IsRunning() const override;
 
+   void
+   LevelLoaded() override;
+
    void
    HandleMouseDrag(const glm::vec2& currentCursorPos, const glm::vec2& axis);
 
@@ -256,11 +277,30 @@ class Editor : public Application
    void
    FreeLevelData();
 
+   // Save the level in place if possible, otherwise start saving it in the background
+   void
+   StartLevelSaving(const std::string& levelPath);
+
+   // Wait for the background save (if any) to finish
+   void
+   FinishLevelSaving();
+
+   void
+   Autosave();
+
    void
    RecalculateGizmoPos();
 
    std::string levelFileName_ = {};
 
+   // Level save running in the background
+   std::unique_ptr< LevelSaver > levelSaver_ = nullptr;
+
+   // Level with unsaved changes is saved every 'AUTOSAVE_INTERVAL_S' seconds
+   static constexpr float AUTOSAVE_INTERVAL_S = 60.0f;
+   bool autosave_ = true;
+   float autosaveTimer_ = 0.0f;
+
    bool isRunning_ = true;
    bool levelLoaded_ = false;
    bool shouldUpdateRenderer_ = false;
@@ -308,7 +348,6 @@ class Editor : public Application
    time::TimeStep uiTime_ = time::TimeStep{time::microseconds{}};
    time::TimeStep renderTime_ = time::TimeStep{time::microseconds{}};
 
-   ThreadPool threadPool_ = ThreadPool{std::thread::hardware_concurrency()};
    std::future< void > updateReady_;
    std::future< void > renderReady_;
 
@@ -67,13 +67,14 @@ EditorGUI::UpdateGroupForSelection(const std::string& groupName)
    if (currentlySelectedGameObject_ != Object::INVALID_ID)
    {
       auto& objRef = parent_.GetLevel().GetGameObjectRef(currentlySelectedGameObject_);
-      if (objRef.editorGroup_ != groupName)
+      if (objRef.GetEditorGroup() != groupName)
       {
-         auto& group = groups_.at(objRef.editorGroup_);
+         auto& group = groups_.at(objRef.GetEditorGroup());
          group.erase(stl::find(group, currentlySelectedGameObject_));
 
          groups_.at(groupName).push_back(currentlySelectedGameObject_);
-         objRef.editorGroup_ = groupName;
+         objRef.SetEditorGroup(groupName);
+         parent_.GetLevel().ObjectModified(currentlySelectedGameObject_);
          stl::find_if(selectedObjects_, [this](const auto& obj) {
             return obj.ID == currentlySelectedGameObject_;
          })->group = groupName;
@@ -84,7 +85,7 @@ EditorGUI::UpdateGroupForSelection(const std::string& groupName)
       for (auto& object : selectedObjects_)
       {
          auto& objRef = parent_.GetLevel().GetGameObjectRef(object.ID);
-         if (objRef.editorGroup_ == groupName)
+         if (objRef.GetEditorGroup() == groupName)
          {
             continue;
          }
@@ -94,7 +95,8 @@ EditorGUI::UpdateGroupForSelection(const std::string& groupName)
 
          groups_.at(groupName).push_back(object.ID);
          object.group = groupName;
-         objRef.editorGroup_ = groupName;
+         objRef.SetEditorGroup(groupName);
+         parent_.GetLevel().ObjectModified(object.ID);
       }
    }
 
@@ -109,7 +111,8 @@ EditorGUI::DeleteGroup(const std::string& groupName)
    for (auto obj : objs)
    {
       auto& objRef = parent_.GetLevel().GetGameObjectRef(obj);
-      objRef.editorGroup_ = "Default";
+      objRef.SetEditorGroup("Default");
+      parent_.GetLevel().ObjectModified(obj);
       groups_.at("Default").push_back(obj);
    }
 
@@ -187,7 +190,8 @@ EditorGUI::EditGroup(const std::string& oldName)
       const auto& objects = groups_.at(oldName);
       for (auto obj : objects)
       {
-         parent_.GetLevel().GetGameObjectRef(obj).editorGroup_ = newName;
+         parent_.GetLevel().GetGameObjectRef(obj).SetEditorGroup(newName);
+         parent_.GetLevel().ObjectModified(obj);
       }
 
       *(stl::find(groupNames_, oldName)) = newName;
@@ -315,6 +319,16 @@ EditorGUI::UpdateUI()
       RenderExitWindow();
    }
 
+   if (parent_.IsLevelLoading())
+   {
+      RenderLevelLoadingWindow();
+   }
+
+   if (parent_.IsLevelSaving())
+   {
+      RenderLevelSavingWindow();
+   }
+
    ImGui::Render();
 
    setScrollTo_ = {};
@@ -333,7 +347,7 @@ EditorGUI::LevelLoaded(const std::shared_ptr< Level >& loadedLevel)
                      object.GetName().c_str(), object.GetPosition().x, object.GetPosition().y),
          false};
 
-      groups_[object.editorGroup_].emplace_back(object.GetID());
+      groups_[object.GetEditorGroup()].emplace_back(object.GetID());
    }
 
    const auto& enemies = currentLevel_->GetEnemies();
@@ -344,7 +358,7 @@ EditorGUI::LevelLoaded(const std::shared_ptr< Level >& loadedLevel)
                      enemy.GetName().c_str(), enemy.GetPosition().x, enemy.GetPosition().y),
          false};
 
-      groups_[enemy.editorGroup_].emplace_back(enemy.GetID());
+      groups_[enemy.GetEditorGroup()].emplace_back(enemy.GetID());
    }
 
    const auto& player = currentLevel_->GetPlayer();
@@ -355,7 +369,7 @@ EditorGUI::LevelLoaded(const std::shared_ptr< Level >& loadedLevel)
                      player.GetName().c_str(), player.GetPosition().x, player.GetPosition().y),
          false};
 
-      groups_[player.editorGroup_].emplace_back(player.GetID());
+      groups_[player.GetEditorGroup()].emplace_back(player.GetID());
    }
 
    LoadConfigFile();
@@ -364,11 +378,11 @@ EditorGUI::LevelLoaded(const std::shared_ptr< Level >& loadedLevel)
 void
 EditorGUI::LoadConfigFile()
 {
-   auto fileName = parent_.GetLevelFileName();
+   const auto fileName = std::filesystem::path(parent_.GetLevelFileName());
 
-   // Load the editor configuration file
+   // Load the editor configuration file (shared by both .dgl and .dglb levels)
    auto json = FileManager::LoadJsonFile(
-      fmt::format("{}.editor.dgl", fileName.substr(0, fileName.size() - 4)));
+      fmt::format("{}.editor.dgl", (fileName.parent_path() / fileName.stem()).string()));
 
    groupNames_ = json["GROUPS"];
 }
@@ -380,9 +394,9 @@ EditorGUI::SaveConfigFile() const
 
    json["GROUPS"] = groupNames_;
 
-   auto fileName = parent_.GetLevelFileName();
-   FileManager::SaveJsonFile(fmt::format("{}.editor.dgl", fileName.substr(0, fileName.size() - 4)),
-                             json);
+   const auto fileName = std::filesystem::path(parent_.GetLevelFileName());
+   FileManager::SaveJsonFile(
+      fmt::format("{}.editor.dgl", (fileName.parent_path() / fileName.stem()).string()), json);
 }
 
 void
@@ -394,7 +408,7 @@ EditorGUI::ObjectSelected(Object::ID ID, bool groupSelect)
    const auto& gameObject = parent_.GetLevel().GetGameObjectRef(ID);
    selectedObjects_.emplace_back(SelectedObjectInfo{ID, gameObject.GetHasCollision(),
                                                     gameObject.GetSprite().GetRenderInfo().layer,
-                                                    gameObject.editorGroup_});
+                                                    gameObject.GetEditorGroup()});
 
 
    RecalculateCommonProperties();
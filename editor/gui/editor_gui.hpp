@@ -108,6 +108,12 @@ class EditorGUI : public InputListener
    void
    RenderExitWindow();
 
+   void
+   RenderLevelLoadingWindow();
+
+   void
+   RenderLevelSavingWindow();
+
    void
    RecalculateCommonProperties();
 
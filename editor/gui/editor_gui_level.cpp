@@ -18,6 +18,7 @@
 #include <imgui.h>
 #include <imgui_internal.h>
 
+#include <algorithm>
 #include <cstdint>
 
 
@@ -121,6 +122,36 @@ EditorGUI::RenderExitWindow()
    ImGui::End();
 }
 
+void
+EditorGUI::RenderLevelLoadingWindow()
+{
+   const auto halfSize = windowSize_ / 2.0f;
+
+   ImGui::SetNextWindowPos({halfSize.x - 160, halfSize.y - 40});
+   ImGui::SetNextWindowSize({320, 80});
+   ImGui::Begin("Loading level", nullptr,
+                ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove);
+
+   ImGui::ProgressBar(parent_.GetLevelLoadProgress(), ImVec2(-1.0f, 0.0f));
+
+   ImGui::End();
+}
+
+void
+EditorGUI::RenderLevelSavingWindow()
+{
+   // Editor can be used while saving, so keep the window out of the way
+   ImGui::SetNextWindowPos({windowSize_.x - 330, windowSize_.y - 60});
+   ImGui::SetNextWindowSize({320, 50});
+   ImGui::Begin("Saving level", nullptr,
+                ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove
+                   | ImGuiWindowFlags_NoFocusOnAppearing);
+
+   ImGui::ProgressBar(parent_.GetLevelSaveProgress(), ImVec2(-1.0f, 0.0f));
+
+   ImGui::End();
+}
+
 void
 EditorGUI::RenderMainPanel()
 {
@@ -145,8 +176,9 @@ EditorGUI::RenderMainPanel()
          [this] {
             if (ImGui::Button("Save", ImVec2(-FLT_MIN, -FLT_MIN)))
             {
-               auto levelName =
-                  FileManager::FileDialog(LEVELS_DIR, {{"DGame Level file", "dgl"}}, true);
+               auto levelName = FileManager::FileDialog(
+                  LEVELS_DIR, {{"DGame Level file", "dgl"}, {"DGame Binary Level file", "dglb"}},
+                  true);
                if (!levelName.empty())
                {
                   parent_.AddToWorkQueue([this, levelName] { parent_.SaveLevel(levelName); });
@@ -158,8 +190,9 @@ EditorGUI::RenderMainPanel()
          [this] {
             if (ImGui::Button("Load", ImVec2(-FLT_MIN, -FLT_MIN)))
             {
-               auto levelName =
-                  FileManager::FileDialog(LEVELS_DIR, {{"DGame Level file", "dgl"}}, false);
+               auto levelName = FileManager::FileDialog(
+                  LEVELS_DIR, {{"DGame Level file", "dgl"}, {"DGame Binary Level file", "dglb"}},
+                  false);
                if (!levelName.empty())
                {
                   parent_.AddToWorkQueue([this, levelName] { parent_.LoadLevel(levelName); });
@@ -212,6 +245,32 @@ EditorGUI::RenderLevelMenu() // NOLINT
             }
          });
 
+         CreateActionRowLabel("Autosave", [this] {
+            auto autosave = parent_.GetAutosave();
+            if (ImGui::Checkbox("##Autosave", &autosave))
+            {
+               parent_.SetAutosave(autosave);
+            }
+         });
+
+         CreateActionRowLabel("Texture budget (MB)", [] {
+            auto budget = static_cast< int32_t >(
+               renderer::TextureLibrary::GetMemoryBudget() / (1024 * 1024));
+            if (ImGui::InputInt("##Texture budget", &budget, 64, 256,
+                                ImGuiInputTextFlags_EnterReturnsTrue))
+            {
+               renderer::TextureLibrary::SetMemoryBudget(
+                  static_cast< VkDeviceSize >(std::max(budget, 64)) * 1024 * 1024);
+            }
+         });
+
+         CreateActionRowLabel("Navigation", [this] {
+            if (ImGui::Button("Bake"))
+            {
+               parent_.AddToWorkQueue([this] { parent_.BakeNavigation(); });
+            }
+         });
+
          CreateActionRowLabel("RenderLayer", [this] {
             const auto items = std::to_array< std::string >(
                {"All", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10"});
@@ -496,6 +555,10 @@ EditorGUI::RenderLevelMenu() // NOLINT
                    fmt::format("{:.2f}ms", parent_.GetRenderTime().GetMilliseconds().count()));
          CreateRow("UI Render", fmt::format("{:.2f}ms", uiRenderTime.GetMilliseconds().count()));
          CreateRow("Number of objects", fmt::format("{}", parent_.GetLevel().GetNumOfObjects()));
+         CreateRow("Texture memory",
+                   fmt::format("{} / {} MB",
+                               renderer::TextureLibrary::GetResidentMemory() / (1024 * 1024),
+                               renderer::TextureLibrary::GetMemoryBudget() / (1024 * 1024)));
          const auto cameraPos = parent_.GetCamera().GetPosition();
          CreateRow("Camera Position", fmt::format("{}", static_cast< glm::vec2 >(cameraPos)));
          CreateRow("Camera Zoom", fmt::format("{:.1f}", parent_.GetCamera().GetZoomLevel()));
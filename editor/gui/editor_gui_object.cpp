@@ -22,32 +22,74 @@
 
 namespace looper {
 
-std::unordered_map< renderer::TextureID, VkDescriptorSet > textureDescriptors = {};
+namespace {
+
+struct TextureDescriptor
+{
+   VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+   // Slot version that the set was written with (see TextureLibrary::GetSlotVersion)
+   uint32_t slotVersion = 0;
+};
+
+struct RetiredDescriptor
+{
+   VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+   uint64_t frame = 0;
+};
+
+std::unordered_map< renderer::TextureID, TextureDescriptor > textureDescriptors = {};
+// Sets whose texture's image changed, they can still be used by frames in flight
+std::vector< RetiredDescriptor > retiredDescriptors = {};
 
 VkDescriptorSet
 GetDescriptor(renderer::TextureID id, VkDescriptorPool descriptorPool,
               VkDescriptorSetLayout descriptorSetLayout)
 {
-   const auto desc = textureDescriptors.find(id);
+   // Frames that could use the retired sets are finished once the frame
+   // MAX_FRAMES_IN_FLIGHT later is prepared
+   const auto frame = renderer::GetRenderStats().numFrames;
+   std::erase_if(retiredDescriptors, [frame](const auto& retired) {
+      if (frame < retired.frame + renderer::MAX_FRAMES_IN_FLIGHT)
+      {
+         return false;
+      }
 
-   VkDescriptorSet descriptor{};
-   if (desc != textureDescriptors.end())
+      vkFreeDescriptorSets(renderer::Data::vk_device, renderer::EditorData::descriptorPool_, 1,
+                           &retired.descriptorSet);
+      return true;
+   });
+
+   // Texture is still being prefetched, show the placeholder until it's uploaded
+   if (!renderer::TextureLibrary::GetTexture(id)->IsLoaded())
    {
-      descriptor = desc->second;
+      id = renderer::TextureLibrary::GetTexture(
+              std::string{renderer::TextureLibrary::PLACEHOLDER_TEXTURE})
+              ->GetID();
    }
-   else
+
+   // Cached set is only valid while the texture's image view stays the same
+   const auto slotVersion = renderer::TextureLibrary::GetSlotVersion(id);
+   auto& descriptor = textureDescriptors[id];
+   if (descriptor.descriptorSet != VK_NULL_HANDLE and descriptor.slotVersion != slotVersion)
    {
-      auto [view, sampler] = renderer::TextureLibrary::GetTexture(id)->GetImageViewAndSampler();
-      descriptor = renderer::Texture::CreateDescriptorSet(sampler, view,
-                                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                          descriptorPool, descriptorSetLayout);
+      retiredDescriptors.push_back({descriptor.descriptorSet, frame});
+      descriptor = {};
+   }
 
-      textureDescriptors[id] = descriptor;
+   if (descriptor.descriptorSet == VK_NULL_HANDLE)
+   {
+      auto [view, sampler] = renderer::TextureLibrary::GetTexture(id)->GetImageViewAndSampler();
+      descriptor.descriptorSet = renderer::Texture::CreateDescriptorSet(
+         sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, descriptorPool,
+         descriptorSetLayout);
+      descriptor.slotVersion = slotVersion;
    }
 
-   return descriptor;
+   return descriptor.descriptorSet;
 }
 
+} // namespace
+
 void
 EditorGUI::RenderSelectedObjectsMenu()
 {
@@ -174,6 +216,7 @@ EditorGUI::RenderGroupSelectModifications()
                                  .GetGameObjectRef(object)
                                  .GetSprite()
                                  .ChangeRenderLayer(newLayer);
+                              parent_.GetLevel().ObjectModified(object);
                            }
 
                            for (auto& obj : selectedObjects_)
@@ -261,7 +304,8 @@ EditorGUI::RenderGameObjectContent()
          name.resize(nameLength);
          if (ImGui::InputText("##Name", name.data(), nameLength))
          {
-            gameObject.SetName(name);
+            // Input buffer is padded with zeros
+            gameObject.SetName(name.c_str());
             objectsInfo_[currentlySelectedGameObject_].description =
                fmt::format("[{}] {} ({:.2f}, {:.2f})", gameObject.GetTypeString().c_str(),
                            gameObject.GetName().c_str(), gameObject.GetPosition().x,
@@ -273,7 +317,7 @@ EditorGUI::RenderGameObjectContent()
       {
          CreateActionRowLabel("Group", [this, &gameObject] {
             FillWidth();
-            if (ImGui::BeginCombo("##ObjectGroup", gameObject.editorGroup_.c_str()))
+            if (ImGui::BeginCombo("##ObjectGroup", gameObject.GetEditorGroup().c_str()))
             {
                for (const auto& group : groupNames_)
                {
@@ -285,7 +329,8 @@ EditorGUI::RenderGameObjectContent()
                      }
                      else
                      {
-                        gameObject.editorGroup_ = group;
+                        gameObject.SetEditorGroup(group);
+                        currentLevel_->ObjectModified(gameObject.GetID());
                      }
                   }
                }
@@ -308,6 +353,7 @@ EditorGUI::RenderGameObjectContent()
                      parent_.AddToWorkQueue([&gameObject, item, this] {
                         const auto newLayer = std::stoi(item);
                         gameObject.GetSprite().ChangeRenderLayer(newLayer);
+                        currentLevel_->ObjectModified(gameObject.GetID());
 
                         auto obj = stl::find_if(selectedObjects_,
                                                 [curID = currentlySelectedGameObject_](
@@ -382,11 +428,13 @@ EditorGUI::RenderGameObjectContent()
       const auto sectionSize = ImGui::GetContentRegionAvail();
       const auto currentPos = ImGui::GetCursorScreenPos();
       ImGui::SetCursorScreenPos(ImVec2(currentPos.x + sectionSize.x / 4.0f, currentPos.y));
-      ImGui::Image(
-         static_cast< ImTextureID >(GetDescriptor(gameObject.GetSprite().GetTexture()->GetID(),
-                                                  renderer::EditorData::descriptorPool_,
-                                                  renderer::EditorData::descriptorSetLayout_)),
-         {glm::min(sectionSize.x, 128.0f), glm::min(sectionSize.x, 128.0f)});
+      const auto* texture = gameObject.GetSprite().GetTexture();
+      const auto& uvRect = texture->GetUVRect();
+      ImGui::Image(static_cast< ImTextureID >(
+                      GetDescriptor(texture->GetID(), renderer::EditorData::descriptorPool_,
+                                    renderer::EditorData::descriptorSetLayout_)),
+                   {glm::min(sectionSize.x, 128.0f), glm::min(sectionSize.x, 128.0f)},
+                   {uvRect.x, uvRect.y}, {uvRect.x + uvRect.z, uvRect.y + uvRect.w});
 
       if (ImGui::BeginTable("TextureInfoTable", 3))
       {
@@ -413,7 +461,7 @@ EditorGUI::RenderGameObjectContent()
                ImGui::InputText("##Texture", sprite.GetTextureName().data(),
                                 sprite.GetTextureName().size(), ImGuiInputTextFlags_ReadOnly);
             },
-            [&sprite] {
+            [this, &sprite, &gameObject] {
                if (ImGui::Button(ICON_FA_PENCIL "##ChangeTextureButton"))
                {
                   auto textureName = FileManager::FileDialog(
@@ -421,6 +469,7 @@ EditorGUI::RenderGameObjectContent()
                   if (!textureName.empty())
                   {
                      sprite.SetTextureFromFile(textureName);
+                     currentLevel_->ObjectModified(gameObject.GetID());
                   }
                }
             }
@@ -441,11 +490,12 @@ EditorGUI::RenderGameObjectContent()
       ImGui::SetNextItemOpen(true);
       if (ImGui::CollapsingHeader("Animation"))
       {
-         DrawWidget("Type", [&animatable]() {
+         DrawWidget("Type", [this, &animatable, &gameObject]() {
             if (ImGui::RadioButton("Loop", animatable.GetAnimationType()
                                               == Animatable::ANIMATION_TYPE::LOOP))
             {
                animatable.SetAnimationType(Animatable::ANIMATION_TYPE::LOOP);
+               currentLevel_->ObjectModified(gameObject.GetID());
             }
 
             ImGui::SameLine();
@@ -453,6 +503,7 @@ EditorGUI::RenderGameObjectContent()
                                                   == Animatable::ANIMATION_TYPE::REVERSABLE))
             {
                animatable.SetAnimationType(Animatable::ANIMATION_TYPE::REVERSABLE);
+               currentLevel_->ObjectModified(gameObject.GetID());
             }
          });
 
@@ -553,13 +604,15 @@ EditorGUI::RenderGameObjectContent()
                   ImGui::EndTable();
                }
 
-               DrawWidget(fmt::format("Duration (sec)", node.m_end.x, node.m_end.y), [&node]() {
-                  auto seconds = static_cast< int32_t >(node.m_timeDuration.count());
-                  if (ImGui::SliderInt("##distance", &seconds, 0, 10))
-                  {
-                     node.m_timeDuration = std::chrono::seconds(seconds);
-                  }
-               });
+               DrawWidget(fmt::format("Duration (sec)", node.m_end.x, node.m_end.y),
+                          [this, &node, selectedID]() {
+                             auto seconds = static_cast< int32_t >(node.m_timeDuration.count());
+                             if (ImGui::SliderInt("##distance", &seconds, 0, 10))
+                             {
+                                node.m_timeDuration = std::chrono::seconds(seconds);
+                                currentLevel_->ObjectModified(selectedID);
+                             }
+                          });
             }
          }
       }
@@ -110,8 +110,7 @@ EditorGUI::Render(VkCommandBuffer commandBuffer)
       return;
    }
 
-   UpdateBuffers();
-
+   // Buffers are already filled (see Editor::Render), this can be called on a worker thread
    const ImGuiIO& io = ImGui::GetIO();
    const auto currentFrame = renderer::Data::currentFrame_;
 
@@ -227,6 +226,8 @@ EditorGUI::PrepareResources()
 
    VkDescriptorPoolCreateInfo descriptorPoolInfo{};
    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+   // Sets of textures that changed are freed (see GetDescriptor)
+   descriptorPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
    descriptorPoolInfo.poolSizeCount = static_cast< uint32_t >(poolSizes.size());
    descriptorPoolInfo.pPoolSizes = poolSizes.data();
    descriptorPoolInfo.maxSets = renderer::MAX_NUM_TEXTURES;
@@ -454,7 +455,7 @@ EditorGUI::PreparePipeline()
    pipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
 
    renderer::vk_check_error(
-      vkCreateGraphicsPipelines(renderer::Data::vk_device, renderData.pipelineCache, 1,
+      vkCreateGraphicsPipelines(renderer::Data::vk_device, renderer::Data::vk_pipelineCache, 1,
                                 &pipelineCreateInfo, nullptr, &renderer::EditorData::pipeline_),
       "");
 }
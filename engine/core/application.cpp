@@ -48,6 +48,74 @@ Application::IsGame() const
    return isGame_;
 }
 
+ThreadPool&
+Application::GetThreadPool()
+{
+   return threadPool_;
+}
+
+bool
+Application::IsLevelLoading() const
+{
+   return levelLoader_ != nullptr;
+}
+
+float
+Application::GetLevelLoadProgress() const
+{
+   return levelLoader_ ? levelLoader_->GetProgress() : 1.0f;
+}
+
+void
+Application::StartLevelLoading(const std::string& pathToLevel)
+{
+   currentLevel_ = std::make_shared< Level >();
+   levelLoader_ = std::make_unique< LevelLoader >(this, currentLevel_, pathToLevel);
+   levelLoader_->LoadEnvironment();
+
+   // Objects closest to the player are loaded first, then the ones around the camera
+   workQueue_.PushResumableWorkUnit([] { return true; }, [this, loader = levelLoader_.get()] {
+      return StepLevelLoading(loader, LevelLoader::DEFAULT_FRAME_BUDGET);
+   });
+}
+
+void
+Application::FinishLevelLoading()
+{
+   if (levelLoader_)
+   {
+      StepLevelLoading(levelLoader_.get(), time::microseconds::max());
+   }
+}
+
+bool
+Application::StepLevelLoading(const LevelLoader* loader, time::microseconds budget)
+{
+   // Different level was loaded in the meantime
+   if (levelLoader_.get() != loader)
+   {
+      return true;
+   }
+
+   // Camera can be moved while the level is loading, load the area it looks at first
+   levelLoader_->SetFocusPoint(glm::vec2{camera_.GetPosition()});
+
+   const auto finished = levelLoader_->Step(budget);
+   if (finished)
+   {
+      Logger::Debug("Loaded {} level objects", levelLoader_->GetNumObjects());
+      levelLoader_.reset();
+      LevelLoaded();
+   }
+
+   return finished;
+}
+
+void
+Application::LevelLoaded()
+{
+}
+
 void
 Application::CenterCameraOnPlayer()
 {
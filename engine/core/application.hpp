@@ -2,8 +2,11 @@
 
 #include "input_listener.hpp"
 #include "level.hpp"
+#include "level_loader.hpp"
 #include "logger.hpp"
 #include "renderer/camera/camera.hpp"
+#include "renderer/renderer.hpp"
+#include "thread_pool.hpp"
 #include "window/window.hpp"
 #include "utils/time/timer.hpp"
 #include "work_queue.hpp"
@@ -12,6 +15,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <memory>
+#include <vector>
 
 namespace looper::renderer {
 class Window;
@@ -56,8 +60,36 @@ class Application : public InputListener
    [[nodiscard]] bool
    IsGame() const;
 
+   [[nodiscard]] ThreadPool&
+   GetThreadPool();
+
+   /**
+    * \brief Checks whether current level's objects are still being loaded
+    *
+    * \return True if the level is loaded incrementally and it's not finished yet
+    */
+   [[nodiscard]] bool
+   IsLevelLoading() const;
+
+   // Loading progress of the current level, in range [0, 1]
+   [[nodiscard]] float
+   GetLevelLoadProgress() const;
+
+   template < class F, class... Args >
+   auto
+   AddToThreadPool(F&& f, Args&&... args)
+   {
+      return threadPool_.enqueue(std::forward< F >(f), std::forward< Args >(args)...);
+   }
+
+   /**
+    * \brief Prepare the frame's draws. Each pass is recorded into its own secondary command
+    * buffer (see \c renderer::CreateCommandBuffers).
+    *
+    * \param[out] passes Draw passes of the frame, executed in order
+    */
    virtual void
-   Render(VkCommandBuffer cmdBuffer) = 0;
+   Render(std::vector< renderer::DrawPass >& passes) = 0;
 
    // convert from global position (OpenGL) to screen position (in pixels)
    [[nodiscard]] glm::vec2
@@ -92,10 +124,43 @@ class Application : public InputListener
    [[nodiscard]] virtual bool
    IsRunning() const = 0;
 
+   /**
+    * \brief Create new level and load its environment (see \c LevelLoader::LoadEnvironment).
+    * Level objects are loaded by the work queue over the next frames, within the
+    * \c LevelLoader::DEFAULT_FRAME_BUDGET per frame. \c LevelLoaded is called when it's done.
+    *
+    * \param[in] pathToLevel Global path to level file (.dgl or .dglb)
+    */
+   void
+   StartLevelLoading(const std::string& pathToLevel);
+
+   /**
+    * \brief Load the remaining objects of current level at once (if it's still loading)
+    */
+   void
+   FinishLevelLoading();
+
+   /**
+    * \brief Load next slice of level objects
+    *
+    * \param[in] loader Loader that scheduled this step (ignored if it's no longer active)
+    * \param[in] budget Time that can be spent in this step
+    *
+    * \return True if loading is finished (or was abandoned)
+    */
+   bool
+   StepLevelLoading(const LevelLoader* loader, time::microseconds budget);
+
+   // Called once all objects of the current level are loaded
+   virtual void
+   LevelLoaded();
+
    bool isGame_ = false;
    bool windowInFocus_ = true;
 
    std::shared_ptr< Level > currentLevel_ = nullptr;
+   // Valid only while current level is loaded incrementally
+   std::unique_ptr< LevelLoader > levelLoader_ = nullptr;
 
    renderer::Window window_ = {};
    renderer::Camera camera_ = {};
@@ -107,6 +172,7 @@ class Application : public InputListener
    uint32_t numObjects_ = {};
 
    WorkQueue workQueue_ = {};
+   ThreadPool threadPool_ = ThreadPool{std::thread::hardware_concurrency()};
 };
 
 
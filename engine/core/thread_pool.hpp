@@ -2,9 +2,12 @@
 
 #include "utils/assert.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -39,6 +42,99 @@ class ThreadPool
       return res;
    }
 
+   /**
+    * \brief Split [0, numItems) into chunks and call \c func(begin, end) for each of them.
+    * Chunks are processed by the pool's workers and the calling thread. Blocks until every chunk
+    * is finished. Must not be called from inside a pool's task.
+    *
+    * \param[in] numItems Number of items to process
+    * \param[in] minChunkSize Minimal number of items processed by a single task
+    * \param[in] func Callable with (size_t begin, size_t end) signature
+    */
+   template < class F >
+   void
+   ParallelFor(size_t numItems, size_t minChunkSize, F&& func)
+   {
+      if (numItems == 0)
+      {
+         return;
+      }
+
+      const auto maxChunks = std::max< size_t >(1, numItems / std::max< size_t >(1, minChunkSize));
+      const auto numChunks = std::min(workers_.size() + 1, maxChunks);
+      const auto chunkSize = (numItems + numChunks - 1) / numChunks;
+
+      std::vector< std::future< void > > chunks = {};
+      chunks.reserve(numChunks);
+
+      for (size_t begin = chunkSize; begin < numItems; begin += chunkSize)
+      {
+         const auto end = std::min(begin + chunkSize, numItems);
+         chunks.push_back(enqueue([&func, begin, end] { func(begin, end); }));
+      }
+
+      // The calling thread takes the first chunk
+      func(size_t{0}, std::min(chunkSize, numItems));
+
+      for (auto& chunk : chunks)
+      {
+         chunk.get();
+      }
+   }
+
+   /**
+    * \brief Call \c func(idx) for each index in [0, numItems). Items are taken one by one by
+    * the pool's workers and the calling thread. Blocks until every item is finished, but only
+    * waits for items that are already being processed, so (unlike \c ParallelFor) it's never
+    * stalled by tasks that are queued ahead (e.g. texture loads). Must not be called from
+    * inside a pool's task.
+    *
+    * \param[in] numItems Number of items to process
+    * \param[in] func Callable with (size_t idx) signature
+    */
+   template < class F >
+   void
+   ParallelForEach(size_t numItems, F&& func)
+   {
+      if (numItems == 0)
+      {
+         return;
+      }
+
+      struct Progress
+      {
+         std::atomic< size_t > next = 0;
+         std::atomic< size_t > done = 0;
+      };
+
+      // Tasks can start after this returns, they only touch the shared progress then
+      auto progress = std::make_shared< Progress >();
+      const auto process = [progress, &func, numItems] {
+         for (auto idx = progress->next++; idx < numItems; idx = progress->next++)
+         {
+            func(idx);
+
+            if (++progress->done == numItems)
+            {
+               progress->done.notify_all();
+            }
+         }
+      };
+
+      const auto numTasks = std::min(workers_.size(), numItems - 1);
+      for (size_t task = 0; task < numTasks; ++task)
+      {
+         enqueue(process);
+      }
+
+      process();
+
+      for (auto done = progress->done.load(); done < numItems; done = progress->done.load())
+      {
+         progress->done.wait(done);
+      }
+   }
+
  private:
    // need to keep track of threads so we can join them
    std::vector< std::thread > workers_ = {};
@@ -1,6 +1,8 @@
 #include "work_queue.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
 #include <vector>
 
 namespace looper {
@@ -11,12 +13,28 @@ WorkQueue::PushWorkUnit(const WorkQueue::Precondition& prec, const WorkQueue::Wo
    queue_.emplace_back(prec, work);
 }
 
+void
+WorkQueue::PushResumableWorkUnit(const WorkQueue::Precondition& prec,
+                                 const WorkQueue::ResumableWorkUnit& work)
+{
+   PushWorkUnit(prec, [this, prec, work] {
+      if (!work())
+      {
+         PushResumableWorkUnit(prec, work);
+      }
+   });
+}
+
 void
 WorkQueue::RunWorkUnits()
 {
+   // Work units are allowed to push new work, which will be run on the next call
+   Workers currentQueue;
+   currentQueue.swap(queue_);
+
    Workers tmpQueue;
 
-   for (auto& unit : queue_)
+   for (auto& unit : currentQueue)
    {
       if (unit.first())
       {
@@ -24,10 +42,12 @@ WorkQueue::RunWorkUnits()
       }
       else
       {
-         tmpQueue.push_back(unit);
+         tmpQueue.push_back(std::move(unit));
       }
    }
 
+   // Keep the deferred units ahead of the ones pushed during this run
+   std::move(queue_.begin(), queue_.end(), std::back_inserter(tmpQueue));
    queue_.swap(tmpQueue);
 }
 
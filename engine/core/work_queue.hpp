@@ -9,12 +9,24 @@ class WorkQueue
 {
  public:
    using WorkUnit = std::function< void() >;
+   // Returns true when the work is done, otherwise it's re-queued for the next frame
+   using ResumableWorkUnit = std::function< bool() >;
    using Precondition = std::function< bool() >;
    using Workers = std::vector< std::pair< Precondition, WorkUnit > >;
 
    void
    PushWorkUnit(const Precondition& prec, const WorkUnit& work);
 
+   /**
+    * \brief Push work that is spread across multiple frames. \c work is run once per
+    * \c RunWorkUnits call (whenever \c prec is satisfied) until it returns true.
+    *
+    * \param[in] prec Precondition checked before each run
+    * \param[in] work Resumable work unit, returns true when finished
+    */
+   void
+   PushResumableWorkUnit(const Precondition& prec, const ResumableWorkUnit& work);
+
    void
    RunWorkUnits();
 
@@ -1,10 +1,13 @@
 #include "game.hpp"
 #include "enemy.hpp"
 #include "renderer.hpp"
+#include "renderer/texture.hpp"
 #include "renderer/vulkan_common.hpp"
 #include "renderer/window/window.hpp"
 #include "utils/file_manager.hpp"
+#include "utils/hash.hpp"
 
+#include <array>
 #include <string>
 
 namespace looper {
@@ -31,6 +34,7 @@ Game::MainLoop()
             workQueue_.RunWorkUnits();
             if (windowInFocus_)
             {
+               renderer::TextureLibrary::UpdateResidency(threadPool_);
                renderer::UpdateData();
                renderer::Render(this);
             }
@@ -66,6 +70,12 @@ Game::Init(const std::string& configFile, bool loadLevel)
 
    window_.Init({configData["WindowSize"]["Width"], configData["WindowSize"]["Height"]},
                 "WindowTitle", true);
+
+   if (configData.contains("TextureMemoryBudgetMB"))
+   {
+      renderer::TextureLibrary::SetMemoryBudget(
+         configData["TextureMemoryBudgetMB"].get< VkDeviceSize >() * 1024 * 1024);
+   }
    window_.MakeFocus();
 
    renderer::Initialize(window_.GetWindowHandle(), renderer::ApplicationType::GAME);
@@ -265,7 +275,13 @@ Game::LoadLevel(const std::string& pathToLevel)
    renderer::SetAppMarker(renderer::ApplicationType::GAME);
 
    currentLevel_ = std::make_shared< Level >();
-   currentLevel_->Load(this, pathToLevel);
+   levelStreamer_ = std::make_unique< LevelStreamer >(this, currentLevel_, pathToLevel);
+   levelStreamer_->LoadEnvironment();
+
+   // Keep the visible area loaded, chunks are unloaded once they're a chunk further away
+   const auto visibleRadius = glm::length(GetWindowSize());
+   levelStreamer_->SetRadius(visibleRadius,
+                             visibleRadius + static_cast< float >(LEVEL_CHUNK_SIZE));
 
    camera_.Create(glm::vec3(currentLevel_->GetPlayer().GetCenteredPosition(), 0.0f),
                   window_.GetSize());
@@ -322,10 +338,19 @@ Game::ProcessInput(time::milliseconds deltaTime)
 {
    deltaTime_ = deltaTime;
 
-   MouseEvents();
-   KeyEvents();
-   HandleReverseLogic();
-   UpdateGameState();
+   const auto playerPosition = currentLevel_->GetPlayer().GetCenteredPosition();
+   const auto focusPoints =
+      std::to_array< const glm::vec2 >({playerPosition, glm::vec2{camera_.GetPosition()}});
+   levelStreamer_->Update(focusPoints, LevelLoader::DEFAULT_FRAME_BUDGET);
+
+   // Gameplay starts (or resumes) as soon as the area visible around the player is loaded
+   if (levelStreamer_->IsAreaLoaded(playerPosition, glm::length(GetWindowSize())))
+   {
+      MouseEvents();
+      KeyEvents();
+      HandleReverseLogic();
+      UpdateGameState();
+   }
 
    auto& renderData =
       renderer::Data::renderData_.at(renderer::GetCurrentlyBoundType());
@@ -380,45 +405,42 @@ Game::HandleReverseLogic()
 }
 
 void
-Game::Render(VkCommandBuffer cmdBuffer)
+Game::Render(std::vector< renderer::DrawPass >& passes)
 {
    RenderFirstPass();
    RenderSecondPass();
 
-   auto& renderData =
+   const auto& renderData =
       renderer::Data::renderData_.at(renderer::GetCurrentlyBoundType());
+   const auto frame = renderer::Data::currentFrame_;
 
-   vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipeline);
-
+   // Draw parameters are in the indirect buffer, so the pass is only recorded again
+   // when one of the bound objects changes
+   auto key = utils::HashValue(renderData.pipeline);
+   key = utils::HashValue(renderData.descriptorSets[frame], key);
+   key = utils::HashValue(renderData.quadVertexBuffer.buffer_, key);
+   key = utils::HashValue(renderData.quadIndexBuffer.buffer_, key);
+   key = utils::HashValue(renderData.indirectDrawBuffer.at(frame).buffer_, key);
 
-   auto offsets = std::to_array< const VkDeviceSize >({0});
+   const auto record = [&renderData, frame](VkCommandBuffer cmdBuffer) {
+      vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipeline);
 
-   vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderData.pipelineLayout, 0,
-                           1, &renderData.descriptorSets[renderer::Data::currentFrame_], 0,
-                           nullptr);
+      auto offsets = std::to_array< const VkDeviceSize >({0});
 
-   for (int32_t layer = renderer::NUM_LAYERS - 1; layer >= 0; --layer)
-   {
-      const auto idx = static_cast< size_t >(layer);
+      vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              renderData.pipelineLayout, 0, 1, &renderData.descriptorSets[frame],
+                              0, nullptr);
 
-      const auto& numObjects = renderData.numMeshes.at(idx);
-      if (numObjects == 0)
-      {
-         continue;
-      }
-
-      vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderData.vertexBuffer.at(idx).buffer_,
+      vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &renderData.quadVertexBuffer.buffer_,
                              offsets.data());
+      vkCmdBindIndexBuffer(cmdBuffer, renderData.quadIndexBuffer.buffer_, 0, VK_INDEX_TYPE_UINT32);
 
-      vkCmdBindIndexBuffer(cmdBuffer, renderData.indexBuffer.at(idx).buffer_, 0,
-                           VK_INDEX_TYPE_UINT32);
+      // Visible sprites of every layer (far to near), see RenderData::visibleInstances
+      vkCmdDrawIndexedIndirect(cmdBuffer, renderData.indirectDrawBuffer.at(frame).buffer_, 0,
+                               renderer::NUM_LAYERS, sizeof(VkDrawIndexedIndirectCommand));
+   };
 
-      // const auto numObjects =
-      // renderer::GetNumMeshes(renderer::ApplicationType::GAME); numObjects_ =
-      // numObjects.second - numObjects.first;
-      vkCmdDrawIndexed(cmdBuffer, renderData.numMeshes.at(idx) * renderer::INDICES_PER_SPRITE, 1, 0,
-                       0, 0);
-   }
+   passes.push_back({0, key, record});
 }
 
 } // namespace looper
@@ -3,6 +3,7 @@
 #include "application.hpp"
 #include "input_manager.hpp"
 #include "level.hpp"
+#include "level_streamer.hpp"
 #include "logger.hpp"
 #include "player.hpp"
 #include "utils/time/timer.hpp"
@@ -35,7 +36,7 @@ class Game : public Application
    KeyCallback(KeyEvent& event) override;
 
    void
-   Render(VkCommandBuffer cmdBuffer) override;
+   Render(std::vector< renderer::DrawPass >& passes) override;
 
    [[nodiscard]] glm::vec2
    GetCursor();
@@ -122,6 +123,9 @@ class Game : public Application
    GameState m_state = GameState::GAME;
 
    StateList< glm::vec2 > cameraPositions_ = {};
+
+   // Loads and unloads level chunks around the player and camera
+   std::unique_ptr< LevelStreamer > levelStreamer_ = nullptr;
 };
 
 } // namespace looper
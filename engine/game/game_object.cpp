@@ -67,6 +67,44 @@ GameObject::Setup(Application* application, const glm::vec2& position, const glm
    appHandle_->GetLevel().OccupyNodes(id_, currentGameObjectState_.nodes_, hasCollision_);
 }
 
+void
+GameObject::SetupDeferred(Application* application, const glm::vec2& position,
+                          const glm::vec2& size, utils::StringID sprite, ObjectType type,
+                          uint32_t renderLayer, renderer::MeshRegistration& registration,
+                          std::vector< Tile > occupiedNodes)
+{
+   type_ = type;
+   appHandle_ = application;
+
+   switch (type)
+   {
+      case ObjectType::ENEMY:
+      case ObjectType::PLAYER: {
+         renderLayer = 1;
+      }
+      break;
+      default: {
+      }
+   }
+
+   sprite_.SetSpriteTexturedDeferred(position, size, sprite, renderLayer, registration);
+   currentGameObjectState_.visible_ = true;
+   currentGameObjectState_.previousPosition_ = position;
+
+   currentGameObjectState_.nodes_ =
+      occupiedNodes.empty()
+         ? appHandle_->GetLevel().GetTilesFromBoundingBox(sprite_.GetTransformedRectangle())
+         : std::move(occupiedNodes);
+}
+
+void
+GameObject::CommitSetup()
+{
+   Object::Setup(type_);
+
+   appHandle_->GetLevel().OccupyNodes(id_, currentGameObjectState_.nodes_, hasCollision_);
+}
+
 
 bool
 GameObject::CheckIfCollidedScreenPosion(const glm::vec2& screenPosition) const
@@ -92,6 +130,7 @@ GameObject::SetSize(const glm::vec2& newSize)
 {
    sprite_.SetSize(newSize);
    updateCollision_ = true;
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 void
@@ -166,6 +205,8 @@ GameObject::SetHasCollision(bool hasCollision)
    {
       appHandle_->GetLevel().OccupyNodes(id_, currentGameObjectState_.nodes_, hasCollision_);
    }
+
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 bool
@@ -175,15 +216,40 @@ GameObject::GetHasCollision() const
 }
 
 void
-GameObject::SetName(const std::string& name)
+GameObject::SetName(std::string_view name)
+{
+   SetName(utils::StringInterner::Intern(name));
+}
+
+void
+GameObject::SetName(utils::StringID name)
 {
    name_ = name;
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 const std::string&
 GameObject::GetName() const
 {
-   return name_;
+   return utils::StringInterner::GetString(name_);
+}
+
+void
+GameObject::SetEditorGroup(std::string_view editorGroup)
+{
+   SetEditorGroup(utils::StringInterner::Intern(editorGroup));
+}
+
+void
+GameObject::SetEditorGroup(utils::StringID editorGroup)
+{
+   editorGroup_ = editorGroup;
+}
+
+const std::string&
+GameObject::GetEditorGroup() const
+{
+   return utils::StringInterner::GetString(editorGroup_);
 }
 
 void
@@ -206,6 +272,7 @@ GameObject::Move(const glm::vec2& moveBy)
    sprite_.Translate(glm::vec3(moveBy, 0.0f));
 
    updateCollision_ = true;
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 void
@@ -214,6 +281,7 @@ GameObject::Scale(const glm::vec2& scaleVal, bool cumulative)
    cumulative ? sprite_.ScaleCumulative(scaleVal) : sprite_.Scale(scaleVal);
 
    updateCollision_ = true;
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 void
@@ -221,6 +289,7 @@ GameObject::Rotate(float angle, bool cumulative)
 {
    cumulative ? sprite_.RotateCumulative(angle) : sprite_.Rotate(angle);
    updateCollision_ = true;
+   appHandle_->GetLevel().ObjectModified(id_);
 }
 
 void
@@ -5,6 +5,7 @@
 #include "state_list.hpp"
 // #include "Shader.hpp"
 #include "renderer/sprite.hpp"
+#include "utils/string_interner.hpp"
 
 #include <glm/glm.hpp>
 
@@ -21,10 +22,40 @@ class GameObject : public Object
    GameObject() = default;
    ~GameObject() override;
 
+   GameObject(const GameObject&) = default;
+   GameObject&
+   operator=(const GameObject&) = default;
+   // Moved-from object doesn't hold any nodes, so its destructor won't free the moved ones
+   GameObject(GameObject&&) noexcept = default;
+   GameObject&
+   operator=(GameObject&&) noexcept = default;
+
    void
    Setup(Application* application, const glm::vec2& position, const glm::vec2& size,
          const std::string& sprite, ObjectType type, uint32_t renderLayer);
 
+   /**
+    * \brief First part of the deferred setup. Doesn't touch any shared state (ID counter,
+    * renderer data, pathfinder) so it can be run on worker threads.
+    * Has to be followed by \c CommitSetup, once \c registration is committed to the renderer.
+    *
+    * \param[out] registration Sprite's mesh data, commit it with \c renderer::MeshesLoaded
+    * \param[in] occupiedNodes Precomputed nodes occupied by the object (see navigation_bake.hpp).
+    *                          If empty, they're computed from object's bounding box.
+    */
+   void
+   SetupDeferred(Application* application, const glm::vec2& position, const glm::vec2& size,
+                 utils::StringID sprite, ObjectType type, uint32_t renderLayer,
+                 renderer::MeshRegistration& registration,
+                 std::vector< Tile > occupiedNodes = {});
+
+   /**
+    * \brief Second part of the deferred setup. Assigns object's ID and occupies pathfinder nodes.
+    * Must be called from the main thread.
+    */
+   void
+   CommitSetup();
+
    virtual void
    Hit(int32_t /*dmg*/)
    {
@@ -38,7 +69,16 @@ class GameObject : public Object
    SetColor(const glm::vec4& color);
 
    virtual void
-   SetName(const std::string& name);
+   SetName(std::string_view name);
+
+   void
+   SetName(utils::StringID name);
+
+   void
+   SetEditorGroup(std::string_view editorGroup);
+
+   void
+   SetEditorGroup(utils::StringID editorGroup);
 
    virtual void
    SetSize(const glm::vec2& newSize);
@@ -76,6 +116,9 @@ class GameObject : public Object
    [[nodiscard]] const std::string&
    GetName() const;
 
+   [[nodiscard]] const std::string&
+   GetEditorGroup() const;
+
    // Create sprite with texture from 'fileName'
    virtual void
    CreateSpriteTextured(const glm::vec3& position = glm::vec3{},
@@ -109,7 +152,10 @@ class GameObject : public Object
    [[nodiscard]] std::vector< Tile >
    GetOccupiedNodes() const;
 
-   std::string editorGroup_ = "Default";
+   // Names are interned once, every object only holds their IDs
+   static inline const utils::StringID DEFAULT_NAME = utils::StringInterner::Intern("DummyName");
+   static inline const utils::StringID DEFAULT_EDITOR_GROUP =
+      utils::StringInterner::Intern("Default");
 
  protected:
    // should be overriden by derrived class
@@ -152,7 +198,8 @@ class GameObject : public Object
    // object's sprite
    renderer::Sprite sprite_ = {};
 
-   std::string name_ = "DummyName";
+   utils::StringID name_ = DEFAULT_NAME;
+   utils::StringID editorGroup_ = DEFAULT_EDITOR_GROUP;
    };
 
 } // namespace looper
@@ -1,6 +1,9 @@
 #include "level.hpp"
 #include "enemy.hpp"
 #include "game.hpp"
+#include "level_binary.hpp"
+#include "level_journal.hpp"
+#include "navigation_bake.hpp"
 #include "player.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/window/window.hpp"
@@ -11,12 +14,57 @@
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <functional>
-#include <set>
+#include <iterator>
+#include <numeric>
+#include <unordered_set>
 
 namespace looper {
 
+namespace {
+// Minimal number of objects instantiated by a single ThreadPool task during level load
+constexpr size_t OBJECTS_PER_LOAD_TASK = 64;
+
+struct ObjectStrings
+{
+   utils::StringID name = {};
+   utils::StringID texture = {};
+   utils::StringID editorGroup = {};
+};
+
+// Interns strings used by the objects. Level's string table is deduplicated, so every string
+// is hashed once, no matter how many objects reference it
+std::vector< ObjectStrings >
+InternObjectStrings(const LevelFileView& level, std::span< const ObjectRecord > objects,
+                    std::span< const uint32_t > objectIndices)
+{
+   std::unordered_map< uint32_t, utils::StringID > internedStrings = {};
+   const auto intern = [&level, &internedStrings](StringRef ref) {
+      const auto it = internedStrings.find(ref.offset);
+      if (it != internedStrings.end())
+      {
+         return it->second;
+      }
+
+      const auto id = utils::StringInterner::Intern(level.GetString(ref));
+      internedStrings.emplace(ref.offset, id);
+      return id;
+   };
+
+   std::vector< ObjectStrings > strings = {};
+   strings.reserve(objectIndices.size());
+   for (const auto idx : objectIndices)
+   {
+      const auto& object = objects[idx];
+      strings.push_back({intern(object.name), intern(object.texture), intern(object.editorGroup)});
+   }
+
+   return strings;
+}
+} // namespace
+
 void
 Level::Create(Application* context, const std::string& name, const glm::ivec2& size)
 {
@@ -35,15 +83,60 @@ Level::Create(Application* context, const std::string& name, const glm::ivec2& s
 void
 Level::Load(Application* context, const std::string& pathToLevel)
 {
-   const auto json = FileManager::LoadJsonFile(pathToLevel);
+   const LevelFile levelFile(pathToLevel);
+   const NavigationBake navigation(pathToLevel, levelFile.GetView(), tileWidth_);
+   Load(context, levelFile.GetView(), &navigation);
+}
+
+void
+Level::Load(Application* context, const LevelFileView& level, const NavigationBake* navigation)
+{
+   LoadEnvironment(context, level, navigation);
+
+   const auto numObjects = level.GetObjects().size();
+   SCOPED_TIMER(fmt::format("Loading Objects ({})", numObjects));
+
+   std::vector< uint32_t > objectIndices(numObjects);
+   std::iota(objectIndices.begin(), objectIndices.end(), 0);
+   LoadObjects(context, level, objectIndices, navigation);
+}
+
+void
+Level::LoadEnvironment(Application* context, const LevelFileView& level,
+                       const NavigationBake* navigation)
+{
+   auto& threadPool = context->GetThreadPool();
+
+   // TEXTURES
+   {
+      std::unordered_set< std::string > textureNames = {"white.png"};
+      textureNames.emplace(level.GetString(level.GetBackground().texture));
+      textureNames.emplace(level.GetString(level.GetPlayer().texture));
+      for (const auto& enemy : level.GetEnemies())
+      {
+         textureNames.emplace(level.GetString(enemy.texture));
+      }
+      for (const auto& object : level.GetObjects())
+      {
+         textureNames.emplace(level.GetString(object.texture));
+      }
+
+      std::vector< std::string > texturesToLoad = {};
+      stl::copy_if(textureNames, std::back_inserter(texturesToLoad), [](const auto& texture) {
+         return !renderer::TextureLibrary::IsTextureLoaded(texture);
+      });
+
+      // Textures are loaded in the background, sprites use the placeholder until they're
+      // uploaded (see renderer::UpdateData). Small ones are packed into atlas pages.
+      SCOPED_TIMER(fmt::format("Prefetching Textures ({})", texturesToLoad.size()));
+      renderer::TextureLibrary::PrefetchAtlasTextures(threadPool, texturesToLoad);
+   }
 
    // BACKGROUND
    {
-      const auto& background = json["BACKGROUND"];
-      const auto& backgroundTex = background["texture"];
-      const auto& size = background["size"];
+      const auto& background = level.GetBackground();
 
-      LoadPremade(backgroundTex, glm::ivec2(size[0], size[1]));
+      LoadPremade(std::string{level.GetString(background.texture)}, background.size);
 
       contextPointer_ = context;
    }
@@ -52,28 +145,29 @@ Level::Load(Application* context, const std::string& pathToLevel)
    {
       SCOPED_TIMER(fmt::format("Loading Pathfinder"));
       pathFinder_.Initialize(this);
+
+      if (navigation and navigation->IsValid())
+      {
+         pathFinder_.SetRegions(navigation->GetOccupancy(), navigation->GetRegions());
+      }
    }
 
    // PLAYER
    {
       SCOPED_TIMER("Loading Player");
 
-      const auto& player = json["PLAYER"];
-      const auto& position = player["position"];
-      const auto& size = player["size"];
-      const auto& texture = player["texture"];
-      // const auto weapons = json[key]["weapons"];
-      const auto& name = player["name"];
+      const auto& player = level.GetPlayer();
 
-      player_.Setup(context, glm::vec2{position[0], position[1]}, glm::ivec2(size[0], size[1]),
-                    texture, name);
-      player_.Rotate(player["rotation"]);
-      player_.editorGroup_ = player["editor_group"];
+      player_.Setup(context, player.position, player.size,
+                    std::string{level.GetString(player.texture)},
+                    std::string{level.GetString(player.name)});
+      player_.Rotate(player.rotation);
+      player_.SetEditorGroup(level.GetString(player.editorGroup));
    }
 
    // ENEMIES
    {
-      const auto& enemies = json["ENEMIES"];
+      const auto enemies = level.GetEnemies();
       SCOPED_TIMER(fmt::format("Loading Enemies ({})", enemies.size()));
       // This is a magic number that we should figure out later
       enemies_.reserve(100);
@@ -81,136 +175,397 @@ Level::Load(Application* context, const std::string& pathToLevel)
 
       for (size_t i = 0; i < enemies.size(); ++i)
       {
-         const auto& enemy = enemies.at(i);
-         const auto& position = enemy["position"];
-         const auto& size = enemy["size"];
-         const auto& texture = enemy["texture"];
-         const auto& name = enemy["name"];
+         const auto& enemy = enemies[i];
 
          auto& object = enemies_.at(i);
-         object.Setup(context, glm::vec2{position[0], position[1]}, glm::ivec2(size[0], size[1]),
-                      texture, std::vector< AnimationPoint >{});
-         object.SetName(name);
-         object.Rotate(enemy["rotation"]);
+         object.Setup(context, enemy.position, enemy.size,
+                      std::string{level.GetString(enemy.texture)}, std::vector< AnimationPoint >{},
+                      static_cast< Animatable::ANIMATION_TYPE >(enemy.animationType));
+         object.SetName(level.GetString(enemy.name));
+         object.Rotate(enemy.rotation);
 
+         const auto animationPoints = level.GetAnimationPoints(enemy);
          std::vector< AnimationPoint > keypointsPositions = {};
-         glm::vec2 beginPoint = glm::vec2(position[0], position[1]);
+         keypointsPositions.reserve(animationPoints.size());
 
-         for (const auto& point : enemy["animate positions"])
+         for (const auto& point : animationPoints)
          {
-            AnimationPoint animationPoint(object.GetID());
-            animationPoint.m_end = glm::vec2(point["end position"][0], point["end position"][1]);
-            animationPoint.m_timeDuration = time::seconds(point["time duration"]);
-
-            keypointsPositions.emplace_back(animationPoint);
-
-            beginPoint = animationPoint.m_end;
+            keypointsPositions.emplace_back(object.GetID(), point.end,
+                                            time::seconds(point.timeDuration));
          }
 
          object.SetAnimationKeypoints(std::move(keypointsPositions));
-         object.editorGroup_ = enemy["editor_group"];
+         object.SetEditorGroup(level.GetString(enemy.editorGroup));
       }
    }
 
-   // OBJECTS
+   // Objects are appended in batches by 'LoadObjects' (and possibly unloaded later).
+   // This is a magic number that we should figure out later
+   objects_.reserve(10000);
+   nextObjectUid_ = level.GetNextObjectUid();
+}
+
+std::vector< Object::ID >
+Level::LoadObjects(Application* context, const LevelFileView& level,
+                   std::span< const uint32_t > objectIndices, const NavigationBake* navigation)
+{
+   const auto objects = level.GetObjects();
+   const auto firstIdx = objects_.size();
+   objects_.resize(firstIdx + objectIndices.size());
+
+   const auto* bakedNavigation = navigation and navigation->IsValid() ? navigation : nullptr;
+
+   // Objects are set up in parallel, renderer registrations are collected here
+   // and committed in a single pass afterwards
+   std::vector< renderer::MeshRegistration > registrations(objectIndices.size());
+   const auto strings = InternObjectStrings(level, objects, objectIndices);
+
+   // Batches are claimed by idle workers, so this doesn't wait for texture loads that
+   // are queued on the same pool (see LoadEnvironment)
+   const auto numBatches =
+      (objectIndices.size() + OBJECTS_PER_LOAD_TASK - 1) / OBJECTS_PER_LOAD_TASK;
+   context->GetThreadPool().ParallelForEach(
+      numBatches, [this, context, &objects, &objectIndices, &registrations, &strings,
+                   bakedNavigation, firstIdx](size_t batch) {
+         const auto begin = batch * OBJECTS_PER_LOAD_TASK;
+         const auto end = std::min(begin + OBJECTS_PER_LOAD_TASK, objectIndices.size());
+         for (auto i = begin; i < end; ++i)
+         {
+            const auto& object = objects[objectIndices[i]];
+            auto bakedNodes = bakedNavigation ? bakedNavigation->GetObjectTiles(objectIndices[i])
+                                              : std::vector< Tile >{};
+
+            auto& gameObject = objects_[firstIdx + i];
+            gameObject.SetupDeferred(context, object.position, object.size, strings[i].texture,
+                                     ObjectType::OBJECT,
+                                     static_cast< uint32_t >(object.renderLayer),
+                                     registrations[i], std::move(bakedNodes));
+            gameObject.SetName(strings[i].name);
+            if (bakedNavigation)
+            {
+               // Baked nodes already account for the rotation, collision doesn't need an update
+               gameObject.GetSprite().Rotate(object.rotation);
+            }
+            else
+            {
+               gameObject.Rotate(object.rotation);
+            }
+            gameObject.SetEditorGroup(strings[i].editorGroup);
+         }
+      });
+
+   renderer::MeshesLoaded(registrations);
+
+   std::vector< Object::ID > loadedObjects = {};
+   loadedObjects.reserve(objectIndices.size());
+
+   for (size_t i = 0; i < objectIndices.size(); ++i)
+   {
+      auto& gameObject = objects_[firstIdx + i];
+      gameObject.CommitSetup();
+      objectToIdx_[gameObject.GetID()] = firstIdx + i;
+      objectToUid_[gameObject.GetID()] = objects[objectIndices[i]].uid;
+      gameObject.SetHasCollision(objects[objectIndices[i]].hasCollision != 0);
+
+      loadedObjects.push_back(gameObject.GetID());
+   }
+
+   return loadedObjects;
+}
+
+void
+Level::UnloadObjects(std::span< const Object::ID > objectIDs)
+{
+   for (const auto objectID : objectIDs)
    {
-      const auto& objects = json["OBJECTS"];
-      SCOPED_TIMER(fmt::format("Loading Objects ({})", objects.size()));
-      // This is a magic number that we should figure out later
-      objects_.reserve(10000);
-      objects_.resize(objects.size());
-      for (size_t i = 0; i < objects.size(); ++i)
-      {
-         const auto& object = objects.at(i);
-         const auto& position = object["position"];
-         const auto& size = object["size"];
-         const auto& texture = object["texture"];
-         const auto& name = object["name"];
+      const auto idx = objectToIdx_.at(objectID);
+      objects_[idx].GetSprite().ClearData();
 
-         auto& gameObject = objects_.at(i);
-         gameObject.Setup(context, glm::vec2{position[0], position[1]},
-                          glm::ivec2(size[0], size[1]), texture, ObjectType::OBJECT,
-                          object["render_layer"]);
-         objectToIdx_[gameObject.GetID()] = i;
-         gameObject.SetName(name);
-         gameObject.Rotate(object["rotation"]);
-         gameObject.SetHasCollision(object["has collision"]);
-         gameObject.editorGroup_ = object["editor_group"];
+      if (idx != objects_.size() - 1)
+      {
+         objectToIdx_.at(objects_.back().GetID()) = idx;
+         std::swap(objects_[idx], objects_.back());
       }
+
+      objectToIdx_.erase(objectID);
+      objectToUid_.erase(objectID);
+
+      // Destructor frees object's nodes
+      objects_.pop_back();
    }
 }
 
 void
 Level::Save(const std::string& pathToLevel)
 {
-   nlohmann::json json;
+   if (SaveInPlace(pathToLevel))
+   {
+      return;
+   }
 
-   // Serialize background
-   json["BACKGROUND"]["texture"] = background_.GetTextureName();
-   json["BACKGROUND"]["size"] = {background_.GetSize().x, background_.GetSize().y};
+   SCOPED_TIMER(fmt::format("Saving level {}", pathToLevel));
 
-   // PLAYER
-   json["PLAYER"]["name"] = player_.GetName();
-   json["PLAYER"]["position"] = {player_.GetPosition().x, player_.GetPosition().y};
-   json["PLAYER"]["rotation"] = player_.GetSprite().GetRotation();
-   json["PLAYER"]["size"] = {player_.GetSprite().GetOriginalSize().x,
-                             player_.GetSprite().GetOriginalSize().y};
-   json["PLAYER"]["texture"] = player_.GetSprite().GetTextureName();
-   json["PLAYER"]["weapons"] = player_.GetWeapons();
-   json["PLAYER"]["render_layer"] = player_.GetSprite().GetRenderInfo().layer;
-   json["PLAYER"]["editor_group"] = player_.editorGroup_;
+   const auto levelData = CreateSnapshot().Finalize();
+   SnapshotSaved(pathToLevel, SaveLevelFile(pathToLevel, levelData));
+}
 
+bool
+Level::SaveInPlace(const std::string& pathToLevel)
+{
+   if (!trackChanges_ or fullSaveRequired_ or saveInProgress_ or pathToLevel != trackedLevelFile_
+       or !HasBinaryLevelExtension(pathToLevel))
+   {
+      return false;
+   }
 
-   // ENEMIES
-   for (const auto& enemy : enemies_)
+   SCOPED_TIMER(fmt::format("Saving level {} in place", pathToLevel));
+
+   // Level file is patched in place, journal has to hold all the changes in case we're interrupted
+   WriteJournal();
+
+   const auto changes = SerializeChanges(unsavedObjects_, false);
+   if (!PatchLevelFile(pathToLevel, LevelFileView{changes}))
    {
-      nlohmann::json enemyJson;
+      return false;
+   }
 
-      enemyJson["name"] = enemy.GetName();
-      enemyJson["position"] = {enemy.GetPosition().x, enemy.GetPosition().y};
-      enemyJson["size"] = {enemy.GetSprite().GetOriginalSize().x,
-                           enemy.GetSprite().GetOriginalSize().y};
-      enemyJson["rotation"] = enemy.GetSprite().GetRotation();
-      enemyJson["texture"] = enemy.GetSprite().GetTextureName();
-      enemyJson["render_layer"] = enemy.GetSprite().GetRenderInfo().layer;
-      enemyJson["editor_group"] = enemy.editorGroup_;
+   Logger::Info("Level: Updated {} modified objects in {}", unsavedObjects_.size(), pathToLevel);
 
-      enemyJson["animation type"] =
-         enemy.GetAnimationType() == Animatable::ANIMATION_TYPE::LOOP ? "Loop" : "Reversable";
+   // All changes are in the level file now
+   RemoveLevelJournal(pathToLevel);
+   journalObjects_.clear();
+   journalDeletedObjects_.clear();
+   journalEnvironment_ = false;
+   unsavedObjects_.clear();
 
-      const auto keypoints = enemy.GetAnimationKeypoints();
-      for (const auto& point : keypoints)
-      {
-         nlohmann::json animationPoint;
-         animationPoint["end position"] = {point.m_end.x, point.m_end.y};
-         animationPoint["time duration"] = point.m_timeDuration.count();
+   return true;
+}
+
+LevelFileWriter
+Level::CreateSnapshot()
+{
+   auto snapshot = CaptureState();
+
+   if (trackChanges_)
+   {
+      // Changes made from now on are not part of the snapshot
+      WriteJournal();
+
+      savingObjects_ = std::move(unsavedObjects_);
+      unsavedObjects_.clear();
+      savingFullSave_ = fullSaveRequired_;
+      fullSaveRequired_ = false;
+      saveInProgress_ = true;
+   }
+
+   return snapshot;
+}
 
-         enemyJson["animate positions"].emplace_back(animationPoint);
+void
+Level::SnapshotSaved(const std::string& pathToLevel, bool success)
+{
+   if (!trackChanges_)
+   {
+      return;
+   }
+
+   if (success)
+   {
+      // Journal is not written while saving, so it only holds changes that are in the snapshot
+      if (!trackedLevelFile_.empty())
+      {
+         RemoveLevelJournal(trackedLevelFile_);
       }
+      RemoveLevelJournal(pathToLevel);
 
-      json["ENEMIES"].emplace_back(enemyJson);
+      trackedLevelFile_ = pathToLevel;
+   }
+   else
+   {
+      unsavedObjects_.merge(savingObjects_);
+      fullSaveRequired_ = fullSaveRequired_ or savingFullSave_;
    }
 
-   // OBJECTS
+   savingObjects_.clear();
+   savingFullSave_ = false;
+   saveInProgress_ = false;
+}
+
+std::vector< std::byte >
+Level::Serialize() const
+{
+   return CaptureState().Finalize();
+}
+
+LevelFileWriter
+Level::CaptureState() const
+{
+   LevelFileWriter writer;
+
+   SerializeEnvironment(writer);
+
    for (const auto& object : objects_)
    {
-      nlohmann::json objectJson;
+      SerializeObject(writer, object);
+   }
+
+   return writer;
+}
+
+std::vector< std::byte >
+Level::SerializeChanges(const std::unordered_set< Object::ID >& objectIDs, bool environment) const
+{
+   LevelFileWriter writer;
+
+   if (environment)
+   {
+      SerializeEnvironment(writer);
+   }
+
+   for (const auto objectID : objectIDs)
+   {
+      SerializeObject(writer, objects_.at(objectToIdx_.at(objectID)));
+   }
+
+   return writer.Finalize();
+}
+
+void
+Level::SerializeEnvironment(LevelFileWriter& writer) const
+{
+   // BACKGROUND
+   writer.SetBackground(
+      {writer.AddString(background_.GetTextureName()), glm::ivec2(background_.GetSize())});
+
+   // PLAYER
+   {
+      PlayerRecord record = {};
+      record.name = writer.AddString(player_.GetName());
+      record.texture = writer.AddString(player_.GetSprite().GetTextureName());
+      record.editorGroup = writer.AddString(player_.GetEditorGroup());
+      record.position = player_.GetPosition();
+      record.size = glm::ivec2(player_.GetSprite().GetOriginalSize());
+      record.rotation = player_.GetSprite().GetRotation();
+      record.renderLayer = player_.GetSprite().GetRenderInfo().layer;
+
+      writer.SetPlayer(record, player_.GetWeapons());
+   }
+
+   // ENEMIES
+   for (const auto& enemy : enemies_)
+   {
+      EnemyRecord record = {};
+      record.name = writer.AddString(enemy.GetName());
+      record.texture = writer.AddString(enemy.GetSprite().GetTextureName());
+      record.editorGroup = writer.AddString(enemy.GetEditorGroup());
+      record.position = enemy.GetPosition();
+      record.size = glm::ivec2(enemy.GetSprite().GetOriginalSize());
+      record.rotation = enemy.GetSprite().GetRotation();
+      record.renderLayer = enemy.GetSprite().GetRenderInfo().layer;
+      record.animationType = static_cast< uint32_t >(enemy.GetAnimationType());
+
+      std::vector< AnimationPointRecord > animationPoints = {};
+      for (const auto& point : enemy.GetAnimationKeypoints())
+      {
+         animationPoints.push_back({point.m_end, point.m_timeDuration.count()});
+      }
+
+      writer.AddEnemy(record, animationPoints);
+   }
+}
+
+void
+Level::SerializeObject(LevelFileWriter& writer, const GameObject& object) const
+{
+   ObjectRecord record = {};
+   record.name = writer.AddString(object.GetName());
+   record.texture = writer.AddString(object.GetSprite().GetTextureName());
+   record.editorGroup = writer.AddString(object.GetEditorGroup());
+   record.position = object.GetPosition();
+   record.size = glm::ivec2(object.GetSprite().GetOriginalSize());
+   record.rotation = object.GetSprite().GetRotation();
+   record.renderLayer = object.GetSprite().GetRenderInfo().layer;
+   record.hasCollision = object.GetHasCollision() ? 1 : 0;
+   record.uid = objectToUid_.at(object.GetID());
+
+   writer.AddObject(record);
+}
+
+void
+Level::EnableChangeTracking(const std::string& pathToLevel, bool hasUnsavedChanges)
+{
+   trackChanges_ = true;
+   trackedLevelFile_ = pathToLevel;
+
+   journalObjects_.clear();
+   journalDeletedObjects_.clear();
+   journalEnvironment_ = false;
+   unsavedObjects_.clear();
+   fullSaveRequired_ = hasUnsavedChanges;
+}
+
+void
+Level::ObjectModified(Object::ID objectID)
+{
+   if (!trackChanges_)
+   {
+      return;
+   }
+
+   switch (Object::GetTypeFromID(objectID))
+   {
+      case ObjectType::OBJECT: {
+         // Objects that are still being created are recorded by 'AddGameObject'
+         if (objectToIdx_.contains(objectID))
+         {
+            journalObjects_.insert(objectID);
+            unsavedObjects_.insert(objectID);
+         }
+      }
+      break;
+      case ObjectType::PLAYER:
+      case ObjectType::ENEMY:
+      case ObjectType::ANIMATION_POINT: {
+         journalEnvironment_ = true;
+         fullSaveRequired_ = true;
+      }
+      break;
+      default: {
+      }
+   }
+}
 
-      objectJson["name"] = object.GetName();
-      objectJson["has collision"] = object.GetHasCollision();
+bool
+Level::HasUnsavedChanges() const
+{
+   return fullSaveRequired_ or !unsavedObjects_.empty();
+}
 
-      objectJson["position"] = {object.GetPosition().x, object.GetPosition().y};
-      objectJson["size"] = {object.GetSprite().GetOriginalSize().x,
-                            object.GetSprite().GetOriginalSize().y};
-      objectJson["rotation"] = object.GetSprite().GetRotation();
-      objectJson["texture"] = object.GetSprite().GetTextureName();
-      objectJson["render_layer"] = object.GetSprite().GetRenderInfo().layer;
-      objectJson["editor_group"] = object.editorGroup_;
+void
+Level::WriteJournal()
+{
+   // While the level is being saved, changes are kept until the save is finished
+   // (see 'SnapshotSaved'), as the current journal gets removed afterwards
+   if (!trackChanges_ or saveInProgress_
+       or (journalObjects_.empty() and journalDeletedObjects_.empty() and !journalEnvironment_))
+   {
+      return;
+   }
 
-      json["OBJECTS"].emplace_back(objectJson);
+   // Journal is applied on top of the level file, so there's nothing to write it for
+   // until the level is saved for the first time
+   if (!std::filesystem::exists(trackedLevelFile_))
+   {
+      return;
    }
 
-   FileManager::SaveJsonFile(pathToLevel, json);
+   const auto changes = SerializeChanges(journalObjects_, journalEnvironment_);
+   AppendToLevelJournal(trackedLevelFile_, LevelFileView{changes}, journalDeletedObjects_,
+                        journalEnvironment_);
+
+   journalObjects_.clear();
+   journalDeletedObjects_.clear();
+   journalEnvironment_ = false;
 }
 
 void
@@ -291,6 +646,7 @@ Level::AddGameObject(ObjectType objectType, const glm::vec2& position)
                                   std::vector< AnimationPoint >{});
 
          newObject = newEnemy.GetID();
+         ObjectModified(newObject);
       }
       break;
 
@@ -300,6 +656,7 @@ Level::AddGameObject(ObjectType objectType, const glm::vec2& position)
             player_.Setup(contextPointer_, glm::vec3{position, 0.0f}, defaultSize, defaultTexture);
          }
          newObject = player_.GetID();
+         ObjectModified(newObject);
       }
       break;
 
@@ -308,6 +665,13 @@ Level::AddGameObject(ObjectType objectType, const glm::vec2& position)
                                                     defaultTexture, ObjectType::OBJECT);
          newObject = newObj.GetID();
          objectToIdx_[newObject] = objects_.size() - 1;
+         objectToUid_[newObject] = nextObjectUid_++;
+
+         if (trackChanges_)
+         {
+            journalObjects_.insert(newObject);
+            fullSaveRequired_ = true;
+         }
       }
       break;
 
@@ -372,26 +736,7 @@ Level::OccupyNodes(Object::ID object, const std::vector< Tile >& nodes, bool has
 std::vector< Tile >
 Level::GetTilesFromBoundingBox(const std::array< glm::vec2, 4 >& box) const
 {
-   std::set< Tile > ret;
-
-   auto insertToVec = [&ret](const std::vector< Tile >& tiles) {
-      for (const auto& tile : tiles)
-      {
-         ret.insert(tile);
-      }
-   };
-
-   // Standard Rect
-   insertToVec(GetTilesAlongTheLine(box[0], box[3]));
-   insertToVec(GetTilesAlongTheLine(box[3], box[2]));
-   insertToVec(GetTilesAlongTheLine(box[2], box[1]));
-   insertToVec(GetTilesAlongTheLine(box[1], box[0]));
-
-   // Diagonals for inside nodes
-   insertToVec(GetTilesAlongTheLine(box[0], box[2]));
-   insertToVec(GetTilesAlongTheLine(box[1], box[3]));
-
-   return std::vector< Tile >{ret.begin(), ret.end()};
+   return looper::GetTilesFromBoundingBox(box, levelSize_, tileWidth_);
 }
 
 std::vector< Tile >
@@ -435,15 +780,7 @@ Level::GetTilesFromRectangle(const std::array< glm::vec2, 4 >& rect) const
 Tile
 Level::GetTileFromPosition(const glm::vec2& local) const
 {
-   if (!IsInLevelBoundaries(local))
-   {
-      return INVALID_TILE;
-   }
-
-   const auto w = static_cast< int32_t >(glm::floor(local.x / static_cast< float >(tileWidth_)));
-   const auto h = static_cast< int32_t >(glm::floor(local.y / static_cast< float >(tileWidth_)));
-
-   return {w, h};
+   return looper::GetTileFromPosition(local, levelSize_, tileWidth_);
 }
 
 bool
@@ -507,19 +844,7 @@ Level::CheckCollisionAlongTheLine(const glm::vec2& fromPos, const glm::vec2& toP
 std::vector< Tile >
 Level::GetTilesAlongTheLine(const glm::vec2& fromPos, const glm::vec2& toPos) const
 {
-   std::set< Tile > tiles;
-
-   const auto numSteps =
-      static_cast< uint32_t >(glm::length(toPos - fromPos)) / (tileWidth_ / uint32_t{2});
-
-   const auto stepSize = (toPos - fromPos) / static_cast< float >(numSteps);
-
-   for (uint32_t i = 0; i < numSteps; ++i)
-   {
-      tiles.insert(GetTileFromPosition(fromPos + (stepSize * static_cast< float >(i))));
-   }
-
-   return {tiles.begin(), tiles.end()};
+   return looper::GetTilesAlongTheLine(fromPos, toPos, levelSize_, tileWidth_);
 }
 
 void
@@ -598,6 +923,8 @@ Level::DeleteObject(Object::ID deletedObject)
          // Don't call erase
          std::iter_swap(enemyIter, enemies_.end() - 1);
          enemies_.pop_back();
+
+         ObjectModified(deletedObject);
       }
       break;
       case ObjectType::OBJECT: {
@@ -612,16 +939,26 @@ Level::DeleteObject(Object::ID deletedObject)
 
          objectIter->GetSprite().ClearData();
 
+         if (trackChanges_)
+         {
+            journalDeletedObjects_.push_back(objectToUid_.at(deletedObject));
+            journalObjects_.erase(deletedObject);
+            unsavedObjects_.erase(deletedObject);
+            savingObjects_.erase(deletedObject);
+            fullSaveRequired_ = true;
+         }
+         objectToUid_.erase(deletedObject);
+
          if (objectIter != objects_.end() - 1)
          {
             const auto deletedIdx = objectToIdx_.at(deletedObject);
-            objectToIdx_.erase(deletedObject);
             objectToIdx_.at(objects_.back().GetID()) = deletedIdx;
 
             // Don't call erase
             std::iter_swap(objectIter, objects_.end() - 1);
          }
 
+         objectToIdx_.erase(deletedObject);
          objects_.pop_back();
       }
       break;
@@ -5,13 +5,18 @@
 #include "enemy.hpp"
 
 #include <glm/glm.hpp>
+#include <span>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace looper {
 
 class Application;
 class GameObject;
 class Game;
+class LevelFileView;
+class LevelFileWriter;
+class NavigationBake;
 
 class Level
 {
@@ -55,14 +60,136 @@ class Level
    void
    Create(Application* context, const std::string& name, const glm::ivec2& size);
 
-   // pathToLevel - global path to level file (.dgl)
+   // pathToLevel - global path to level file (.dgl or .dglb, detected by file's content)
    void
    Load(Application* context, const std::string& pathToLevel);
 
-   // pathToLevel - global path to level file (.dgl)
+   /**
+    * \brief Instantiate level from binary level data
+    *
+    * \param[in] context Application that owns the level
+    * \param[in] level View over binary level data (either mapped file or converted JSON)
+    * \param[in] navigation Baked navigation data (optional, used only if it's valid)
+    */
+   void
+   Load(Application* context, const LevelFileView& level,
+        const NavigationBake* navigation = nullptr);
+
+   /**
+    * \brief Load everything except level objects (textures, background, pathfinder, player
+    * and enemies). Objects are loaded afterwards with \c LoadObjects
+    *
+    * \param[in] context Application that owns the level
+    * \param[in] level View over binary level data
+    * \param[in] navigation Baked navigation data (optional, used only if it's valid)
+    */
+   void
+   LoadEnvironment(Application* context, const LevelFileView& level,
+                   const NavigationBake* navigation = nullptr);
+
+   /**
+    * \brief Instantiate a subset of level objects and append them to the level.
+    * Requires \c LoadEnvironment to be called first.
+    *
+    * \param[in] context Application that owns the level
+    * \param[in] level View over binary level data
+    * \param[in] objectIndices Indices (into \c LevelFileView::GetObjects) of objects to load
+    * \param[in] navigation Baked navigation data (optional). If it's valid, objects' nodes are
+    *                       taken from it, instead of being computed from their bounding boxes.
+    *
+    * \return IDs of loaded objects
+    */
+   std::vector< Object::ID >
+   LoadObjects(Application* context, const LevelFileView& level,
+               std::span< const uint32_t > objectIndices,
+               const NavigationBake* navigation = nullptr);
+
+   /**
+    * \brief Remove objects from the level, freeing their renderer slots and pathfinder nodes
+    *
+    * \param[in] objectIDs IDs of objects to unload
+    */
+   void
+   UnloadObjects(std::span< const Object::ID > objectIDs);
+
+   /**
+    * \brief Save the level. If possible, level file is updated in place (see \c SaveInPlace),
+    * otherwise the whole level is written. Level's journal is removed afterwards.
+    *
+    * \param[in] pathToLevel Global path to level file (.dglb saves binary format, JSON otherwise)
+    */
    void
    Save(const std::string& pathToLevel);
 
+   /**
+    * \brief Update only the modified objects in the binary level file (see \c PatchLevelFile).
+    * Requires change tracking, and that no objects were added or deleted and the environment
+    * didn't change since the last save.
+    *
+    * \param[in] pathToLevel Global path to level file, the one level was loaded from
+    *
+    * \return True if the level was saved
+    */
+   bool
+   SaveInPlace(const std::string& pathToLevel);
+
+   /**
+    * \brief Capture level state (records and strings only), so that it can be finalized and
+    * written on another thread (see \c LevelSaver). Changes made after this call are not part
+    * of the snapshot and stay unsaved. \c SnapshotSaved has to be called once it's written.
+    *
+    * \return Level data ready to be finalized
+    */
+   [[nodiscard]] LevelFileWriter
+   CreateSnapshot();
+
+   /**
+    * \brief Called once the snapshot (see \c CreateSnapshot) is written
+    *
+    * \param[in] pathToLevel Level file the snapshot was saved to
+    * \param[in] success Whether the file was written. If not, changes stay unsaved.
+    */
+   void
+   SnapshotSaved(const std::string& pathToLevel, bool success);
+
+   /**
+    * \brief Serialize level into binary level data (.dglb format)
+    *
+    * \return Binary level data
+    */
+   [[nodiscard]] std::vector< std::byte >
+   Serialize() const;
+
+   /**
+    * \brief Start tracking changes made to the level (used by the editor). Changes are written
+    * to the level's journal (see \c WriteJournal) and allow \c Save to write only modified
+    * objects.
+    *
+    * \param[in] pathToLevel Level file that the level was loaded from (empty if not saved yet)
+    * \param[in] hasUnsavedChanges Whether the level already differs from the file (for example
+    *                              the journal was applied on load), which requires a full save
+    */
+   void
+   EnableChangeTracking(const std::string& pathToLevel, bool hasUnsavedChanges);
+
+   /**
+    * \brief Mark the object as modified. Changes to the player, enemies or animation points
+    * mark the whole level environment as modified. Does nothing if tracking is not enabled.
+    *
+    * \param[in] objectID ID of the modified object
+    */
+   void
+   ObjectModified(Object::ID objectID);
+
+   [[nodiscard]] bool
+   HasUnsavedChanges() const;
+
+   /**
+    * \brief Append changes made since the last call to the level's journal (see level_journal.hpp)
+    */
+   void
+   WriteJournal();
+
    void
    Quit();
 
@@ -188,6 +315,19 @@ class Level
    GetNumOfObjects() const;
 
  private:
+   void
+   SerializeEnvironment(LevelFileWriter& writer) const;
+
+   void
+   SerializeObject(LevelFileWriter& writer, const GameObject& object) const;
+
+   [[nodiscard]] LevelFileWriter
+   CaptureState() const;
+
+   // Serialize given objects (and optionally the environment) only
+   [[nodiscard]] std::vector< std::byte >
+   SerializeChanges(const std::unordered_set< Object::ID >& objectIDs, bool environment) const;
+
    Application* contextPointer_ = nullptr;
    renderer::Sprite background_ = {};
    PathFinder pathFinder_ = {};
@@ -201,12 +341,35 @@ class Level
 
    std::string name_ = "DummyName";
    glm::ivec2 levelSize_ = {0, 0};
-   uint32_t tileWidth_ = 128;
+   uint32_t tileWidth_ = DEFAULT_TILE_SIZE;
 
    Player player_ = {};
    std::vector< Enemy > enemies_ = {};
    std::unordered_map< Object::ID, size_t > objectToIdx_ = {};
    std::vector< GameObject > objects_ = {};
+
+   // Persistent object IDs, stored in the level file (see ObjectRecord::uid)
+   std::unordered_map< Object::ID, uint32_t > objectToUid_ = {};
+   uint32_t nextObjectUid_ = 0;
+
+   // CHANGE TRACKING
+   bool trackChanges_ = false;
+   std::string trackedLevelFile_ = {};
+
+   // Changes not written to the journal yet
+   std::unordered_set< Object::ID > journalObjects_ = {};
+   std::vector< uint32_t > journalDeletedObjects_ = {};
+   bool journalEnvironment_ = false;
+
+   // Changes not saved to the level file yet. Anything other than modified objects
+   // (added/deleted objects, environment changes) requires a full save.
+   std::unordered_set< Object::ID > unsavedObjects_ = {};
+   bool fullSaveRequired_ = false;
+
+   // Changes captured by the snapshot that's being saved (see 'CreateSnapshot')
+   std::unordered_set< Object::ID > savingObjects_ = {};
+   bool savingFullSave_ = false;
+   bool saveInProgress_ = false;
 };
 
 } // namespace looper
\ No newline at end of file
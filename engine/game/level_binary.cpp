@@ -0,0 +1,765 @@
+#include "level_binary.hpp"
+#include "level_journal.hpp"
+#include "logger/logger.hpp"
+#include "utils/asset_archive.hpp"
+#include "utils/assert.hpp"
+#include "utils/file_manager.hpp"
+#include "utils/time/scoped_timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+
+namespace looper {
+
+static_assert(std::is_trivially_copyable_v< LevelFileHeader >);
+static_assert(std::is_trivially_copyable_v< BackgroundRecord >);
+static_assert(std::is_trivially_copyable_v< PlayerRecord >);
+static_assert(std::is_trivially_copyable_v< EnemyRecord >);
+static_assert(std::is_trivially_copyable_v< AnimationPointRecord >);
+static_assert(std::is_trivially_copyable_v< ObjectRecord >);
+static_assert(std::is_trivially_copyable_v< ChunkRecord >);
+static_assert(sizeof(LevelFileHeader) % 8 == 0);
+
+namespace {
+
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+size_t
+AlignOffset(size_t offset)
+{
+   return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+template < typename RecordType >
+uint64_t
+WriteSection(std::vector< std::byte >& buffer, std::span< const RecordType > records)
+{
+   const auto offset = AlignOffset(buffer.size());
+   buffer.resize(offset + records.size_bytes());
+
+   if (!records.empty())
+   {
+      std::memcpy(buffer.data() + offset, records.data(), records.size_bytes());
+   }
+
+   return offset;
+}
+
+glm::ivec2
+GetChunkCoords(const ObjectRecord& object)
+{
+   const auto center = object.position + static_cast< glm::vec2 >(object.size) / 2.0f;
+   const auto chunkSize = static_cast< float >(LEVEL_CHUNK_SIZE);
+
+   return {std::max(static_cast< int32_t >(std::floor(center.x / chunkSize)), 0),
+           std::max(static_cast< int32_t >(std::floor(center.y / chunkSize)), 0)};
+}
+
+glm::vec2
+ToVec2(const nlohmann::json& json)
+{
+   return {json[0].get< float >(), json[1].get< float >()};
+}
+
+glm::ivec2
+ToIVec2(const nlohmann::json& json)
+{
+   return {static_cast< int32_t >(json[0].get< float >()),
+           static_cast< int32_t >(json[1].get< float >())};
+}
+
+// Read the magic number and version from the start of the level file (zeros if it's too small)
+std::array< uint32_t, 2 >
+ReadMagicAndVersion(const std::filesystem::path& pathToLevel)
+{
+   std::array< uint32_t, 2 > magicAndVersion = {};
+
+   if (const auto archived = AssetArchive::Find(pathToLevel))
+   {
+      std::memcpy(magicAndVersion.data(), archived->data(),
+                  std::min(archived->size(), sizeof(magicAndVersion)));
+   }
+   else
+   {
+      std::ifstream fileHandle(pathToLevel, std::ios::binary);
+      // NOLINTNEXTLINE
+      fileHandle.read(reinterpret_cast< char* >(magicAndVersion.data()), sizeof(magicAndVersion));
+   }
+
+   return magicAndVersion;
+}
+
+std::filesystem::path
+GetJsonLevelPath(const std::filesystem::path& pathToLevel)
+{
+   auto jsonPath = pathToLevel;
+   return jsonPath.replace_extension(JSON_LEVEL_EXTENSION);
+}
+
+} // namespace
+
+/**************************************************************************************************
+ ***************************************** LevelFileView ******************************************
+ *************************************************************************************************/
+LevelFileView::LevelFileView(std::span< const std::byte > data) : data_(data)
+{
+   utils::Assert(data_.size() >= sizeof(LevelFileHeader),
+                 "LevelFileView: Data is too small to be a binary level!");
+
+   // NOLINTNEXTLINE
+   header_ = reinterpret_cast< const LevelFileHeader* >(data_.data());
+
+   utils::Assert(header_->magic == LEVEL_FILE_MAGIC, "LevelFileView: Invalid level file magic!");
+   utils::Assert(header_->version == LEVEL_FILE_VERSION,
+                 fmt::format("LevelFileView: Unsupported level file version {} (expected {})!",
+                             header_->version, LEVEL_FILE_VERSION));
+   utils::Assert(header_->stringTableOffset + header_->stringTableSize <= data_.size(),
+                 "LevelFileView: String table is out of bounds!");
+}
+
+template < typename RecordType >
+std::span< const RecordType >
+LevelFileView::GetSection(uint64_t offset, uint32_t count) const
+{
+   utils::Assert(offset % alignof(RecordType) == 0
+                    and offset + sizeof(RecordType) * count <= data_.size(),
+                 "LevelFileView: Section is out of bounds!");
+
+   // NOLINTNEXTLINE
+   return {reinterpret_cast< const RecordType* >(data_.data() + offset), count};
+}
+
+const BackgroundRecord&
+LevelFileView::GetBackground() const
+{
+   return GetSection< BackgroundRecord >(header_->backgroundOffset, 1).front();
+}
+
+const PlayerRecord&
+LevelFileView::GetPlayer() const
+{
+   return GetSection< PlayerRecord >(header_->playerOffset, 1).front();
+}
+
+std::span< const StringRef >
+LevelFileView::GetWeapons() const
+{
+   return GetSection< StringRef >(header_->weaponsOffset, header_->numWeapons);
+}
+
+std::span< const EnemyRecord >
+LevelFileView::GetEnemies() const
+{
+   return GetSection< EnemyRecord >(header_->enemiesOffset, header_->numEnemies);
+}
+
+std::span< const AnimationPointRecord >
+LevelFileView::GetAnimationPoints(const EnemyRecord& enemy) const
+{
+   utils::Assert(enemy.firstAnimationPoint + enemy.numAnimationPoints
+                    <= header_->numAnimationPoints,
+                 "LevelFileView: Animation points are out of bounds!");
+
+   return GetSection< AnimationPointRecord >(header_->animationPointsOffset,
+                                             header_->numAnimationPoints)
+      .subspan(enemy.firstAnimationPoint, enemy.numAnimationPoints);
+}
+
+std::span< const ObjectRecord >
+LevelFileView::GetObjects() const
+{
+   return GetSection< ObjectRecord >(header_->objectsOffset, header_->numObjects);
+}
+
+std::span< const ChunkRecord >
+LevelFileView::GetChunks() const
+{
+   return GetSection< ChunkRecord >(header_->chunksOffset, header_->numChunks);
+}
+
+std::span< const ObjectRecord >
+LevelFileView::GetObjects(const ChunkRecord& chunk) const
+{
+   utils::Assert(chunk.firstObject + chunk.numObjects <= header_->numObjects,
+                 "LevelFileView: Chunk objects are out of bounds!");
+
+   return GetObjects().subspan(chunk.firstObject, chunk.numObjects);
+}
+
+uint32_t
+LevelFileView::GetChunkSize() const
+{
+   return header_->chunkSize;
+}
+
+uint32_t
+LevelFileView::GetNextObjectUid() const
+{
+   return header_->nextObjectUid;
+}
+
+std::string_view
+LevelFileView::GetString(StringRef ref) const
+{
+   utils::Assert(static_cast< uint64_t >(ref.offset) + ref.length <= header_->stringTableSize,
+                 "LevelFileView: String is out of bounds!");
+
+   // NOLINTNEXTLINE
+   return {reinterpret_cast< const char* >(data_.data() + header_->stringTableOffset + ref.offset),
+           ref.length};
+}
+
+/**************************************************************************************************
+ **************************************** LevelFileWriter *****************************************
+ *************************************************************************************************/
+StringRef
+LevelFileWriter::AddString(std::string_view string)
+{
+   auto key = std::string{string};
+   const auto it = stringLookup_.find(key);
+   if (it != stringLookup_.end())
+   {
+      return it->second;
+   }
+
+   const auto ref = StringRef{static_cast< uint32_t >(stringTable_.size()),
+                              static_cast< uint32_t >(string.size())};
+   stringTable_.append(string);
+   stringLookup_.emplace(std::move(key), ref);
+
+   return ref;
+}
+
+void
+LevelFileWriter::SetBackground(const BackgroundRecord& background)
+{
+   background_ = background;
+}
+
+void
+LevelFileWriter::SetPlayer(const PlayerRecord& player, const std::vector< std::string >& weapons)
+{
+   player_ = player;
+
+   weapons_.clear();
+   for (const auto& weapon : weapons)
+   {
+      weapons_.push_back(AddString(weapon));
+   }
+}
+
+void
+LevelFileWriter::AddEnemy(EnemyRecord enemy,
+                          std::span< const AnimationPointRecord > animationPoints)
+{
+   enemy.firstAnimationPoint = static_cast< uint32_t >(animationPoints_.size());
+   enemy.numAnimationPoints = static_cast< uint32_t >(animationPoints.size());
+   animationPoints_.insert(animationPoints_.end(), animationPoints.begin(), animationPoints.end());
+
+   enemies_.push_back(enemy);
+}
+
+void
+LevelFileWriter::AddObject(const ObjectRecord& object)
+{
+   objects_.push_back(object);
+}
+
+std::vector< std::byte >
+LevelFileWriter::Finalize() const
+{
+   // Group objects by chunk (row by row), objects keep their order within the chunk
+   std::vector< glm::ivec2 > chunkCoords = {};
+   chunkCoords.reserve(objects_.size());
+   std::transform(objects_.begin(), objects_.end(), std::back_inserter(chunkCoords),
+                  GetChunkCoords);
+
+   std::vector< uint32_t > objectOrder(objects_.size());
+   std::iota(objectOrder.begin(), objectOrder.end(), 0);
+   std::stable_sort(objectOrder.begin(), objectOrder.end(),
+                    [&chunkCoords](uint32_t left, uint32_t right) {
+                       const auto& leftCoords = chunkCoords[left];
+                       const auto& rightCoords = chunkCoords[right];
+                       return leftCoords.y != rightCoords.y ? leftCoords.y < rightCoords.y
+                                                            : leftCoords.x < rightCoords.x;
+                    });
+
+   std::vector< ObjectRecord > objects = {};
+   std::vector< ChunkRecord > chunks = {};
+   objects.reserve(objects_.size());
+   uint32_t nextObjectUid = 0;
+
+   for (const auto idx : objectOrder)
+   {
+      if (chunks.empty() or chunks.back().coords != chunkCoords[idx])
+      {
+         chunks.push_back({chunkCoords[idx], static_cast< uint32_t >(objects.size()), 0});
+      }
+
+      ++chunks.back().numObjects;
+      objects.push_back(objects_[idx]);
+      nextObjectUid = std::max(nextObjectUid, objects_[idx].uid + 1);
+   }
+
+   std::vector< std::byte > buffer(sizeof(LevelFileHeader));
+
+   LevelFileHeader header = {};
+   header.numWeapons = static_cast< uint32_t >(weapons_.size());
+   header.numEnemies = static_cast< uint32_t >(enemies_.size());
+   header.numAnimationPoints = static_cast< uint32_t >(animationPoints_.size());
+   header.numObjects = static_cast< uint32_t >(objects.size());
+   header.numChunks = static_cast< uint32_t >(chunks.size());
+   header.nextObjectUid = nextObjectUid;
+   header.stringTableSize = static_cast< uint32_t >(stringTable_.size());
+
+   header.backgroundOffset =
+      WriteSection(buffer, std::span< const BackgroundRecord >{&background_, 1});
+   header.playerOffset = WriteSection(buffer, std::span< const PlayerRecord >{&player_, 1});
+   header.weaponsOffset = WriteSection(buffer, std::span< const StringRef >{weapons_});
+   header.enemiesOffset = WriteSection(buffer, std::span< const EnemyRecord >{enemies_});
+   header.animationPointsOffset =
+      WriteSection(buffer, std::span< const AnimationPointRecord >{animationPoints_});
+   header.objectsOffset = WriteSection(buffer, std::span< const ObjectRecord >{objects});
+   header.chunksOffset = WriteSection(buffer, std::span< const ChunkRecord >{chunks});
+   header.stringTableOffset =
+      WriteSection(buffer, std::as_bytes(std::span< const char >{stringTable_}));
+
+   std::memcpy(buffer.data(), &header, sizeof(header));
+
+   return buffer;
+}
+
+/**************************************************************************************************
+ ******************************************* LevelFile ********************************************
+ *************************************************************************************************/
+LevelFile::LevelFile(const std::filesystem::path& pathToLevel)
+{
+   // Binary files of older versions can't be mapped, read the JSON level they were converted from
+   auto sourcePath = pathToLevel;
+   if (IsOutdatedBinaryLevelFile(pathToLevel))
+   {
+      utils::Assert(CanLoadLevelFile(pathToLevel),
+                    fmt::format("LevelFile: {} uses an outdated binary format and there's no {} "
+                                "to convert it from!",
+                                pathToLevel.string(), GetJsonLevelPath(pathToLevel).string()));
+
+      sourcePath = GetJsonLevelPath(pathToLevel);
+      Logger::Warn("LevelFile: {} uses an outdated binary format (expected version {}), "
+                   "converting {} instead. Save the level to update it.",
+                   pathToLevel.string(), LEVEL_FILE_VERSION, sourcePath.string());
+   }
+
+   const auto isBinary = IsBinaryLevelFile(sourcePath);
+
+   if (HasLevelJournal(pathToLevel))
+   {
+      SCOPED_TIMER("Applying level journal");
+
+      nlohmann::json json = {};
+      if (isBinary)
+      {
+         const auto file = FileManager::MapFile(sourcePath);
+         json = ConvertLevelToJson(LevelFileView{file.GetData()});
+      }
+      else
+      {
+         json = FileManager::LoadJsonFile(sourcePath.string());
+      }
+
+      ApplyLevelJournal(json, pathToLevel);
+
+      convertedData_ = ConvertLevelToBinary(json);
+      journalApplied_ = true;
+   }
+   else if (isBinary)
+   {
+      mappedFile_ = std::make_unique< MappedFile >(FileManager::MapFile(sourcePath));
+      // Chunks are streamed in later, have them in memory by then
+      mappedFile_->Prefetch();
+   }
+   else
+   {
+      SCOPED_TIMER("Parsing JSON level");
+      convertedData_ = ConvertLevelToBinary(FileManager::LoadJsonFile(sourcePath.string()));
+   }
+}
+
+LevelFileView
+LevelFile::GetView() const
+{
+   return mappedFile_ ? LevelFileView{mappedFile_->GetData()} : LevelFileView{convertedData_};
+}
+
+bool
+LevelFile::HasAppliedJournal() const
+{
+   return journalApplied_;
+}
+
+/**************************************************************************************************
+ ****************************************** Conversions *******************************************
+ *************************************************************************************************/
+bool
+IsBinaryLevelFile(const std::filesystem::path& pathToLevel)
+{
+   return ReadMagicAndVersion(pathToLevel)[0] == LEVEL_FILE_MAGIC;
+}
+
+bool
+IsOutdatedBinaryLevelFile(const std::filesystem::path& pathToLevel)
+{
+   const auto [magic, version] = ReadMagicAndVersion(pathToLevel);
+   return magic == LEVEL_FILE_MAGIC and version != LEVEL_FILE_VERSION;
+}
+
+bool
+CanLoadLevelFile(const std::filesystem::path& pathToLevel)
+{
+   if (!IsOutdatedBinaryLevelFile(pathToLevel))
+   {
+      return true;
+   }
+
+   const auto jsonPath = GetJsonLevelPath(pathToLevel);
+   const auto jsonExists = AssetArchive::Find(jsonPath) or std::filesystem::exists(jsonPath);
+
+   return jsonPath != pathToLevel and jsonExists and !IsBinaryLevelFile(jsonPath);
+}
+
+bool
+HasBinaryLevelExtension(const std::filesystem::path& pathToLevel)
+{
+   return pathToLevel.extension() == BINARY_LEVEL_EXTENSION;
+}
+
+std::vector< std::byte >
+ConvertLevelToBinary(const nlohmann::json& json)
+{
+   LevelFileWriter writer;
+
+   // BACKGROUND
+   {
+      const auto& background = json["BACKGROUND"];
+      writer.SetBackground({writer.AddString(background["texture"].get< std::string >()),
+                            ToIVec2(background["size"])});
+   }
+
+   // PLAYER
+   {
+      const auto& player = json["PLAYER"];
+
+      PlayerRecord record = {};
+      record.name = writer.AddString(player["name"].get< std::string >());
+      record.texture = writer.AddString(player["texture"].get< std::string >());
+      record.editorGroup = writer.AddString(player.value("editor_group", std::string{"Default"}));
+      record.position = ToVec2(player["position"]);
+      record.size = ToIVec2(player["size"]);
+      record.rotation = player["rotation"].get< float >();
+      record.renderLayer = player.value("render_layer", 0);
+
+      writer.SetPlayer(record, player.value("weapons", std::vector< std::string >{}));
+   }
+
+   // ENEMIES
+   for (const auto& enemy : json.value("ENEMIES", nlohmann::json::array()))
+   {
+      EnemyRecord record = {};
+      record.name = writer.AddString(enemy["name"].get< std::string >());
+      record.texture = writer.AddString(enemy["texture"].get< std::string >());
+      record.editorGroup = writer.AddString(enemy.value("editor_group", std::string{"Default"}));
+      record.position = ToVec2(enemy["position"]);
+      record.size = ToIVec2(enemy["size"]);
+      record.rotation = enemy["rotation"].get< float >();
+      record.renderLayer = enemy.value("render_layer", 0);
+      record.animationType =
+         enemy.value("animation type", std::string{"Reversable"}) == "Loop" ? 0 : 1;
+
+      std::vector< AnimationPointRecord > animationPoints = {};
+      for (const auto& point : enemy.value("animate positions", nlohmann::json::array()))
+      {
+         animationPoints.push_back(
+            {ToVec2(point["end position"]), point["time duration"].get< float >()});
+      }
+
+      writer.AddEnemy(record, animationPoints);
+   }
+
+   // OBJECTS
+   std::vector< ObjectRecord > objects = {};
+   std::vector< size_t > objectsWithoutUid = {};
+   uint32_t nextObjectUid = 0;
+   for (const auto& object : json.value("OBJECTS", nlohmann::json::array()))
+   {
+      ObjectRecord record = {};
+      if (object.contains("uid"))
+      {
+         record.uid = object["uid"].get< uint32_t >();
+         nextObjectUid = std::max(nextObjectUid, record.uid + 1);
+      }
+      else
+      {
+         objectsWithoutUid.push_back(objects.size());
+      }
+      record.name = writer.AddString(object["name"].get< std::string >());
+      record.texture = writer.AddString(object["texture"].get< std::string >());
+      record.editorGroup = writer.AddString(object.value("editor_group", std::string{"Default"}));
+      record.position = ToVec2(object["position"]);
+      record.size = ToIVec2(object["size"]);
+      record.rotation = object["rotation"].get< float >();
+      record.renderLayer = object.value("render_layer", 0);
+      record.hasCollision = object["has collision"].get< bool >() ? 1 : 0;
+
+      objects.push_back(record);
+   }
+
+   // Levels saved before uids were introduced (or objects added by hand) get new uids,
+   // after all the existing ones so they can't collide
+   for (const auto idx : objectsWithoutUid)
+   {
+      objects[idx].uid = nextObjectUid++;
+   }
+
+   for (const auto& record : objects)
+   {
+      writer.AddObject(record);
+   }
+
+   return writer.Finalize();
+}
+
+nlohmann::json
+ConvertLevelToJson(const LevelFileView& level)
+{
+   nlohmann::json json;
+
+   // BACKGROUND
+   const auto& background = level.GetBackground();
+   json["BACKGROUND"]["texture"] = level.GetString(background.texture);
+   json["BACKGROUND"]["size"] = {background.size.x, background.size.y};
+
+   // PLAYER
+   const auto& player = level.GetPlayer();
+   json["PLAYER"]["name"] = level.GetString(player.name);
+   json["PLAYER"]["position"] = {player.position.x, player.position.y};
+   json["PLAYER"]["rotation"] = player.rotation;
+   json["PLAYER"]["size"] = {player.size.x, player.size.y};
+   json["PLAYER"]["texture"] = level.GetString(player.texture);
+   json["PLAYER"]["render_layer"] = player.renderLayer;
+   json["PLAYER"]["editor_group"] = level.GetString(player.editorGroup);
+
+   json["PLAYER"]["weapons"] = nlohmann::json::array();
+   for (const auto& weapon : level.GetWeapons())
+   {
+      json["PLAYER"]["weapons"].emplace_back(level.GetString(weapon));
+   }
+
+   // ENEMIES
+   json["ENEMIES"] = nlohmann::json::array();
+   for (const auto& enemy : level.GetEnemies())
+   {
+      nlohmann::json enemyJson;
+
+      enemyJson["name"] = level.GetString(enemy.name);
+      enemyJson["position"] = {enemy.position.x, enemy.position.y};
+      enemyJson["size"] = {enemy.size.x, enemy.size.y};
+      enemyJson["rotation"] = enemy.rotation;
+      enemyJson["texture"] = level.GetString(enemy.texture);
+      enemyJson["render_layer"] = enemy.renderLayer;
+      enemyJson["editor_group"] = level.GetString(enemy.editorGroup);
+      enemyJson["animation type"] = enemy.animationType == 0 ? "Loop" : "Reversable";
+
+      enemyJson["animate positions"] = nlohmann::json::array();
+      for (const auto& point : level.GetAnimationPoints(enemy))
+      {
+         nlohmann::json animationPoint;
+         animationPoint["end position"] = {point.end.x, point.end.y};
+         animationPoint["time duration"] = point.timeDuration;
+
+         enemyJson["animate positions"].emplace_back(animationPoint);
+      }
+
+      json["ENEMIES"].emplace_back(enemyJson);
+   }
+
+   // OBJECTS
+   json["OBJECTS"] = nlohmann::json::array();
+   for (const auto& object : level.GetObjects())
+   {
+      nlohmann::json objectJson;
+
+      objectJson["uid"] = object.uid;
+      objectJson["name"] = level.GetString(object.name);
+      objectJson["has collision"] = object.hasCollision != 0;
+      objectJson["position"] = {object.position.x, object.position.y};
+      objectJson["size"] = {object.size.x, object.size.y};
+      objectJson["rotation"] = object.rotation;
+      objectJson["texture"] = level.GetString(object.texture);
+      objectJson["render_layer"] = object.renderLayer;
+      objectJson["editor_group"] = level.GetString(object.editorGroup);
+
+      json["OBJECTS"].emplace_back(objectJson);
+   }
+
+   return json;
+}
+
+void
+ConvertLevelFile(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath)
+{
+   const auto inputBinary = IsBinaryLevelFile(inputPath);
+   const auto outputBinary = HasBinaryLevelExtension(outputPath);
+
+   if (inputBinary)
+   {
+      const auto file = FileManager::MapFile(inputPath);
+      const LevelFileView level(file.GetData());
+
+      if (outputBinary)
+      {
+         FileManager::SaveBinaryFile(outputPath.string(), file.GetData());
+      }
+      else
+      {
+         FileManager::SaveJsonFile(outputPath.string(), ConvertLevelToJson(level));
+      }
+   }
+   else
+   {
+      const auto json = FileManager::LoadJsonFile(inputPath.string());
+
+      if (outputBinary)
+      {
+         FileManager::SaveBinaryFile(outputPath.string(), ConvertLevelToBinary(json));
+      }
+      else
+      {
+         FileManager::SaveJsonFile(outputPath.string(), json);
+      }
+   }
+}
+
+bool
+SaveLevelFile(const std::filesystem::path& pathToLevel, std::span< const std::byte > level,
+              std::atomic< float >* progress)
+{
+   if (HasBinaryLevelExtension(pathToLevel))
+   {
+      return FileManager::SaveBinaryFileAtomic(pathToLevel.string(), level, progress);
+   }
+
+   const auto json = ConvertLevelToJson(LevelFileView{level}).dump();
+   return FileManager::SaveBinaryFileAtomic(pathToLevel.string(),
+                                            std::as_bytes(std::span< const char >{json}), progress);
+}
+
+bool
+PatchLevelFile(const std::filesystem::path& pathToLevel, const LevelFileView& changes)
+{
+   std::fstream fileHandle(pathToLevel, std::ios::binary | std::ios::in | std::ios::out);
+   if (!fileHandle.is_open())
+   {
+      return false;
+   }
+
+   LevelFileHeader header = {};
+   // NOLINTNEXTLINE
+   fileHandle.read(reinterpret_cast< char* >(&header), sizeof(header));
+   if (!fileHandle or header.magic != LEVEL_FILE_MAGIC or header.version != LEVEL_FILE_VERSION)
+   {
+      return false;
+   }
+
+   // Find where the changed objects are stored. Only the uids are needed, but records
+   // are small enough that reading the whole section is still a single sequential read
+   std::vector< ObjectRecord > objects(header.numObjects);
+   fileHandle.seekg(static_cast< std::streamoff >(header.objectsOffset));
+   // NOLINTNEXTLINE
+   fileHandle.read(reinterpret_cast< char* >(objects.data()),
+                   static_cast< std::streamsize >(objects.size() * sizeof(ObjectRecord)));
+   if (!fileHandle)
+   {
+      return false;
+   }
+
+   std::unordered_map< uint32_t, size_t > changedObjects = {};
+   for (size_t i = 0; i < changes.GetObjects().size(); ++i)
+   {
+      changedObjects.emplace(changes.GetObjects()[i].uid, i);
+   }
+
+   std::vector< std::pair< size_t, ObjectRecord > > records = {};
+   for (size_t i = 0; i < objects.size(); ++i)
+   {
+      const auto it = changedObjects.find(objects[i].uid);
+      if (it != changedObjects.end())
+      {
+         records.emplace_back(i, changes.GetObjects()[it->second]);
+      }
+   }
+
+   if (records.size() != changedObjects.size())
+   {
+      return false;
+   }
+
+   // New strings are appended to the string table (which is the last section in the file).
+   // Old strings stay in the table until the next full save.
+   std::string newStrings = {};
+   std::unordered_map< std::string_view, StringRef > stringLookup = {};
+   const auto addString = [&](StringRef ref) {
+      const auto string = changes.GetString(ref);
+      const auto it = stringLookup.find(string);
+      if (it != stringLookup.end())
+      {
+         return it->second;
+      }
+
+      const auto newRef =
+         StringRef{header.stringTableSize + static_cast< uint32_t >(newStrings.size()), ref.length};
+      newStrings.append(string);
+      stringLookup.emplace(string, newRef);
+
+      return newRef;
+   };
+
+   for (auto& [idx, record] : records)
+   {
+      record.name = addString(record.name);
+      record.texture = addString(record.texture);
+      record.editorGroup = addString(record.editorGroup);
+   }
+
+   // Only the changed records are written into the level file. If we're interrupted, the level
+   // journal (which is removed once the file is patched) still holds all the changes. Strings
+   // are written before the records that use them, so that the file stays readable.
+   fileHandle.seekp(
+      static_cast< std::streamoff >(header.stringTableOffset + header.stringTableSize));
+   fileHandle.write(newStrings.data(), static_cast< std::streamsize >(newStrings.size()));
+
+   header.stringTableSize += static_cast< uint32_t >(newStrings.size());
+   fileHandle.seekp(0);
+   // NOLINTNEXTLINE
+   fileHandle.write(reinterpret_cast< const char* >(&header), sizeof(header));
+
+   // Note that objects are not moved between chunks here, object that left its chunk will be
+   // streamed with its old chunk until the next full save
+   for (const auto& [idx, record] : records)
+   {
+      fileHandle.seekp(
+         static_cast< std::streamoff >(header.objectsOffset + idx * sizeof(ObjectRecord)));
+      // NOLINTNEXTLINE
+      fileHandle.write(reinterpret_cast< const char* >(&record), sizeof(record));
+   }
+
+   return static_cast< bool >(fileHandle.flush());
+}
+
+} // namespace looper
@@ -0,0 +1,345 @@
+#pragma once
+
+#include "utils/mapped_file.hpp"
+
+#include <glm/glm.hpp>
+#undef max
+#undef min
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace looper {
+
+/*
+ * Binary level format (.dglb)
+ *
+ * Layout (all sections are 8-byte aligned, little endian):
+ * [LevelFileHeader][BackgroundRecord][PlayerRecord][StringRef * numWeapons]
+ * [EnemyRecord * numEnemies][AnimationPointRecord * numAnimationPoints]
+ * [ObjectRecord * numObjects][ChunkRecord * numChunks][String table]
+ *
+ * Every record is a fixed size POD, so the file can be mapped into memory and read in place.
+ * Strings (names, textures, editor groups) live in a single string table and are referenced
+ * by offset/length pairs.
+ *
+ * Objects are grouped by the square chunk (of 'chunkSize' size) their center lies in, so that
+ * each chunk occupies a contiguous range of the objects section and can be loaded on its own.
+ *
+ * Each object has a persistent unique ID ('uid'), which doesn't change between saves. It's used
+ * to identify the object in the change journal and when patching the file in place.
+ */
+constexpr uint32_t LEVEL_FILE_MAGIC = 0x424C4744; // "DGLB"
+constexpr uint32_t LEVEL_FILE_VERSION = 3;
+constexpr uint32_t LEVEL_CHUNK_SIZE = 2048;
+constexpr std::string_view BINARY_LEVEL_EXTENSION = ".dglb";
+constexpr std::string_view JSON_LEVEL_EXTENSION = ".dgl";
+
+struct StringRef
+{
+   uint32_t offset = 0;
+   uint32_t length = 0;
+};
+
+struct LevelFileHeader
+{
+   uint32_t magic = LEVEL_FILE_MAGIC;
+   uint32_t version = LEVEL_FILE_VERSION;
+
+   uint32_t numWeapons = 0;
+   uint32_t numEnemies = 0;
+   uint32_t numAnimationPoints = 0;
+   uint32_t numObjects = 0;
+   uint32_t stringTableSize = 0;
+   uint32_t numChunks = 0;
+   uint32_t chunkSize = LEVEL_CHUNK_SIZE;
+   // First unused object uid
+   uint32_t nextObjectUid = 0;
+
+   uint64_t backgroundOffset = 0;
+   uint64_t playerOffset = 0;
+   uint64_t weaponsOffset = 0;
+   uint64_t enemiesOffset = 0;
+   uint64_t animationPointsOffset = 0;
+   uint64_t objectsOffset = 0;
+   uint64_t chunksOffset = 0;
+   uint64_t stringTableOffset = 0;
+};
+
+struct BackgroundRecord
+{
+   StringRef texture = {};
+   glm::ivec2 size = {};
+};
+
+struct PlayerRecord
+{
+   StringRef name = {};
+   StringRef texture = {};
+   StringRef editorGroup = {};
+   glm::vec2 position = {};
+   glm::ivec2 size = {};
+   float rotation = 0.0f;
+   int32_t renderLayer = 0;
+};
+
+struct EnemyRecord
+{
+   StringRef name = {};
+   StringRef texture = {};
+   StringRef editorGroup = {};
+   glm::vec2 position = {};
+   glm::ivec2 size = {};
+   float rotation = 0.0f;
+   int32_t renderLayer = 0;
+   // 0 - Loop, 1 - Reversable (matches Animatable::ANIMATION_TYPE)
+   uint32_t animationType = 1;
+   // Range in the animation points section
+   uint32_t firstAnimationPoint = 0;
+   uint32_t numAnimationPoints = 0;
+};
+
+struct AnimationPointRecord
+{
+   glm::vec2 end = {};
+   float timeDuration = 0.0f;
+};
+
+struct ObjectRecord
+{
+   StringRef name = {};
+   StringRef texture = {};
+   StringRef editorGroup = {};
+   glm::vec2 position = {};
+   glm::ivec2 size = {};
+   float rotation = 0.0f;
+   int32_t renderLayer = 0;
+   uint32_t hasCollision = 0;
+   uint32_t uid = 0;
+};
+
+struct ChunkRecord
+{
+   // Chunk's position in the chunk grid (in units of 'chunkSize')
+   glm::ivec2 coords = {};
+   // Range in the objects section
+   uint32_t firstObject = 0;
+   uint32_t numObjects = 0;
+};
+
+/**
+ * \brief Read-only view over binary level data. Doesn't own the memory, all returned
+ * spans and strings point directly into the underlying buffer.
+ */
+class LevelFileView
+{
+ public:
+   explicit LevelFileView(std::span< const std::byte > data);
+
+   [[nodiscard]] const BackgroundRecord&
+   GetBackground() const;
+
+   [[nodiscard]] const PlayerRecord&
+   GetPlayer() const;
+
+   [[nodiscard]] std::span< const StringRef >
+   GetWeapons() const;
+
+   [[nodiscard]] std::span< const EnemyRecord >
+   GetEnemies() const;
+
+   [[nodiscard]] std::span< const AnimationPointRecord >
+   GetAnimationPoints(const EnemyRecord& enemy) const;
+
+   [[nodiscard]] std::span< const ObjectRecord >
+   GetObjects() const;
+
+   [[nodiscard]] std::span< const ChunkRecord >
+   GetChunks() const;
+
+   [[nodiscard]] std::span< const ObjectRecord >
+   GetObjects(const ChunkRecord& chunk) const;
+
+   // Size (in level units) of the chunk's side
+   [[nodiscard]] uint32_t
+   GetChunkSize() const;
+
+   // First object uid that's not used by any object in this level
+   [[nodiscard]] uint32_t
+   GetNextObjectUid() const;
+
+   [[nodiscard]] std::string_view
+   GetString(StringRef ref) const;
+
+ private:
+   template < typename RecordType >
+   [[nodiscard]] std::span< const RecordType >
+   GetSection(uint64_t offset, uint32_t count) const;
+
+   std::span< const std::byte > data_ = {};
+   const LevelFileHeader* header_ = nullptr;
+};
+
+/**
+ * \brief Builds binary level data. Strings are deduplicated in the string table.
+ */
+class LevelFileWriter
+{
+ public:
+   [[nodiscard]] StringRef
+   AddString(std::string_view string);
+
+   void
+   SetBackground(const BackgroundRecord& background);
+
+   void
+   SetPlayer(const PlayerRecord& player, const std::vector< std::string >& weapons);
+
+   void
+   AddEnemy(EnemyRecord enemy, std::span< const AnimationPointRecord > animationPoints);
+
+   void
+   AddObject(const ObjectRecord& object);
+
+   /**
+    * \brief Serialize all added records into a single buffer. Objects are reordered,
+    * so that objects from the same chunk are stored next to each other.
+    *
+    * \return Binary level data, ready to be saved or viewed with \c LevelFileView
+    */
+   [[nodiscard]] std::vector< std::byte >
+   Finalize() const;
+
+ private:
+   BackgroundRecord background_ = {};
+   PlayerRecord player_ = {};
+   std::vector< StringRef > weapons_ = {};
+   std::vector< EnemyRecord > enemies_ = {};
+   std::vector< AnimationPointRecord > animationPoints_ = {};
+   std::vector< ObjectRecord > objects_ = {};
+
+   std::string stringTable_ = {};
+   std::unordered_map< std::string, StringRef > stringLookup_ = {};
+};
+
+/**
+ * \brief Level file loaded into memory. Binary level files are mapped, JSON level files
+ * are converted into the binary format.
+ */
+class LevelFile
+{
+ public:
+   explicit LevelFile(const std::filesystem::path& pathToLevel);
+
+   [[nodiscard]] LevelFileView
+   GetView() const;
+
+   // Whether unsaved changes from the level's journal were applied (see level_journal.hpp)
+   [[nodiscard]] bool
+   HasAppliedJournal() const;
+
+ private:
+   std::unique_ptr< MappedFile > mappedFile_ = nullptr;
+   std::vector< std::byte > convertedData_ = {};
+   bool journalApplied_ = false;
+};
+
+/**
+ * \brief Checks whether given file is in the binary level format (based on its magic number)
+ *
+ * \param[in] pathToLevel Path to the existing level file
+ *
+ * \return True if it's a binary level file
+ */
+[[nodiscard]] bool
+IsBinaryLevelFile(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Checks whether given file is a binary level file saved with an older
+ * \c LEVEL_FILE_VERSION. Such files can't be read in place, \c LevelFile converts
+ * the JSON level (.dgl) next to it instead.
+ *
+ * \param[in] pathToLevel Path to the existing level file
+ *
+ * \return True if it's a binary level file of a different version
+ */
+[[nodiscard]] bool
+IsOutdatedBinaryLevelFile(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Checks whether given level file can be loaded with \c LevelFile. Only outdated
+ * binary files without the JSON level (.dgl) next to them can't be loaded.
+ *
+ * \param[in] pathToLevel Path to the existing level file
+ *
+ * \return True if the level can be loaded
+ */
+[[nodiscard]] bool
+CanLoadLevelFile(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Checks whether given path has binary level extension (.dglb). Used when saving,
+ * where the file might not exist yet.
+ */
+[[nodiscard]] bool
+HasBinaryLevelExtension(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Convert JSON level (.dgl) into binary level data (.dglb)
+ */
+[[nodiscard]] std::vector< std::byte >
+ConvertLevelToBinary(const nlohmann::json& json);
+
+/**
+ * \brief Convert binary level data (.dglb) into JSON level (.dgl)
+ */
+[[nodiscard]] nlohmann::json
+ConvertLevelToJson(const LevelFileView& level);
+
+/**
+ * \brief Convert level file between formats. Output format is deduced from \c outputPath extension.
+ *
+ * \param[in] inputPath Level file to convert (either .dgl or .dglb)
+ * \param[in] outputPath Where to save the converted level
+ */
+void
+ConvertLevelFile(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath);
+
+/**
+ * \brief Save binary level data to file. The file is replaced atomically
+ * (see \c FileManager::SaveBinaryFileAtomic), so it's safe to call from worker threads.
+ *
+ * \param[in] pathToLevel Level file (.dglb saves binary format, JSON otherwise)
+ * \param[in] level Binary level data
+ * \param[out] progress Optional, updated with the fraction of data that's written
+ *
+ * \return True if the level was saved
+ */
+[[nodiscard]] bool
+SaveLevelFile(const std::filesystem::path& pathToLevel, std::span< const std::byte > level,
+              std::atomic< float >* progress = nullptr);
+
+/**
+ * \brief Update objects of the existing binary level file in place. Only the changed records
+ * (and their new strings) are written, the rest of the file is left untouched. Interrupted
+ * update is recovered by the level journal, so it has to be removed only after this succeeds.
+ *
+ * \param[in] pathToLevel Binary level file to update
+ * \param[in] changes Binary level data with modified objects (matched by their uid)
+ *
+ * \return False if the file couldn't be patched (it's not a binary level, or some objects
+ * don't exist in it). The file is left untouched in that case.
+ */
+[[nodiscard]] bool
+PatchLevelFile(const std::filesystem::path& pathToLevel, const LevelFileView& changes);
+
+} // namespace looper
@@ -0,0 +1,176 @@
+#include "level_journal.hpp"
+#include "logger/logger.hpp"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace looper {
+
+namespace {
+
+void
+WriteEntry(std::ofstream& journal, const char* type, const nlohmann::json& value)
+{
+   nlohmann::json entry;
+   entry[type] = value;
+
+   // Single line per entry, so that incomplete (last) entry can be detected on load
+   journal << entry.dump() << '\n';
+}
+
+} // namespace
+
+std::filesystem::path
+GetLevelJournalPath(const std::filesystem::path& pathToLevel)
+{
+   auto journalPath = pathToLevel;
+   journalPath += ".journal";
+
+   return journalPath;
+}
+
+bool
+HasLevelJournal(const std::filesystem::path& pathToLevel)
+{
+   return std::filesystem::exists(GetLevelJournalPath(pathToLevel));
+}
+
+void
+AppendToLevelJournal(const std::filesystem::path& pathToLevel, const LevelFileView& changes,
+                     std::span< const uint32_t > deletedObjects, bool environmentChanged)
+{
+   std::ofstream journal(GetLevelJournalPath(pathToLevel), std::ios::app);
+   if (!journal.is_open())
+   {
+      Logger::Warn("Level journal for {} can't be opened!", pathToLevel.string());
+      return;
+   }
+
+   const auto json = ConvertLevelToJson(changes);
+
+   if (environmentChanged)
+   {
+      nlohmann::json environment;
+      environment["BACKGROUND"] = json["BACKGROUND"];
+      environment["PLAYER"] = json["PLAYER"];
+      environment["ENEMIES"] = json["ENEMIES"];
+
+      WriteEntry(journal, "ENVIRONMENT", environment);
+   }
+
+   for (const auto& object : json["OBJECTS"])
+   {
+      WriteEntry(journal, "OBJECT", object);
+   }
+
+   for (const auto uid : deletedObjects)
+   {
+      WriteEntry(journal, "DELETED", uid);
+   }
+
+   journal.flush();
+}
+
+void
+ApplyLevelJournal(nlohmann::json& level, const std::filesystem::path& pathToLevel)
+{
+   std::ifstream journal(GetLevelJournalPath(pathToLevel));
+   if (!journal.is_open())
+   {
+      return;
+   }
+
+   auto& objects = level["OBJECTS"];
+   if (!objects.is_array())
+   {
+      objects = nlohmann::json::array();
+   }
+
+   // Objects without uid use their index (see ConvertLevelToBinary). Store it explicitly,
+   // since indices change once deleted objects are removed.
+   std::unordered_map< uint32_t, size_t > uidToIdx = {};
+   for (size_t i = 0; i < objects.size(); ++i)
+   {
+      const auto uid = objects[i].value("uid", static_cast< uint32_t >(i));
+      objects[i]["uid"] = uid;
+      uidToIdx[uid] = i;
+   }
+
+   std::unordered_set< size_t > deletedObjects = {};
+   size_t numEntries = 0;
+
+   std::string line;
+   while (std::getline(journal, line))
+   {
+      const auto entry = nlohmann::json::parse(line, nullptr, false);
+      if (entry.is_discarded())
+      {
+         Logger::Warn("Level journal for {} has incomplete entry {}, ignoring it!",
+                      pathToLevel.string(), numEntries);
+         break;
+      }
+
+      if (entry.contains("OBJECT"))
+      {
+         const auto& object = entry["OBJECT"];
+         const auto uid = object["uid"].get< uint32_t >();
+
+         const auto it = uidToIdx.find(uid);
+         if (it != uidToIdx.end())
+         {
+            objects[it->second] = object;
+            deletedObjects.erase(it->second);
+         }
+         else
+         {
+            uidToIdx[uid] = objects.size();
+            objects.push_back(object);
+         }
+      }
+      else if (entry.contains("DELETED"))
+      {
+         const auto it = uidToIdx.find(entry["DELETED"].get< uint32_t >());
+         if (it != uidToIdx.end())
+         {
+            deletedObjects.insert(it->second);
+         }
+      }
+      else if (entry.contains("ENVIRONMENT"))
+      {
+         for (const auto& [key, value] : entry["ENVIRONMENT"].items())
+         {
+            level[key] = value;
+         }
+      }
+
+      ++numEntries;
+   }
+
+   if (!deletedObjects.empty())
+   {
+      auto remaining = nlohmann::json::array();
+      for (size_t i = 0; i < objects.size(); ++i)
+      {
+         if (!deletedObjects.contains(i))
+         {
+            remaining.push_back(std::move(objects[i]));
+         }
+      }
+
+      objects = std::move(remaining);
+   }
+
+   Logger::Info("Applied {} unsaved changes from level journal for {}", numEntries,
+                pathToLevel.string());
+}
+
+void
+RemoveLevelJournal(const std::filesystem::path& pathToLevel)
+{
+   std::error_code errorCode;
+   std::filesystem::remove(GetLevelJournalPath(pathToLevel), errorCode);
+}
+
+} // namespace looper
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "level_binary.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace looper {
+
+/*
+ * Level journal holds changes made to the level since it was last saved. It's stored next to
+ * the level file ("<level>.journal") and is append-only, each line is a single JSON entry:
+ *
+ *   {"OBJECT": {...}}       - object was added or modified (identified by its "uid")
+ *   {"DELETED": uid}        - object was deleted
+ *   {"ENVIRONMENT": {...}}  - new "BACKGROUND", "PLAYER" and "ENEMIES" state
+ *
+ * The journal is applied on top of the level file when it's loaded and removed once the level
+ * is saved. If the application crashed while writing an entry, the incomplete line is ignored.
+ */
+
+[[nodiscard]] std::filesystem::path
+GetLevelJournalPath(const std::filesystem::path& pathToLevel);
+
+[[nodiscard]] bool
+HasLevelJournal(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Append changes to the level's journal
+ *
+ * \param[in] pathToLevel Level file that the changes are made to
+ * \param[in] changes Binary level data with added/modified objects and (optionally) environment
+ * \param[in] deletedObjects Uids of deleted objects
+ * \param[in] environmentChanged Whether environment from \c changes should be written
+ */
+void
+AppendToLevelJournal(const std::filesystem::path& pathToLevel, const LevelFileView& changes,
+                     std::span< const uint32_t > deletedObjects, bool environmentChanged);
+
+/**
+ * \brief Apply all journal entries to the level (in JSON format)
+ *
+ * \param[in, out] level Level data that will be updated
+ * \param[in] pathToLevel Level file that the journal belongs to
+ */
+void
+ApplyLevelJournal(nlohmann::json& level, const std::filesystem::path& pathToLevel);
+
+void
+RemoveLevelJournal(const std::filesystem::path& pathToLevel);
+
+} // namespace looper
@@ -0,0 +1,148 @@
+#include "level_loader.hpp"
+#include "level.hpp"
+#include "utils/time/timer.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <utility>
+
+namespace looper {
+
+namespace {
+// Minimal number of objects loaded in a single batch
+constexpr size_t MIN_OBJECTS_PER_BATCH = 64;
+} // namespace
+
+LevelLoader::LevelLoader(Application* context, std::shared_ptr< Level > level,
+                         const std::string& pathToLevel)
+   : context_(context),
+     level_(std::move(level)),
+     levelFile_(pathToLevel),
+     navigation_(pathToLevel, levelFile_.GetView(), level_->GetTileSize())
+{
+   const auto numObjects = levelFile_.GetView().GetObjects().size();
+   objectOrder_.resize(numObjects);
+   std::iota(objectOrder_.begin(), objectOrder_.end(), 0);
+   objectDistances_.resize(numObjects, 0.0f);
+}
+
+void
+LevelLoader::LoadEnvironment()
+{
+   const auto view = levelFile_.GetView();
+   level_->LoadEnvironment(context_, view, &navigation_);
+
+   const auto& player = view.GetPlayer();
+   Prioritize(player.position + static_cast< glm::vec2 >(player.size) / 2.0f);
+}
+
+void
+LevelLoader::Prioritize(const glm::vec2& focusPoint)
+{
+   focusPoint_ = focusPoint;
+   const auto objects = levelFile_.GetView().GetObjects();
+
+   std::vector< std::pair< float, uint32_t > > remaining = {};
+   remaining.reserve(objectOrder_.size() - numLoaded_);
+
+   for (auto i = numLoaded_; i < objectOrder_.size(); ++i)
+   {
+      const auto& object = objects[objectOrder_[i]];
+      const auto center = object.position + static_cast< glm::vec2 >(object.size) / 2.0f;
+      remaining.emplace_back(glm::distance(center, focusPoint), objectOrder_[i]);
+   }
+
+   // Stable sort so objects at the same distance keep their order from the level file
+   std::stable_sort(remaining.begin(), remaining.end(),
+                    [](const auto& left, const auto& right) { return left.first < right.first; });
+
+   for (size_t i = 0; i < remaining.size(); ++i)
+   {
+      objectDistances_[numLoaded_ + i] = remaining[i].first;
+      objectOrder_[numLoaded_ + i] = remaining[i].second;
+   }
+}
+
+void
+LevelLoader::SetFocusPoint(const glm::vec2& focusPoint)
+{
+   if (!IsFinished() and glm::distance(focusPoint, focusPoint_) > REFOCUS_DISTANCE)
+   {
+      Prioritize(focusPoint);
+   }
+}
+
+bool
+LevelLoader::Step(time::microseconds budget)
+{
+   const auto view = levelFile_.GetView();
+
+   time::Timer timer;
+   auto elapsed = time::microseconds{0};
+
+   while (!IsFinished() and elapsed < budget)
+   {
+      // Estimate how many objects fit into what's left of the budget
+      auto batchSize = MIN_OBJECTS_PER_BATCH;
+      if (timePerObject_.count() > 0.0f)
+      {
+         const auto numRemaining = static_cast< float >(objectOrder_.size() - numLoaded_);
+         const auto estimatedSize = std::min((budget - elapsed) / timePerObject_, numRemaining);
+         batchSize = std::max(batchSize, static_cast< size_t >(estimatedSize));
+      }
+      batchSize = std::min(batchSize, objectOrder_.size() - numLoaded_);
+
+      level_->LoadObjects(context_, view,
+                          std::span< const uint32_t >{objectOrder_}.subspan(numLoaded_, batchSize),
+                          &navigation_);
+      numLoaded_ += batchSize;
+
+      timer.ToggleTimer();
+      const auto batchTime = timer.GetMicroDeltaTime();
+      elapsed += batchTime;
+
+      const auto batchTimePerObject = batchTime / static_cast< float >(batchSize);
+      timePerObject_ = timePerObject_.count() > 0.0f
+                          ? (timePerObject_ + batchTimePerObject) / 2.0f
+                          : batchTimePerObject;
+   }
+
+   return IsFinished();
+}
+
+float
+LevelLoader::GetProgress() const
+{
+   return objectOrder_.empty()
+             ? 1.0f
+             : static_cast< float >(numLoaded_) / static_cast< float >(objectOrder_.size());
+}
+
+size_t
+LevelLoader::GetNumLoadedObjects() const
+{
+   return numLoaded_;
+}
+
+size_t
+LevelLoader::GetNumObjects() const
+{
+   return objectOrder_.size();
+}
+
+bool
+LevelLoader::IsFinished() const
+{
+   return numLoaded_ == objectOrder_.size();
+}
+
+bool
+LevelLoader::IsAreaLoaded(float radius) const
+{
+   // Objects are loaded in order of their distance, so the area is loaded
+   // once the next object to load lies outside of it
+   return IsFinished() or objectDistances_[numLoaded_] > radius;
+}
+
+} // namespace looper
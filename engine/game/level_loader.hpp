@@ -0,0 +1,123 @@
+#pragma once
+
+#include "common.hpp"
+#include "level_binary.hpp"
+#include "navigation_bake.hpp"
+#include "utils/time/time_type.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace looper {
+
+class Application;
+class Level;
+
+/**
+ * \brief Resumable level loader. Level environment (textures, background, pathfinder,
+ * player and enemies) is loaded at once, while objects are instantiated in slices
+ * (see \c Step) so that loading can be spread across multiple frames.
+ * Objects closest to the focus point (by default the player, then the camera) are loaded first.
+ */
+class LevelLoader
+{
+ public:
+   // By default, loading can take up to half of the frame
+   static constexpr time::microseconds DEFAULT_FRAME_BUDGET =
+      time::microseconds{TARGET_TIME_MICRO / 2.0f};
+
+   // How far the focus point has to move, before objects are reordered again (see SetFocusPoint)
+   static constexpr float REFOCUS_DISTANCE = static_cast< float >(LEVEL_CHUNK_SIZE) / 4.0f;
+
+   /**
+    * \brief Open the level file and keep its data alive until the loading is finished
+    *
+    * \param[in] context Application that owns the level
+    * \param[in] level Level that will be loaded
+    * \param[in] pathToLevel Global path to level file (.dgl or .dglb)
+    */
+   LevelLoader(Application* context, std::shared_ptr< Level > level,
+               const std::string& pathToLevel);
+
+   /**
+    * \brief Load everything except objects and prioritize objects around the player
+    */
+   void
+   LoadEnvironment();
+
+   /**
+    * \brief Reorder objects that are not loaded yet, based on their distance to \c focusPoint
+    *
+    * \param[in] focusPoint Position (in global coordinates) around which objects are loaded first
+    */
+   void
+   Prioritize(const glm::vec2& focusPoint);
+
+   /**
+    * \brief Move the focus point (e.g. when the camera moves). Objects are only reordered
+    * once it's more than \c REFOCUS_DISTANCE away from the point they were ordered by.
+    *
+    * \param[in] focusPoint Position (in global coordinates) around which objects are loaded first
+    */
+   void
+   SetFocusPoint(const glm::vec2& focusPoint);
+
+   /**
+    * \brief Load objects in batches until \c budget is spent (at least one batch is loaded)
+    *
+    * \param[in] budget Time that can be spent in this step
+    *
+    * \return True if all objects are loaded
+    */
+   bool
+   Step(time::microseconds budget);
+
+   /**
+    * \brief Get loading progress
+    *
+    * \return Value in range [0, 1]
+    */
+   [[nodiscard]] float
+   GetProgress() const;
+
+   [[nodiscard]] size_t
+   GetNumLoadedObjects() const;
+
+   [[nodiscard]] size_t
+   GetNumObjects() const;
+
+   [[nodiscard]] bool
+   IsFinished() const;
+
+   /**
+    * \brief Checks whether all objects within \c radius from the focus point are loaded
+    *
+    * \param[in] radius Distance from the focus point
+    *
+    * \return True if the area is loaded
+    */
+   [[nodiscard]] bool
+   IsAreaLoaded(float radius) const;
+
+ private:
+   Application* context_ = nullptr;
+   std::shared_ptr< Level > level_ = nullptr;
+   LevelFile levelFile_;
+   NavigationBake navigation_;
+
+   // Object indices (into LevelFileView::GetObjects) in loading order and their distance to
+   // the focus point. First 'numLoaded_' objects are already loaded.
+   std::vector< uint32_t > objectOrder_ = {};
+   std::vector< float > objectDistances_ = {};
+   size_t numLoaded_ = 0;
+   glm::vec2 focusPoint_ = {};
+
+   // Estimated time needed to load a single object, used to size the batches
+   time::microseconds timePerObject_ = time::microseconds{0};
+};
+
+} // namespace looper
@@ -0,0 +1,74 @@
+#include "level_saver.hpp"
+#include "level.hpp"
+#include "logger/logger.hpp"
+#include "thread_pool.hpp"
+#include "utils/time/scoped_timer.hpp"
+
+#include <chrono>
+#include <utility>
+
+namespace looper {
+
+LevelSaver::LevelSaver(ThreadPool& threadPool, std::shared_ptr< Level > level,
+                       std::string pathToLevel)
+   : level_(std::move(level)), pathToLevel_(std::move(pathToLevel))
+{
+   {
+      SCOPED_TIMER("Level snapshot");
+      snapshot_ = level_->CreateSnapshot();
+   }
+
+   // Worker only touches the snapshot, the level can be modified in the meantime
+   result_ = threadPool.enqueue([this] {
+      const auto levelData = snapshot_.Finalize();
+      return SaveLevelFile(pathToLevel_, levelData, &progress_);
+   });
+}
+
+LevelSaver::~LevelSaver()
+{
+   Finish();
+}
+
+bool
+LevelSaver::Finish()
+{
+   if (!finished_)
+   {
+      success_ = result_.get();
+      finished_ = true;
+
+      level_->SnapshotSaved(pathToLevel_, success_);
+
+      if (success_)
+      {
+         Logger::Info("Level saved to {}", pathToLevel_);
+      }
+      else
+      {
+         Logger::Warn("Level couldn't be saved to {}!", pathToLevel_);
+      }
+   }
+
+   return success_;
+}
+
+bool
+LevelSaver::IsFinished() const
+{
+   return finished_ or result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+float
+LevelSaver::GetProgress() const
+{
+   return progress_.load();
+}
+
+const std::string&
+LevelSaver::GetPath() const
+{
+   return pathToLevel_;
+}
+
+} // namespace looper
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "level_binary.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace looper {
+
+class Level;
+class ThreadPool;
+
+/**
+ * \brief Saves the level without blocking the caller. Level state is captured on construction
+ * (see \c Level::CreateSnapshot), then it's finalized, converted (for JSON levels) and written
+ * on a ThreadPool worker. File is written to a temporary and renamed over the level file,
+ * so it's never left half-written.
+ */
+class LevelSaver
+{
+ public:
+   /**
+    * \brief Capture the level state and start saving it
+    *
+    * \param[in] threadPool Pool that runs the save
+    * \param[in] level Level to save
+    * \param[in] pathToLevel Global path to level file (.dglb saves binary format, JSON otherwise)
+    */
+   LevelSaver(ThreadPool& threadPool, std::shared_ptr< Level > level, std::string pathToLevel);
+
+   // Waits for the save to finish (see 'Finish')
+   ~LevelSaver();
+
+   LevelSaver(const LevelSaver&) = delete;
+   LevelSaver&
+   operator=(const LevelSaver&) = delete;
+   LevelSaver(LevelSaver&&) = delete;
+   LevelSaver&
+   operator=(LevelSaver&&) = delete;
+
+   /**
+    * \brief Wait for the save to finish and notify the level (see \c Level::SnapshotSaved).
+    * Has to be called from the thread that owns the level.
+    *
+    * \return True if the level was saved
+    */
+   bool
+   Finish();
+
+   [[nodiscard]] bool
+   IsFinished() const;
+
+   /**
+    * \brief Get saving progress
+    *
+    * \return Value in range [0, 1]
+    */
+   [[nodiscard]] float
+   GetProgress() const;
+
+   [[nodiscard]] const std::string&
+   GetPath() const;
+
+ private:
+   std::shared_ptr< Level > level_ = nullptr;
+   std::string pathToLevel_ = {};
+   LevelFileWriter snapshot_ = {};
+
+   std::atomic< float > progress_ = 0.0f;
+   std::future< bool > result_ = {};
+   bool finished_ = false;
+   bool success_ = false;
+};
+
+} // namespace looper
@@ -0,0 +1,225 @@
+#include "level_streamer.hpp"
+#include "level.hpp"
+#include "utils/assert.hpp"
+#include "utils/time/timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace looper {
+
+LevelStreamer::LevelStreamer(Application* context, std::shared_ptr< Level > level,
+                             const std::string& pathToLevel)
+   : context_(context),
+     level_(std::move(level)),
+     levelFile_(pathToLevel),
+     navigation_(pathToLevel, levelFile_.GetView(), level_->GetTileSize())
+{
+   const auto view = levelFile_.GetView();
+   chunkSize_ = static_cast< float >(view.GetChunkSize());
+
+   for (const auto& chunk : view.GetChunks())
+   {
+      const auto min = static_cast< glm::vec2 >(chunk.coords) * chunkSize_;
+      chunks_.push_back({min, min + glm::vec2{chunkSize_, chunkSize_}, false, {}});
+      gridSize_ = glm::max(gridSize_, chunk.coords + glm::ivec2{1, 1});
+   }
+
+   // Chunk coordinates are never negative (see LevelFileWriter)
+   chunkGrid_.resize(static_cast< size_t >(gridSize_.x) * static_cast< size_t >(gridSize_.y),
+                     -1);
+   for (size_t i = 0; i < view.GetChunks().size(); ++i)
+   {
+      const auto& coords = view.GetChunks()[i].coords;
+      chunkGrid_[static_cast< size_t >(coords.y * gridSize_.x + coords.x)] =
+         static_cast< int32_t >(i);
+   }
+}
+
+void
+LevelStreamer::LoadEnvironment()
+{
+   level_->LoadEnvironment(context_, levelFile_.GetView(), &navigation_);
+}
+
+void
+LevelStreamer::SetRadius(float loadRadius, float unloadRadius)
+{
+   utils::Assert(unloadRadius >= loadRadius,
+                 fmt::format("LevelStreamer: Unload radius ({}) is smaller than load radius ({})!",
+                             unloadRadius, loadRadius));
+
+   loadRadius_ = loadRadius;
+   unloadRadius_ = unloadRadius;
+}
+
+void
+LevelStreamer::Update(std::span< const glm::vec2 > focusPoints, time::microseconds budget)
+{
+   // Iterate backwards, unloading removes the chunk from the list
+   for (auto i = loadedChunks_.size(); i > 0; --i)
+   {
+      const auto chunkIdx = loadedChunks_[i - 1];
+      if (DistanceToChunk(chunks_[chunkIdx], focusPoints) > unloadRadius_)
+      {
+         UnloadChunk(chunkIdx);
+      }
+   }
+
+   // Only the cells around focus points can be within the load radius
+   std::vector< std::pair< float, size_t > > chunksToLoad = {};
+   for (const auto& point : focusPoints)
+   {
+      const auto [minCell, maxCell] = GetCellRange(point, loadRadius_);
+      for (auto y = minCell.y; y <= maxCell.y; ++y)
+      {
+         for (auto x = minCell.x; x <= maxCell.x; ++x)
+         {
+            const auto chunkIdx = GetChunkAt({x, y});
+            if (chunkIdx < 0 or chunks_[static_cast< size_t >(chunkIdx)].loaded)
+            {
+               continue;
+            }
+
+            const auto distance =
+               DistanceToChunk(chunks_[static_cast< size_t >(chunkIdx)], focusPoints);
+            if (distance <= loadRadius_)
+            {
+               chunksToLoad.emplace_back(distance, static_cast< size_t >(chunkIdx));
+            }
+         }
+      }
+   }
+
+   // Areas of focus points can overlap
+   std::sort(chunksToLoad.begin(), chunksToLoad.end());
+   chunksToLoad.erase(std::unique(chunksToLoad.begin(), chunksToLoad.end()), chunksToLoad.end());
+
+   time::Timer timer;
+   auto elapsed = time::microseconds{0};
+
+   for (const auto& [distance, chunkIdx] : chunksToLoad)
+   {
+      if (elapsed >= budget)
+      {
+         break;
+      }
+
+      LoadChunk(chunkIdx);
+
+      timer.ToggleTimer();
+      elapsed += timer.GetMicroDeltaTime();
+   }
+}
+
+bool
+LevelStreamer::IsAreaLoaded(const glm::vec2& position, float radius) const
+{
+   const auto [minCell, maxCell] = GetCellRange(position, radius);
+   for (auto y = minCell.y; y <= maxCell.y; ++y)
+   {
+      for (auto x = minCell.x; x <= maxCell.x; ++x)
+      {
+         const auto chunkIdx = GetChunkAt({x, y});
+         if (chunkIdx < 0)
+         {
+            continue;
+         }
+
+         const auto& chunk = chunks_[static_cast< size_t >(chunkIdx)];
+         if (!chunk.loaded
+             and DistanceToChunk(chunk, std::span< const glm::vec2 >{&position, 1}) <= radius)
+         {
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+size_t
+LevelStreamer::GetNumLoadedChunks() const
+{
+   return loadedChunks_.size();
+}
+
+size_t
+LevelStreamer::GetNumChunks() const
+{
+   return chunks_.size();
+}
+
+float
+LevelStreamer::DistanceToChunk(const Chunk& chunk, std::span< const glm::vec2 > points)
+{
+   auto minDistance = std::numeric_limits< float >::max();
+
+   for (const auto& point : points)
+   {
+      // Distance to the closest point on chunk's area (0 if it's inside)
+      const auto dx = std::max({chunk.min.x - point.x, 0.0f, point.x - chunk.max.x});
+      const auto dy = std::max({chunk.min.y - point.y, 0.0f, point.y - chunk.max.y});
+
+      minDistance = std::min(minDistance, std::sqrt(dx * dx + dy * dy));
+   }
+
+   return minDistance;
+}
+
+std::pair< glm::ivec2, glm::ivec2 >
+LevelStreamer::GetCellRange(const glm::vec2& point, float radius) const
+{
+   if (chunks_.empty())
+   {
+      return {glm::ivec2{0, 0}, glm::ivec2{-1, -1}};
+   }
+
+   // Clamped before the conversion, so that far away points can't overflow
+   const auto lastCell = glm::vec2{gridSize_ - glm::ivec2{1, 1}};
+   const auto toCell = [this, &lastCell](const glm::vec2& position) {
+      return glm::ivec2{glm::clamp(glm::floor(position / chunkSize_), glm::vec2{0.0f}, lastCell)};
+   };
+
+   return {toCell(point - radius), toCell(point + radius)};
+}
+
+int32_t
+LevelStreamer::GetChunkAt(const glm::ivec2& cell) const
+{
+   return chunkGrid_[static_cast< size_t >(cell.y * gridSize_.x + cell.x)];
+}
+
+void
+LevelStreamer::LoadChunk(size_t chunkIdx)
+{
+   const auto view = levelFile_.GetView();
+   const auto& chunkRecord = view.GetChunks()[chunkIdx];
+
+   std::vector< uint32_t > objectIndices(chunkRecord.numObjects);
+   std::iota(objectIndices.begin(), objectIndices.end(), chunkRecord.firstObject);
+
+   auto& chunk = chunks_[chunkIdx];
+   chunk.objects = level_->LoadObjects(context_, view, objectIndices, &navigation_);
+   chunk.loaded = true;
+   loadedChunks_.push_back(chunkIdx);
+}
+
+void
+LevelStreamer::UnloadChunk(size_t chunkIdx)
+{
+   auto& chunk = chunks_[chunkIdx];
+   level_->UnloadObjects(chunk.objects);
+
+   chunk.objects.clear();
+   chunk.objects.shrink_to_fit();
+   chunk.loaded = false;
+   std::erase(loadedChunks_, chunkIdx);
+}
+
+} // namespace looper
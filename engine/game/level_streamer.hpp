@@ -0,0 +1,127 @@
+#pragma once
+
+#include "level_binary.hpp"
+#include "navigation_bake.hpp"
+#include "object.hpp"
+#include "utils/time/time_type.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace looper {
+
+class Application;
+class Level;
+
+/**
+ * \brief Streams level objects in and out, one chunk (see \c ChunkRecord) at a time, based on
+ * the distance to the focus points (camera, player). Chunks are loaded once they're within the
+ * load radius and unloaded once they leave the (bigger) unload radius, so chunks on the border
+ * don't get loaded and unloaded every frame.
+ *
+ * Unloading a chunk frees its objects, along with their renderer slots, occupied pathfinder
+ * nodes and rewind states. Level environment (background, pathfinder grid, player and enemies)
+ * stays resident.
+ */
+class LevelStreamer
+{
+ public:
+   /**
+    * \brief Open the level file and keep it opened for the level's lifetime
+    *
+    * \param[in] context Application that owns the level
+    * \param[in] level Level that will be streamed
+    * \param[in] pathToLevel Global path to level file (.dgl or .dglb)
+    */
+   LevelStreamer(Application* context, std::shared_ptr< Level > level,
+                 const std::string& pathToLevel);
+
+   /**
+    * \brief Load everything except objects (see \c Level::LoadEnvironment)
+    */
+   void
+   LoadEnvironment();
+
+   /**
+    * \brief Set the streaming distances
+    *
+    * \param[in] loadRadius Chunks closer than this to any focus point get loaded
+    * \param[in] unloadRadius Chunks further than this from all focus points get unloaded
+    */
+   void
+   SetRadius(float loadRadius, float unloadRadius);
+
+   /**
+    * \brief Unload chunks that left the unload radius and load the ones that entered the load
+    * radius (closest first), until \c budget is spent. At least one chunk is loaded per call.
+    *
+    * \param[in] focusPoints Positions (in global coordinates) around which the level is loaded
+    * \param[in] budget Time that can be spent on loading chunks
+    */
+   void
+   Update(std::span< const glm::vec2 > focusPoints, time::microseconds budget);
+
+   /**
+    * \brief Checks whether all chunks within \c radius from \c position are loaded
+    */
+   [[nodiscard]] bool
+   IsAreaLoaded(const glm::vec2& position, float radius) const;
+
+   [[nodiscard]] size_t
+   GetNumLoadedChunks() const;
+
+   [[nodiscard]] size_t
+   GetNumChunks() const;
+
+ private:
+   struct Chunk
+   {
+      // Chunk's area (in global coordinates)
+      glm::vec2 min = {};
+      glm::vec2 max = {};
+      bool loaded = false;
+      std::vector< Object::ID > objects = {};
+   };
+
+   [[nodiscard]] static float
+   DistanceToChunk(const Chunk& chunk, std::span< const glm::vec2 > points);
+
+   // Range of grid cells (inclusive, clamped to the grid) that overlap the square
+   // of size 2 * radius around the point. Empty range if the level has no chunks.
+   [[nodiscard]] std::pair< glm::ivec2, glm::ivec2 >
+   GetCellRange(const glm::vec2& point, float radius) const;
+
+   // Chunk's index at given grid coordinates (-1 if there's no chunk)
+   [[nodiscard]] int32_t
+   GetChunkAt(const glm::ivec2& cell) const;
+
+   void
+   LoadChunk(size_t chunkIdx);
+
+   void
+   UnloadChunk(size_t chunkIdx);
+
+   Application* context_ = nullptr;
+   std::shared_ptr< Level > level_ = nullptr;
+   LevelFile levelFile_;
+   NavigationBake navigation_;
+
+   std::vector< Chunk > chunks_ = {};
+   // Chunks are only looked up by their grid coordinates, so each update only visits the cells
+   // around the focus points and the loaded chunks, not the whole level
+   std::vector< int32_t > chunkGrid_ = {};
+   glm::ivec2 gridSize_ = {};
+   float chunkSize_ = static_cast< float >(LEVEL_CHUNK_SIZE);
+   std::vector< size_t > loadedChunks_ = {};
+
+   float loadRadius_ = static_cast< float >(LEVEL_CHUNK_SIZE);
+   float unloadRadius_ = static_cast< float >(2 * LEVEL_CHUNK_SIZE);
+};
+
+} // namespace looper
@@ -0,0 +1,341 @@
+#include "navigation_bake.hpp"
+#include "logger/logger.hpp"
+#include "renderer/sprite.hpp"
+#include "utils/asset_archive.hpp"
+#include "utils/file_manager.hpp"
+#include "utils/hash.hpp"
+#include "utils/time/scoped_timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <queue>
+#include <type_traits>
+
+namespace looper {
+
+static_assert(std::is_trivially_copyable_v< NavigationBakeHeader >);
+static_assert(std::is_trivially_copyable_v< NavigationObjectRecord >);
+static_assert(sizeof(NavigationBakeHeader) % 8 == 0);
+
+namespace {
+
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+size_t
+AlignOffset(size_t offset)
+{
+   return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+template < typename RecordType >
+uint64_t
+WriteSection(std::vector< std::byte >& buffer, std::span< const RecordType > records)
+{
+   const auto offset = AlignOffset(buffer.size());
+   buffer.resize(offset + records.size_bytes());
+
+   if (!records.empty())
+   {
+      std::memcpy(buffer.data() + offset, records.data(), records.size_bytes());
+   }
+
+   return offset;
+}
+
+glm::ivec2
+ComputeGridSize(const glm::ivec2& levelSize, uint32_t tileSize)
+{
+   // Same as the pathfinder's grid (see PathFinder::Initialize)
+   return levelSize / static_cast< int32_t >(tileSize);
+}
+
+// Tiles that the object occupies once it's loaded and rotated (see GameObject::UpdateCollision)
+std::vector< Tile >
+RasterizeObject(const ObjectRecord& object, const glm::ivec2& levelSize, uint32_t tileSize)
+{
+   const auto angle = glm::clamp(object.rotation, renderer::Sprite::ROTATION_RANGE.first,
+                                 renderer::Sprite::ROTATION_RANGE.second);
+   const auto box = renderer::Sprite::ComputeBoundingBox(
+      object.position, static_cast< glm::vec2 >(object.size), angle);
+
+   return GetTilesFromBoundingBox(box, levelSize, tileSize);
+}
+
+// Label connected (4-neighbourhood, same as pathfinder's nodes) areas of free nodes
+uint32_t
+LabelRegions(const glm::ivec2& gridSize, std::span< const uint8_t > occupancy,
+             std::span< uint32_t > regions)
+{
+   std::fill(regions.begin(), regions.end(), INVALID_REGION);
+
+   uint32_t numRegions = 0;
+   std::queue< int32_t > nodesToVisit = {};
+
+   for (int32_t start = 0; start < gridSize.x * gridSize.y; ++start)
+   {
+      if (occupancy[static_cast< size_t >(start)] != 0
+          or regions[static_cast< size_t >(start)] != INVALID_REGION)
+      {
+         continue;
+      }
+
+      regions[static_cast< size_t >(start)] = numRegions;
+      nodesToVisit.push(start);
+
+      while (!nodesToVisit.empty())
+      {
+         const auto node = nodesToVisit.front();
+         nodesToVisit.pop();
+
+         const auto x = node % gridSize.x;
+         const auto y = node / gridSize.x;
+
+         const auto visit = [&](int32_t neighbour) {
+            const auto idx = static_cast< size_t >(neighbour);
+            if (occupancy[idx] == 0 and regions[idx] == INVALID_REGION)
+            {
+               regions[idx] = numRegions;
+               nodesToVisit.push(neighbour);
+            }
+         };
+
+         if (y > 0)
+         {
+            visit(node - gridSize.x);
+         }
+         if (y < gridSize.y - 1)
+         {
+            visit(node + gridSize.x);
+         }
+         if (x > 0)
+         {
+            visit(node - 1);
+         }
+         if (x < gridSize.x - 1)
+         {
+            visit(node + 1);
+         }
+      }
+
+      ++numRegions;
+   }
+
+   return numRegions;
+}
+
+} // namespace
+
+/**************************************************************************************************
+ **************************************** NavigationBake ******************************************
+ *************************************************************************************************/
+NavigationBake::NavigationBake(const std::filesystem::path& pathToLevel,
+                               const LevelFileView& level, uint32_t tileSize)
+{
+   const auto bakePath = GetNavigationBakePath(pathToLevel);
+
+   const auto archived = AssetArchive::Find(bakePath);
+   std::error_code errorCode;
+   const auto fileSize =
+      archived ? archived->size() : std::filesystem::file_size(bakePath, errorCode);
+   if (errorCode or fileSize < sizeof(NavigationBakeHeader))
+   {
+      return;
+   }
+
+   // Object tiles are looked up in chunk order, not front to back
+   mappedFile_ = std::make_unique< MappedFile >(
+      FileManager::MapFile(bakePath, MappedFile::AccessPattern::RANDOM));
+   const auto data = mappedFile_->GetData();
+
+   // NOLINTNEXTLINE
+   const auto* header = reinterpret_cast< const NavigationBakeHeader* >(data.data());
+
+   const auto numNodes = static_cast< uint64_t >(header->gridSize.x)
+                         * static_cast< uint64_t >(header->gridSize.y);
+   const auto valid =
+      header->magic == NAVIGATION_BAKE_MAGIC and header->version == NAVIGATION_BAKE_VERSION
+      and header->occupancyOffset + numNodes <= data.size()
+      and header->regionsOffset + numNodes * sizeof(uint32_t) <= data.size()
+      and header->objectsOffset + header->numObjects * sizeof(NavigationObjectRecord)
+             <= data.size()
+      and header->tilesOffset + header->numTiles * sizeof(glm::ivec2) <= data.size();
+
+   if (!valid)
+   {
+      Logger::Warn("NavigationBake: {} is not a valid navigation bake, ignoring it!",
+                   bakePath.string());
+      mappedFile_.reset();
+      return;
+   }
+
+   if (header->contentHash != ComputeNavigationHash(level, tileSize)
+       or header->numObjects != level.GetObjects().size()
+       or header->gridSize != ComputeGridSize(level.GetBackground().size, tileSize))
+   {
+      Logger::Info("NavigationBake: {} is out of date, navigation will be computed on load",
+                   bakePath.string());
+      mappedFile_.reset();
+      return;
+   }
+
+   header_ = header;
+}
+
+bool
+NavigationBake::IsValid() const
+{
+   return header_ != nullptr;
+}
+
+glm::ivec2
+NavigationBake::GetGridSize() const
+{
+   return header_->gridSize;
+}
+
+std::span< const uint8_t >
+NavigationBake::GetOccupancy() const
+{
+   const auto numNodes = static_cast< uint32_t >(header_->gridSize.x * header_->gridSize.y);
+   return GetSection< uint8_t >(header_->occupancyOffset, numNodes);
+}
+
+std::span< const uint32_t >
+NavigationBake::GetRegions() const
+{
+   const auto numNodes = static_cast< uint32_t >(header_->gridSize.x * header_->gridSize.y);
+   return GetSection< uint32_t >(header_->regionsOffset, numNodes);
+}
+
+std::vector< Tile >
+NavigationBake::GetObjectTiles(uint32_t objectIdx) const
+{
+   const auto& object =
+      GetSection< NavigationObjectRecord >(header_->objectsOffset, header_->numObjects)[objectIdx];
+   const auto tiles = GetSection< glm::ivec2 >(header_->tilesOffset, header_->numTiles)
+                         .subspan(object.firstTile, object.numTiles);
+
+   std::vector< Tile > ret = {};
+   ret.reserve(tiles.size());
+   std::transform(tiles.begin(), tiles.end(), std::back_inserter(ret),
+                  [](const auto& tile) { return Tile{tile.x, tile.y}; });
+
+   return ret;
+}
+
+template < typename T >
+std::span< const T >
+NavigationBake::GetSection(uint64_t offset, uint32_t count) const
+{
+   // NOLINTNEXTLINE
+   return {reinterpret_cast< const T* >(mappedFile_->GetData().data() + offset), count};
+}
+
+/**************************************************************************************************
+ ****************************************** Functions *********************************************
+ *************************************************************************************************/
+std::filesystem::path
+GetNavigationBakePath(const std::filesystem::path& pathToLevel)
+{
+   auto bakePath = pathToLevel;
+   bakePath += NAVIGATION_BAKE_EXTENSION;
+
+   return bakePath;
+}
+
+uint64_t
+ComputeNavigationHash(const LevelFileView& level, uint32_t tileSize)
+{
+   auto hash = utils::HashValue(NAVIGATION_BAKE_VERSION);
+   hash = utils::HashValue(tileSize, hash);
+   hash = utils::HashValue(level.GetBackground().size, hash);
+
+   const auto objects = level.GetObjects();
+   hash = utils::HashValue(static_cast< uint64_t >(objects.size()), hash);
+
+   for (const auto& object : objects)
+   {
+      hash = utils::HashValue(object.position, hash);
+      hash = utils::HashValue(object.size, hash);
+      hash = utils::HashValue(object.rotation, hash);
+      hash = utils::HashValue(object.hasCollision, hash);
+   }
+
+   return hash;
+}
+
+std::vector< std::byte >
+BakeNavigation(const LevelFileView& level, uint32_t tileSize)
+{
+   const auto levelSize = level.GetBackground().size;
+   const auto gridSize = ComputeGridSize(levelSize, tileSize);
+   const auto numNodes = static_cast< size_t >(gridSize.x) * static_cast< size_t >(gridSize.y);
+   const auto objects = level.GetObjects();
+
+   std::vector< uint8_t > occupancy(numNodes, 0);
+   std::vector< NavigationObjectRecord > objectRecords = {};
+   std::vector< glm::ivec2 > tiles = {};
+   objectRecords.reserve(objects.size());
+
+   for (const auto& object : objects)
+   {
+      const auto objectTiles = RasterizeObject(object, levelSize, tileSize);
+      objectRecords.push_back({static_cast< uint32_t >(tiles.size()),
+                               static_cast< uint32_t >(objectTiles.size())});
+
+      for (const auto& [x, y] : objectTiles)
+      {
+         tiles.emplace_back(x, y);
+
+         const auto insideGrid = x >= 0 and x < gridSize.x and y >= 0 and y < gridSize.y;
+         if (object.hasCollision != 0 and insideGrid)
+         {
+            occupancy[static_cast< size_t >(x + y * gridSize.x)] = 1;
+         }
+      }
+   }
+
+   std::vector< uint32_t > regions(numNodes, INVALID_REGION);
+
+   NavigationBakeHeader header = {};
+   header.contentHash = ComputeNavigationHash(level, tileSize);
+   header.gridSize = gridSize;
+   header.tileSize = tileSize;
+   header.numRegions = LabelRegions(gridSize, occupancy, regions);
+   header.numObjects = static_cast< uint32_t >(objectRecords.size());
+   header.numTiles = static_cast< uint32_t >(tiles.size());
+
+   std::vector< std::byte > buffer(sizeof(NavigationBakeHeader));
+   header.occupancyOffset = WriteSection< uint8_t >(buffer, occupancy);
+   header.regionsOffset = WriteSection< uint32_t >(buffer, regions);
+   header.objectsOffset = WriteSection< NavigationObjectRecord >(buffer, objectRecords);
+   header.tilesOffset = WriteSection< glm::ivec2 >(buffer, tiles);
+
+   std::memcpy(buffer.data(), &header, sizeof(NavigationBakeHeader));
+
+   return buffer;
+}
+
+bool
+BakeNavigationFile(const std::filesystem::path& pathToLevel, uint32_t tileSize)
+{
+   SCOPED_TIMER(fmt::format("Baking navigation for {}", pathToLevel.string()));
+
+   const LevelFile levelFile(pathToLevel);
+   const auto bake = BakeNavigation(levelFile.GetView(), tileSize);
+   const auto bakePath = GetNavigationBakePath(pathToLevel);
+
+   if (!FileManager::SaveBinaryFileAtomic(bakePath.string(), bake))
+   {
+      Logger::Warn("Navigation bake couldn't be saved to {}!", bakePath.string());
+      return false;
+   }
+
+   Logger::Info("Navigation bake saved to {}", bakePath.string());
+   return true;
+}
+
+} // namespace looper
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "level_binary.hpp"
+#include "path_finder.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace looper {
+
+/*
+ * Navigation bake (.nav) holds pathfinder data precomputed from the level file. It's stored
+ * next to the level file ("<level>.nav") and it's valid as long as its content hash matches
+ * the level (see \c ComputeNavigationHash), otherwise it's ignored and everything is computed
+ * at load time.
+ *
+ * Layout (all sections are 8-byte aligned, little endian):
+ * [NavigationBakeHeader][uint8_t occupancy * numNodes][uint32_t region * numNodes]
+ * [NavigationObjectRecord * numObjects][glm::ivec2 tile * numTiles]
+ *
+ * Nodes are indexed the same way as pathfinder's nodes (x + y * gridSize.x). Objects are indexed
+ * the same way as objects in the level file, each one references the range of tiles it occupies.
+ * Region labels identify connected areas of free nodes (occupied nodes have INVALID_REGION).
+ */
+constexpr uint32_t NAVIGATION_BAKE_MAGIC = 0x564E4744; // "DGNV"
+constexpr uint32_t NAVIGATION_BAKE_VERSION = 1;
+constexpr uint32_t INVALID_REGION = std::numeric_limits< uint32_t >::max();
+constexpr std::string_view NAVIGATION_BAKE_EXTENSION = ".nav";
+
+struct NavigationBakeHeader
+{
+   uint32_t magic = NAVIGATION_BAKE_MAGIC;
+   uint32_t version = NAVIGATION_BAKE_VERSION;
+   uint64_t contentHash = 0;
+
+   glm::ivec2 gridSize = {};
+   uint32_t tileSize = 0;
+   uint32_t numRegions = 0;
+   uint32_t numObjects = 0;
+   uint32_t numTiles = 0;
+
+   uint64_t occupancyOffset = 0;
+   uint64_t regionsOffset = 0;
+   uint64_t objectsOffset = 0;
+   uint64_t tilesOffset = 0;
+};
+
+struct NavigationObjectRecord
+{
+   // Range in the tiles section
+   uint32_t firstTile = 0;
+   uint32_t numTiles = 0;
+};
+
+/**
+ * \brief Navigation bake of the level, mapped into memory
+ */
+class NavigationBake
+{
+ public:
+   /**
+    * \brief Map the navigation bake of the level (if there's one)
+    *
+    * \param[in] pathToLevel Level file that the bake belongs to
+    * \param[in] level Level data, used to check whether the bake is up to date
+    * \param[in] tileSize Size of the pathfinder's node used by the level
+    */
+   NavigationBake(const std::filesystem::path& pathToLevel, const LevelFileView& level,
+                  uint32_t tileSize);
+
+   // Whether the bake exists and matches the level
+   [[nodiscard]] bool
+   IsValid() const;
+
+   [[nodiscard]] glm::ivec2
+   GetGridSize() const;
+
+   [[nodiscard]] std::span< const uint8_t >
+   GetOccupancy() const;
+
+   [[nodiscard]] std::span< const uint32_t >
+   GetRegions() const;
+
+   /**
+    * \brief Get tiles occupied by the object
+    *
+    * \param[in] objectIdx Index of the object (into \c LevelFileView::GetObjects)
+    *
+    * \return Tiles occupied by the object
+    */
+   [[nodiscard]] std::vector< Tile >
+   GetObjectTiles(uint32_t objectIdx) const;
+
+ private:
+   template < typename T >
+   [[nodiscard]] std::span< const T >
+   GetSection(uint64_t offset, uint32_t count) const;
+
+   std::unique_ptr< MappedFile > mappedFile_ = nullptr;
+   const NavigationBakeHeader* header_ = nullptr;
+};
+
+[[nodiscard]] std::filesystem::path
+GetNavigationBakePath(const std::filesystem::path& pathToLevel);
+
+/**
+ * \brief Compute the hash of everything that navigation data depends on (level size,
+ * tile size and objects' transforms and collision)
+ *
+ * \param[in] level Level data
+ * \param[in] tileSize Size of the pathfinder's node
+ *
+ * \return 64-bit FNV-1a hash
+ */
+[[nodiscard]] uint64_t
+ComputeNavigationHash(const LevelFileView& level, uint32_t tileSize);
+
+/**
+ * \brief Rasterize all level objects into the pathfinder's grid and label connected regions.
+ * Doesn't require the renderer, so it can run from command line tools.
+ *
+ * \param[in] level Level data
+ * \param[in] tileSize Size of the pathfinder's node
+ *
+ * \return Navigation bake data
+ */
+[[nodiscard]] std::vector< std::byte >
+BakeNavigation(const LevelFileView& level, uint32_t tileSize);
+
+/**
+ * \brief Bake navigation of the level file and save it next to it (see \c GetNavigationBakePath)
+ *
+ * \param[in] pathToLevel Level file (.dgl or .dglb)
+ * \param[in] tileSize Size of the pathfinder's node
+ *
+ * \return True if the bake was saved
+ */
+bool
+BakeNavigationFile(const std::filesystem::path& pathToLevel,
+                   uint32_t tileSize = DEFAULT_TILE_SIZE);
+
+} // namespace looper
@@ -4,9 +4,71 @@
 
 #include <algorithm>
 #include <list>
+#include <set>
 
 namespace looper {
 
+Tile
+GetTileFromPosition(const glm::vec2& position, const glm::ivec2& levelSize, uint32_t tileSize)
+{
+   if (position.x < 0 or position.x >= static_cast< float >(levelSize.x) or position.y < 0
+       or position.y >= static_cast< float >(levelSize.y))
+   {
+      return INVALID_TILE;
+   }
+
+   const auto w = static_cast< int32_t >(glm::floor(position.x / static_cast< float >(tileSize)));
+   const auto h = static_cast< int32_t >(glm::floor(position.y / static_cast< float >(tileSize)));
+
+   return {w, h};
+}
+
+std::vector< Tile >
+GetTilesAlongTheLine(const glm::vec2& fromPos, const glm::vec2& toPos, const glm::ivec2& levelSize,
+                     uint32_t tileSize)
+{
+   std::set< Tile > tiles;
+
+   const auto numSteps =
+      static_cast< uint32_t >(glm::length(toPos - fromPos)) / (tileSize / uint32_t{2});
+
+   const auto stepSize = (toPos - fromPos) / static_cast< float >(numSteps);
+
+   for (uint32_t i = 0; i < numSteps; ++i)
+   {
+      tiles.insert(
+         GetTileFromPosition(fromPos + (stepSize * static_cast< float >(i)), levelSize, tileSize));
+   }
+
+   return {tiles.begin(), tiles.end()};
+}
+
+std::vector< Tile >
+GetTilesFromBoundingBox(const std::array< glm::vec2, 4 >& box, const glm::ivec2& levelSize,
+                        uint32_t tileSize)
+{
+   std::set< Tile > ret;
+
+   auto insertToVec = [&ret, &levelSize, tileSize](const glm::vec2& from, const glm::vec2& to) {
+      for (const auto& tile : GetTilesAlongTheLine(from, to, levelSize, tileSize))
+      {
+         ret.insert(tile);
+      }
+   };
+
+   // Standard Rect
+   insertToVec(box[0], box[3]);
+   insertToVec(box[3], box[2]);
+   insertToVec(box[2], box[1]);
+   insertToVec(box[1], box[0]);
+
+   // Diagonals for inside nodes
+   insertToVec(box[0], box[2]);
+   insertToVec(box[1], box[3]);
+
+   return std::vector< Tile >{ret.begin(), ret.end()};
+}
+
 PathFinder::PathFinder(Level* level, std::vector< Node >&& nodes)
    : nodes_(std::move(nodes)), levelHandle_(level)
 {
@@ -131,6 +193,16 @@ PathFinder::GetPath(const glm::vec2& source, const glm::vec2& destination)
    auto& nodeStart = GetNodeFromPosition(source);
    auto& nodeEnd = GetNodeFromPosition(destination);
 
+   // Both nodes are free, but there's no way between them. Return the same result
+   // as the search below would, once it runs out of nodes to test.
+   if (!regions_.empty() and numNodesChangedSinceBake_ == 0 and !nodeStart.occupied_
+       and !nodeEnd.occupied_
+       and regions_[static_cast< size_t >(nodeStart.nodeId_)]
+              != regions_[static_cast< size_t >(nodeEnd.nodeId_)])
+   {
+      return {nodeEnd.nodeId_};
+   }
+
    // Reset Navigation Graph - default all node states
    stl::for_each(nodes_, [](auto& node) {
       node.parentNode_ = -1;
@@ -271,7 +343,11 @@ PathFinder::SetNodeOccupied(const Tile& nodeCoords, Object::ID objectID)
    if (nodeCoords != INVALID_TILE)
    {
       auto& nodeAtTile = GetNodeFromTile(nodeCoords);
-      nodeAtTile.occupied_ = true;
+      if (!nodeAtTile.occupied_)
+      {
+         nodeAtTile.occupied_ = true;
+         NodeOccupancyChanged(nodeAtTile);
+      }
       nodeAtTile.objectsOccupyingThisNode_.push_back(objectID);
 
       nodesModifiedLastFrame_.insert(nodeAtTile.tile_);
@@ -298,6 +374,7 @@ PathFinder::SetNodeFreed(const Tile& nodeCoords, Object::ID objectID)
          if (nodeAtTile.objectsOccupyingThisNode_.empty())
          {
             nodeAtTile.occupied_ = false;
+            NodeOccupancyChanged(nodeAtTile);
             nodesModifiedLastFrame_.insert(nodeAtTile.tile_);
          }
       }
@@ -316,6 +393,45 @@ PathFinder::IsInitialized() const
    return initialized_;
 }
 
+void
+PathFinder::SetRegions(std::span< const uint8_t > occupancy, std::span< const uint32_t > regions)
+{
+   utils::Assert(occupancy.size() == nodes_.size() and regions.size() == nodes_.size(),
+                 fmt::format("PathFinder: Baked regions ({}) don't match the nodes ({})!",
+                             regions.size(), nodes_.size()));
+
+   bakedOccupancy_.assign(occupancy.begin(), occupancy.end());
+   regions_.assign(regions.begin(), regions.end());
+
+   numNodesChangedSinceBake_ = 0;
+   for (const auto& node : nodes_)
+   {
+      if (node.occupied_ != (bakedOccupancy_[static_cast< size_t >(node.nodeId_)] != 0))
+      {
+         ++numNodesChangedSinceBake_;
+      }
+   }
+}
+
+void
+PathFinder::NodeOccupancyChanged(const Node& node)
+{
+   if (regions_.empty())
+   {
+      return;
+   }
+
+   // Node either went back to its baked state, or just started to differ from it
+   if (node.occupied_ == (bakedOccupancy_[static_cast< size_t >(node.nodeId_)] != 0))
+   {
+      --numNodesChangedSinceBake_;
+   }
+   else
+   {
+      ++numNodesChangedSinceBake_;
+   }
+}
+
 void
 PathFinder::ClearPerFrameData()
 {
@@ -3,8 +3,10 @@
 #include "common.hpp"
 #include "object.hpp"
 
+#include <array>
 #include <glm/glm.hpp>
 #include <limits>
+#include <span>
 #include <unordered_set>
 #include <vector>
 
@@ -28,6 +30,41 @@ namespace looper {
 
 class Level;
 
+// Size (in level units) of the pathfinder's node
+constexpr uint32_t DEFAULT_TILE_SIZE = 128;
+
+/**
+ * \brief Get tile on given position
+ *
+ * \param[in] position Position on the map
+ * \param[in] levelSize Size of the level
+ * \param[in] tileSize Size of the tile
+ *
+ * \return Tile or INVALID_TILE if \c position is outside the level
+ */
+[[nodiscard]] Tile
+GetTileFromPosition(const glm::vec2& position, const glm::ivec2& levelSize, uint32_t tileSize);
+
+/**
+ * \brief Get tiles along the line (fromPos - toPos)
+ *
+ * \return Sorted vector of unique tiles
+ */
+[[nodiscard]] std::vector< Tile >
+GetTilesAlongTheLine(const glm::vec2& fromPos, const glm::vec2& toPos, const glm::ivec2& levelSize,
+                     uint32_t tileSize);
+
+/**
+ * \brief Get tiles covered by (possibly rotated) bounding box. Doesn't need the level,
+ * so it's used both at runtime (see \c Level::GetTilesFromBoundingBox) and when baking
+ * navigation data (see navigation_bake.hpp).
+ *
+ * \return Sorted vector of unique tiles
+ */
+[[nodiscard]] std::vector< Tile >
+GetTilesFromBoundingBox(const std::array< glm::vec2, 4 >& box, const glm::ivec2& levelSize,
+                        uint32_t tileSize);
+
 // Should be Tile probably
 struct Node : public Object
 {
@@ -111,6 +148,17 @@ class PathFinder
    [[nodiscard]] bool
    IsInitialized() const;
 
+   /**
+    * \brief Use baked region labels (see navigation_bake.hpp) to reject paths between
+    * disconnected regions without searching. Labels are only used as long as nodes' occupancy
+    * matches the baked one.
+    *
+    * \param[in] occupancy Baked occupancy for each node (indexed by NodeID)
+    * \param[in] regions Baked region label for each node (indexed by NodeID)
+    */
+   void
+   SetRegions(std::span< const uint8_t > occupancy, std::span< const uint32_t > regions);
+
    /**
     * \brief Get nodes (const version)
     *
@@ -179,6 +227,8 @@ class PathFinder
 
    /**
     * \brief Get path from \c source to \c destination. Uses A* algorithm.
+    * If baked regions are valid (see \c SetRegions), nodes in disconnected regions
+    * are rejected right away.
     *
     * \param[in] source Starting point on the map
     * \param[in] destination Destination on the map
@@ -232,10 +282,19 @@ class PathFinder
    GetNodesModifiedLastFrame() const;
 
  private:
+   // Keep track of how many nodes differ from the baked occupancy
+   void
+   NodeOccupancyChanged(const Node& node);
+
    bool initialized_ = false;
    std::vector< Node > nodes_ = {};
    std::unordered_set< Tile, TileHash > nodesModifiedLastFrame_ = {};
    Level* levelHandle_ = nullptr;
+
+   // Baked navigation data, valid only when 'numNodesChangedSinceBake_' is 0
+   std::vector< uint8_t > bakedOccupancy_ = {};
+   std::vector< uint32_t > regions_ = {};
+   size_t numNodesChangedSinceBake_ = 0;
 };
 
 } // namespace looper
\ No newline at end of file
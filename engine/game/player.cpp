@@ -9,7 +9,7 @@ Player::Player(Application* game, const glm::vec3& position, const glm::ivec2& s
                const std::string& sprite, const std::string& name)
    : GameObject(game, position, size, sprite, ObjectType::PLAYER)
 {
-   name_ = name;
+   name_ = utils::StringInterner::Intern(name);
    currentState_.velocity_ = {0.0f, 0.0f};
    currentState_.speed_ = 0.05f;
 
@@ -34,7 +34,7 @@ Player::Setup(Application* game, const glm::vec2& position, const glm::ivec2& si
 {
    GameObject::Setup(game, position, size, sprite, ObjectType::PLAYER, 1);
 
-   name_ = name;
+   name_ = utils::StringInterner::Intern(name);
    currentState_.velocity_ = {0.0f, 0.0f};
    currentState_.speed_ = 0.05f;
 
@@ -69,42 +69,34 @@ Buffer::CopyData(const void* data) const
 void
 Buffer::CopyDataWithStaging(const void* data, const size_t dataSize) const
 {
-   auto stagingBuffer = Buffer::CreateBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                                                | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+   // Copy is recorded in the current upload batch (see Command::SubmitUploads)
+   const auto staging = Command::AllocateStaging(dataSize);
+   memcpy(staging.data, data, dataSize);
 
-   void* mapped_data = {};
-   vmaMapMemory(Data::vk_hAllocator, allocation_, &mapped_data);
-   memcpy(mapped_data, data, dataSize);
-   vmaUnmapMemory(Data::vk_hAllocator, allocation_);
-
-   Buffer::CopyBuffer(stagingBuffer.buffer_, buffer_, dataSize);
-   stagingBuffer.Destroy();
+   VkBufferCopy copyRegion = {};
+   copyRegion.srcOffset = staging.offset;
+   copyRegion.size = dataSize;
+   vkCmdCopyBuffer(Command::GetUploadCommandBuffer(), staging.buffer, buffer_, 1, &copyRegion);
 }
 
 void
 Buffer::CopyDataToImageWithStaging(VkImage image, const void* data, const size_t dataSize,
                                    const std::vector< VkBufferImageCopy >& copyRegions)
 {
-   auto stagingBuffer = Buffer::CreateBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                                                | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-   void* mapped_data = {};
-   vmaMapMemory(Data::vk_hAllocator, stagingBuffer.allocation_, &mapped_data);
+   // Copy is recorded in the current upload batch (see Command::SubmitUploads)
+   const auto staging = Command::AllocateStaging(dataSize);
    // NOLINTNEXTLINE
-   memcpy(mapped_data, data, dataSize);
-   vmaUnmapMemory(Data::vk_hAllocator, stagingBuffer.allocation_);
+   memcpy(staging.data, data, dataSize);
 
-   auto* commandBuffer = Command::BeginSingleTimeCommands();
+   auto regions = copyRegions;
+   for (auto& region : regions)
+   {
+      region.bufferOffset += staging.offset;
+   }
 
-   vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.buffer_, image,
+   vkCmdCopyBufferToImage(Command::GetUploadCommandBuffer(), staging.buffer, image,
                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          static_cast< uint32_t >(copyRegions.size()), copyRegions.data());
-
-   Command::EndSingleTimeCommands(commandBuffer);
-
-   stagingBuffer.Destroy();
+                          static_cast< uint32_t >(regions.size()), regions.data());
 }
 
 void
@@ -186,13 +178,9 @@ Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryProper
 void
 Buffer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
-   auto* commandBuffer = Command::BeginSingleTimeCommands();
-
    VkBufferCopy copyRegion = {};
    copyRegion.size = size;
-   vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-   Command::EndSingleTimeCommands(commandBuffer);
+   vkCmdCopyBuffer(Command::GetUploadCommandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
 }
 
 void
@@ -226,6 +214,7 @@ Buffer::Destroy()
    vmaDestroyBuffer(Data::vk_hAllocator, buffer_, allocation_);
    buffer_ = VK_NULL_HANDLE;
    bufferMemory_ = VK_NULL_HANDLE;
+   ++Data::resourceGeneration;
 }
 
 } // namespace looper::renderer
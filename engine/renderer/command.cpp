@@ -1,10 +1,47 @@
 #include "command.hpp"
+#include "buffer.hpp"
 #include "vulkan_common.hpp"
 
+#include <array>
+#include <vector>
+
 namespace looper::renderer {
 
-VkCommandBuffer
-Command::BeginSingleTimeCommands()
+namespace {
+struct UploadBatch
+{
+   VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+   VkFence fence = VK_NULL_HANDLE;
+   bool recording = false;
+
+   Buffer staging = {};
+   VkDeviceSize stagingUsed = 0;
+
+   // Uploads that don't fit in the staging buffer get their own (freed when the batch is reused)
+   std::vector< Buffer > dedicatedStaging = {};
+};
+
+constexpr uint32_t NUM_UPLOAD_BATCHES = 3;
+constexpr VkDeviceSize STAGING_BUFFER_SIZE = VkDeviceSize{32} * 1024 * 1024;
+// Satisfies bufferOffset alignment of every format we copy to images
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+std::array< UploadBatch, NUM_UPLOAD_BATCHES > batches_ = {};
+uint32_t currentBatch_ = 0;
+
+Buffer
+CreateStagingBuffer(VkDeviceSize size)
+{
+   auto staging = Buffer::CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                          | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+   staging.Map();
+
+   return staging;
+}
+
+void
+CreateBatchResources(UploadBatch& batch)
 {
    VkCommandBufferAllocateInfo allocInfo = {};
    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -12,32 +49,137 @@ Command::BeginSingleTimeCommands()
    allocInfo.commandPool = Data::commandPool;
    allocInfo.commandBufferCount = 1;
 
-   VkCommandBuffer commandBuffer = {};
-   vkAllocateCommandBuffers(Data::vk_device, &allocInfo, &commandBuffer);
+   vk_check_error(vkAllocateCommandBuffers(Data::vk_device, &allocInfo, &batch.commandBuffer),
+                  "Failed to allocate upload command buffer!");
+
+   // Signaled, so the first use doesn't wait
+   VkFenceCreateInfo fenceInfo = {};
+   fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+   fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+   vk_check_error(vkCreateFence(Data::vk_device, &fenceInfo, nullptr, &batch.fence),
+                  "Failed to create upload fence!");
+
+   batch.staging = CreateStagingBuffer(STAGING_BUFFER_SIZE);
+}
+
+UploadBatch&
+GetRecordingBatch()
+{
+   auto& batch = batches_.at(currentBatch_);
+   if (batch.recording)
+   {
+      return batch;
+   }
+
+   if (batch.commandBuffer == VK_NULL_HANDLE)
+   {
+      CreateBatchResources(batch);
+   }
+
+   // Batch's previous uploads have to finish before its command buffer and staging are reused
+   vkWaitForFences(Data::vk_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+   vkResetFences(Data::vk_device, 1, &batch.fence);
+
+   for (auto& staging : batch.dedicatedStaging)
+   {
+      staging.Destroy();
+   }
+   batch.dedicatedStaging.clear();
+   batch.stagingUsed = 0;
 
    VkCommandBufferBeginInfo beginInfo = {};
    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-   vkBeginCommandBuffer(commandBuffer, &beginInfo);
+   vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+   batch.recording = true;
+
+   return batch;
+}
+} // namespace
 
-   return commandBuffer;
+VkCommandBuffer
+Command::GetUploadCommandBuffer()
+{
+   return GetRecordingBatch().commandBuffer;
+}
+
+Command::StagingAllocation
+Command::AllocateStaging(VkDeviceSize size)
+{
+   auto* batch = &GetRecordingBatch();
+
+   if (size > STAGING_BUFFER_SIZE)
+   {
+      auto& staging = batch->dedicatedStaging.emplace_back(CreateStagingBuffer(size));
+      return {staging.buffer_, 0, staging.mappedMemory_};
+   }
+
+   const auto offset = (batch->stagingUsed + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+   if (offset + size > STAGING_BUFFER_SIZE)
+   {
+      // Staging is full, hand this batch over to the GPU and continue with the next one
+      SubmitUploads();
+      return AllocateStaging(size);
+   }
+
+   batch->stagingUsed = offset + size;
+
+   return {batch->staging.buffer_, offset,
+           static_cast< uint8_t* >(batch->staging.mappedMemory_) + offset};
 }
 
 void
-Command::EndSingleTimeCommands(VkCommandBuffer commandBuffer)
+Command::SubmitUploads()
 {
-   vkEndCommandBuffer(commandBuffer);
+   auto& batch = batches_.at(currentBatch_);
+   if (not batch.recording)
+   {
+      return;
+   }
+
+   // Submission order alone doesn't make transfer writes visible, so make them available to
+   // the vertex input and shaders of frames that are submitted after this batch
+   VkMemoryBarrier barrier = {};
+   barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+   barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+   barrier.dstAccessMask =
+      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+   vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                           | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+   vkEndCommandBuffer(batch.commandBuffer);
 
    VkSubmitInfo submitInfo = {};
    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
    submitInfo.commandBufferCount = 1;
-   submitInfo.pCommandBuffers = &commandBuffer;
+   submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+   vk_check_error(vkQueueSubmit(Data::vk_graphicsQueue, 1, &submitInfo, batch.fence),
+                  "Failed to submit uploads!");
 
-   vkQueueSubmit(Data::vk_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-   vkQueueWaitIdle(Data::vk_graphicsQueue);
+   batch.recording = false;
+   currentBatch_ = (currentBatch_ + 1) % NUM_UPLOAD_BATCHES;
+
+   ++Data::renderStats.numUploadBatches;
+}
+
+void
+Command::WaitForUploads()
+{
+   SubmitUploads();
 
-   vkFreeCommandBuffers(Data::vk_device, Data::commandPool, 1, &commandBuffer);
+   for (auto& batch : batches_)
+   {
+      if (batch.fence != VK_NULL_HANDLE)
+      {
+         vkWaitForFences(Data::vk_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+      }
+   }
 }
 
 } // namespace shady::renderer
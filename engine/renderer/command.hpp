@@ -4,14 +4,58 @@
 
 namespace looper::renderer {
 
+/**
+ * \brief Records GPU uploads (buffer/image copies and layout transitions) in batches.
+ * Everything recorded between two \c SubmitUploads calls goes into a single command buffer,
+ * which is submitted once with a single fence. Staging memory comes from a ring of per batch
+ * staging buffers, which are reused once their batch's fence is signaled.
+ *
+ * Only meant to be used from the main thread.
+ */
 class Command
 {
  public:
+   struct StagingAllocation
+   {
+      VkBuffer buffer = VK_NULL_HANDLE;
+      VkDeviceSize offset = 0;
+      void* data = nullptr;
+   };
+
+   /**
+    * \brief Get command buffer of the current upload batch (batch is started if needed)
+    *
+    * \return Command buffer that's in recording state
+    */
    static VkCommandBuffer
-   BeginSingleTimeCommands();
+   GetUploadCommandBuffer();
+
+   /**
+    * \brief Get mapped staging memory, valid until the current batch is finished on the GPU.
+    * If the batch's staging buffer is full, the batch is submitted and a new one is started,
+    * so call this before \c GetUploadCommandBuffer.
+    *
+    * \param[in] size Number of bytes needed
+    *
+    * \return Staging buffer, offset in it and pointer to the mapped memory at that offset
+    */
+   static StagingAllocation
+   AllocateStaging(VkDeviceSize size);
+
+   /**
+    * \brief Submit recorded uploads (if any). Doesn't wait for them. Batch ends with a memory
+    * barrier, which makes the copies visible to vertex input and shader reads of frames
+    * submitted later to the same queue.
+    */
+   static void
+   SubmitUploads();
 
+   /**
+    * \brief Submit recorded uploads and wait for every batch to finish. Call this before
+    * destroying resources that could still be used by an upload.
+    */
    static void
-   EndSingleTimeCommands(VkCommandBuffer commandBuffer);
+   WaitForUploads();
 };
 
 } // namespace shady::renderer
@@ -213,6 +213,49 @@ CheckDeviceExtensionSupport(VkPhysicalDevice device)
    return requiredExtensions.empty();
 }
 
+inline bool
+CheckBindlessTexturesSupport(VkPhysicalDevice device)
+{
+   VkPhysicalDeviceVulkan12Features features_12 = {};
+   features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+   VkPhysicalDeviceFeatures2 features = {};
+   features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+   features.pNext = &features_12;
+   vkGetPhysicalDeviceFeatures2(device, &features);
+
+   // Features enabled in CreateDevice for the texture array (see QuadShader)
+   const auto featuresSupported =
+      features_12.descriptorIndexing && features_12.runtimeDescriptorArray
+      && features_12.shaderSampledImageArrayNonUniformIndexing
+      && features_12.descriptorBindingPartiallyBound
+      && features_12.descriptorBindingSampledImageUpdateAfterBind
+      && features_12.descriptorBindingUpdateUnusedWhilePending;
+
+   VkPhysicalDeviceVulkan12Properties properties_12 = {};
+   properties_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+   VkPhysicalDeviceProperties2 properties = {};
+   properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+   properties.pNext = &properties_12;
+   vkGetPhysicalDeviceProperties2(device, &properties);
+
+   // Combined image samplers count towards both sampled image and sampler limits
+   const auto limitsSupported =
+      properties_12.maxDescriptorSetUpdateAfterBindSampledImages >= MAX_NUM_TEXTURES
+      && properties_12.maxDescriptorSetUpdateAfterBindSamplers >= MAX_NUM_TEXTURES
+      && properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages >= MAX_NUM_TEXTURES
+      && properties_12.maxPerStageDescriptorUpdateAfterBindSamplers >= MAX_NUM_TEXTURES;
+
+   if (!featuresSupported || !limitsSupported)
+   {
+      Logger::Warn("Device {} doesn't support {} bindless textures",
+                   &properties.properties.deviceName[0], MAX_NUM_TEXTURES);
+   }
+
+   return featuresSupported && limitsSupported;
+}
+
 inline bool
 IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
 {
@@ -238,7 +281,7 @@ IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
 
    return extensionsSupported && swapChainAdequate && isDiscrete
           && supportedFeatures.samplerAnisotropy && supportedFeatures.multiDrawIndirect
-          && supportedFeatures.wideLines;
+          && supportedFeatures.wideLines && CheckBindlessTexturesSupport(device);
 }
 
 inline VkSampleCountFlagBits
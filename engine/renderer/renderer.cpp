@@ -9,6 +9,7 @@
 #include "texture.hpp"
 #include "utils/assert.hpp"
 #include "utils/file_manager.hpp"
+#include "utils/hash.hpp"
 #include "vulkan_common.hpp"
 
 
@@ -16,21 +17,26 @@
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <optional>
+#include <type_traits>
+#include <unordered_map>
 
 namespace looper::renderer {
 
 namespace {
 bool initialized_ = false;
-bool updateDescriptors_ = false;
 
-bool updateVertexBuffer_ = false;
-std::vector< uint32_t > updatedObjects_ = {};
-std::vector< int32_t > renderLayersChanged_ = {};
-bool updatePerInstanceBuffer_ = false;
+// Frames in flight are tracked with bits of RenderData::instanceDirtyFrames
+static_assert(MAX_FRAMES_IN_FLIGHT <= 8);
 
 VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo_ = {};
 
@@ -43,6 +49,397 @@ ApplicationType boundApplication_ = {};
 
 std::vector< VkFence > inFlightFences_ = {};
 
+// Secondary command buffer of a draw pass, for one frame in flight. Every one has its own
+// command pool, so passes can be recorded on any worker without locking.
+struct RecordedPass
+{
+   VkCommandPool commandPool = VK_NULL_HANDLE;
+   VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+   // Key that the command buffer was recorded with
+   uint64_t key = DrawPass::ALWAYS_RECORD;
+};
+
+// Indexed by DrawPass::id. Kept per application, as pools are created for its queue family.
+std::unordered_map< ApplicationType,
+                    std::array< std::vector< RecordedPass >, MAX_FRAMES_IN_FLIGHT > >
+   recordedPasses_ = {};
+std::vector< DrawPass > drawPasses_ = {};
+std::vector< uint32_t > passesToRecord_ = {};
+std::vector< VkCommandBuffer > passCommandBuffers_ = {};
+
+constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x4C505044; // "DPPL"
+
+// Every shader that pipelines are created from
+constexpr std::array< std::string_view, 6 > PIPELINE_CACHE_SHADERS = {
+   "vert.spv", "frag.spv", "line.vert.spv", "line.frag.spv", "ui.vert.spv", "ui.frag.spv"};
+
+/*
+ * Pipeline cache file is [PipelineCacheHeader][Vulkan's pipeline cache data]. Cache data is only
+ * valid for the driver that created it, and the shaders that it was created from.
+ */
+struct PipelineCacheHeader
+{
+   uint32_t magic = PIPELINE_CACHE_MAGIC;
+   uint32_t vendorID = 0;
+   uint32_t deviceID = 0;
+   uint32_t driverVersion = 0;
+   std::array< uint8_t, VK_UUID_SIZE > pipelineCacheUUID = {};
+   uint64_t shadersHash = utils::FNV_OFFSET_BASIS;
+   uint64_t dataSize = 0;
+};
+
+// Headers are compared with memcmp
+static_assert(std::has_unique_object_representations_v< PipelineCacheHeader >);
+
+PipelineCacheHeader pipelineCacheHeader_ = {};
+size_t savedPipelineCacheSize_ = 0;
+
+void
+RecordUpload(size_t numBytes)
+{
+   ++Data::renderStats.numBufferUploads;
+   Data::renderStats.bytesUploaded += numBytes;
+}
+
+void
+MarkInstanceDirty(RenderData& renderData, uint32_t idx)
+{
+   auto& dirtyFrames = renderData.instanceDirtyFrames.at(idx);
+   for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
+   {
+      const auto frameBit = static_cast< uint8_t >(1U << frame);
+      if (!(dirtyFrames & frameBit))
+      {
+         dirtyFrames |= frameBit;
+         renderData.dirtyInstances.at(frame).push_back(idx);
+      }
+   }
+}
+
+// CPU side storage, shared by the Vulkan and headless renderer
+void
+AllocateRenderData(RenderData& renderData)
+{
+   renderData.perInstance.resize(MAX_NUM_SPRITES);
+   renderData.idxToHandle.resize(MAX_NUM_SPRITES, RenderInfo::INVALID_HANDLE);
+   renderData.instanceDirtyFrames.resize(MAX_NUM_SPRITES);
+
+   auto& bounds = renderData.instanceBounds;
+   bounds.minX.resize(MAX_NUM_SPRITES);
+   bounds.minY.resize(MAX_NUM_SPRITES);
+   bounds.maxX.resize(MAX_NUM_SPRITES);
+   bounds.maxY.resize(MAX_NUM_SPRITES);
+   renderData.visibleInstances.resize(MAX_NUM_SPRITES);
+}
+
+void
+SetInstanceBounds(InstanceBounds& bounds, uint32_t idx, const PerInstanceBuffer& instance)
+{
+   // AABB of the rotated quad
+   const auto absSin = std::abs(instance.rotation.x);
+   const auto absCos = std::abs(instance.rotation.y);
+   const auto extent = glm::vec2{absCos * instance.halfSize.x + absSin * instance.halfSize.y,
+                                 absSin * instance.halfSize.x + absCos * instance.halfSize.y};
+
+   bounds.minX.at(idx) = instance.position.x - extent.x;
+   bounds.minY.at(idx) = instance.position.y - extent.y;
+   bounds.maxX.at(idx) = instance.position.x + extent.x;
+   bounds.maxY.at(idx) = instance.position.y + extent.y;
+}
+
+void
+MoveInstanceBounds(InstanceBounds& bounds, uint32_t from, uint32_t to)
+{
+   bounds.minX.at(to) = bounds.minX.at(from);
+   bounds.minY.at(to) = bounds.minY.at(from);
+   bounds.maxX.at(to) = bounds.maxX.at(from);
+   bounds.maxY.at(to) = bounds.maxY.at(from);
+}
+
+/*
+ * Fill RenderData::visibleInstances with sprites that overlap the camera's view rectangle
+ * and upload them (with the indirect draw commands) to the current frame's buffers
+ */
+void
+CullInstances()
+{
+   auto& renderData = Data::renderData_.at(boundApplication_);
+   const auto& bounds = renderData.instanceBounds;
+
+   // World space AABB of the view (camera can be rotated)
+   auto viewMin = glm::vec2{std::numeric_limits< float >::lowest()};
+   auto viewMax = glm::vec2{std::numeric_limits< float >::max()};
+
+   const auto viewProj = renderData.projMat * renderData.viewMat;
+   if (glm::determinant(viewProj) != 0.0f)
+   {
+      const auto inverseViewProj = glm::inverse(viewProj);
+      std::swap(viewMin, viewMax);
+
+      for (const auto corner : std::to_array< glm::vec2 >({{-1.0f, -1.0f}, {1.0f, -1.0f},
+                                                            {1.0f, 1.0f}, {-1.0f, 1.0f}}))
+      {
+         const auto worldPos = inverseViewProj * glm::vec4{corner, 0.0f, 1.0f};
+         const auto position = glm::vec2{worldPos} / worldPos.w;
+
+         viewMin = glm::min(viewMin, position);
+         viewMax = glm::max(viewMax, position);
+      }
+   }
+
+   uint32_t totalVisible = 0;
+   for (uint32_t layer = 0; layer < NUM_LAYERS; ++layer)
+   {
+      const auto first = layer * MAX_SPRITES_PER_LAYER;
+      const auto last = first + renderData.numMeshes.at(layer);
+      auto* visible = renderData.visibleInstances.data() + first;
+
+      // Branchless, every index is written and only the visible ones are kept
+      uint32_t numVisible = 0;
+      for (uint32_t idx = first; idx < last; ++idx)
+      {
+         visible[numVisible] = idx;
+         numVisible += static_cast< uint32_t >(
+            (bounds.minX[idx] <= viewMax.x) + (bounds.maxX[idx] >= viewMin.x)
+               + (bounds.minY[idx] <= viewMax.y) + (bounds.maxY[idx] >= viewMin.y)
+            == 4);
+      }
+
+      renderData.numVisible.at(layer) = numVisible;
+      totalVisible += numVisible;
+
+      // Textures sampled by this frame stay resident (see TextureLibrary::UpdateResidency)
+      for (uint32_t i = 0; i < numVisible; ++i)
+      {
+         const auto textures = renderData.perInstance[visible[i]].textures;
+         TextureLibrary::MarkUsed(static_cast< TextureID >(textures & 0xFFFFU));
+         TextureLibrary::MarkUsed(static_cast< TextureID >(textures >> 16U));
+      }
+   }
+
+   Data::renderStats.numInstancesVisible += totalVisible;
+   Data::renderStats.numInstancesCulled += renderData.totalNumMeshes - totalVisible;
+
+   RecordUpload(totalVisible * sizeof(uint32_t));
+   if (Data::headless)
+   {
+      return;
+   }
+
+   // Previous submission of this frame is already waited for (see UpdateUniformBuffer)
+   const auto frame = Data::currentFrame_;
+   auto* visibleMemory =
+      static_cast< uint32_t* >(renderData.visibleInstancesBuffer.at(frame).mappedMemory_);
+   auto* commands = static_cast< VkDrawIndexedIndirectCommand* >(
+      renderData.indirectDrawBuffer.at(frame).mappedMemory_);
+
+   for (uint32_t layer = 0; layer < NUM_LAYERS; ++layer)
+   {
+      const auto first = layer * MAX_SPRITES_PER_LAYER;
+      const auto numVisible = renderData.numVisible.at(layer);
+
+      memcpy(visibleMemory + first, renderData.visibleInstances.data() + first,
+             numVisible * sizeof(uint32_t));
+
+      auto& command = commands[NUM_LAYERS - 1 - layer];
+      command.indexCount = INDICES_PER_SPRITE;
+      command.instanceCount = numVisible;
+      command.firstIndex = 0;
+      command.vertexOffset = static_cast< int32_t >(layer * VERTICES_PER_SPRITE);
+      command.firstInstance = first;
+   }
+}
+
+RecordedPass
+CreateRecordedPass()
+{
+   const auto queueFamilyIndices =
+      FindQueueFamilies(Data::vk_physicalDevice, Data::renderData_[boundApplication_].surface);
+
+   VkCommandPoolCreateInfo poolInfo = {};
+   poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+   poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
+
+   RecordedPass recordedPass = {};
+   vk_check_error(
+      vkCreateCommandPool(Data::vk_device, &poolInfo, nullptr, &recordedPass.commandPool),
+      "Failed to create command pool!");
+
+   VkCommandBufferAllocateInfo allocInfo = {};
+   allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+   allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+   allocInfo.commandPool = recordedPass.commandPool;
+   allocInfo.commandBufferCount = 1;
+
+   vk_check_error(
+      vkAllocateCommandBuffers(Data::vk_device, &allocInfo, &recordedPass.commandBuffer),
+      "failed to allocate command buffers!");
+
+   return recordedPass;
+}
+
+void
+DestroyRecordedPasses(ApplicationType type)
+{
+   const auto passes = recordedPasses_.find(type);
+   if (passes == recordedPasses_.end())
+   {
+      return;
+   }
+
+   for (const auto& framePasses : passes->second)
+   {
+      for (const auto& recordedPass : framePasses)
+      {
+         // Frees pass's command buffer as well
+         vkDestroyCommandPool(Data::vk_device, recordedPass.commandPool, nullptr);
+      }
+   }
+
+   recordedPasses_.erase(passes);
+}
+
+// Called on ThreadPool workers, only touches the pass's own command pool
+void
+RecordPass(RecordedPass& recordedPass, const DrawPass& drawPass, const RenderData& renderData)
+{
+   vk_check_error(vkResetCommandPool(Data::vk_device, recordedPass.commandPool, 0),
+                  "Failed to reset command pool!");
+
+   // Framebuffer isn't specified, so the command buffer can be used with any swapchain image
+   VkCommandBufferInheritanceInfo inheritanceInfo = {};
+   inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+   inheritanceInfo.renderPass = renderData.renderPass;
+   inheritanceInfo.subpass = 0;
+   inheritanceInfo.framebuffer = VK_NULL_HANDLE;
+
+   VkCommandBufferBeginInfo beginInfo = {};
+   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+   beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+   beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+   const auto commandBuffer = recordedPass.commandBuffer;
+   vk_check_error(vkBeginCommandBuffer(commandBuffer, &beginInfo), "");
+
+   // Dynamic state isn't inherited from the primary command buffer
+   vkCmdSetLineWidth(commandBuffer, 2.0f);
+
+   VkViewport viewport = {};
+   viewport.width = static_cast< float >(renderData.swapChainExtent.width);
+   viewport.height = static_cast< float >(renderData.swapChainExtent.height);
+   viewport.minDepth = 0.0f;
+   viewport.maxDepth = 1.0f;
+
+   vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+   VkRect2D scissor = {};
+   scissor.extent = renderData.swapChainExtent;
+   scissor.offset = {0, 0};
+
+   vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+   drawPass.record(commandBuffer);
+
+   vk_check_error(vkEndCommandBuffer(commandBuffer), "");
+}
+
+PipelineCacheHeader
+GetPipelineCacheHeader()
+{
+   VkPhysicalDeviceProperties deviceProps = {};
+   vkGetPhysicalDeviceProperties(Data::vk_physicalDevice, &deviceProps);
+
+   PipelineCacheHeader header = {};
+   header.vendorID = deviceProps.vendorID;
+   header.deviceID = deviceProps.deviceID;
+   header.driverVersion = deviceProps.driverVersion;
+   std::copy_n(std::begin(deviceProps.pipelineCacheUUID), VK_UUID_SIZE,
+               header.pipelineCacheUUID.begin());
+
+   for (const auto shader : PIPELINE_CACHE_SHADERS)
+   {
+      const auto shaderFile = FileManager::MapFile(SHADERS_DIR / shader);
+      header.shadersHash = utils::HashBytes(shaderFile.GetData(), header.shadersHash);
+   }
+
+   return header;
+}
+
+/*
+ * Write the pipeline cache to disk, if any new pipelines were compiled since it was last saved.
+ * Cache data only grows, so comparing its size is enough.
+ */
+void
+SavePipelineCache()
+{
+   size_t dataSize = 0;
+   vkGetPipelineCacheData(Data::vk_device, Data::vk_pipelineCache, &dataSize, nullptr);
+   if (dataSize == savedPipelineCacheSize_)
+   {
+      return;
+   }
+
+   std::vector< std::byte > buffer(sizeof(PipelineCacheHeader) + dataSize);
+   vk_check_error(vkGetPipelineCacheData(Data::vk_device, Data::vk_pipelineCache, &dataSize,
+                                         buffer.data() + sizeof(PipelineCacheHeader)),
+                  "failed to read pipeline cache data!");
+
+   auto header = pipelineCacheHeader_;
+   header.dataSize = dataSize;
+   std::memcpy(buffer.data(), &header, sizeof(PipelineCacheHeader));
+
+   std::error_code errorCode;
+   std::filesystem::create_directories(PIPELINE_CACHE_PATH.parent_path(), errorCode);
+   if (FileManager::SaveBinaryFileAtomic(PIPELINE_CACHE_PATH.string(), buffer))
+   {
+      savedPipelineCacheSize_ = dataSize;
+   }
+}
+
+RenderInfo
+RegisterMesh(RenderData& renderData, uint32_t layer_in, const TextureIDs& textures_in,
+             const glm::vec4& uvRect, const SpriteTransform& transform, const glm::vec4& color)
+{
+   utils::Assert(layer_in < NUM_LAYERS,
+                 fmt::format("RegisterMesh: Invalid render layer {}!", layer_in));
+
+   const auto layer = static_cast< int32_t >(layer_in);
+   auto& numObjects = renderData.numMeshes.at(static_cast< size_t >(layer));
+
+   utils::Assert(numObjects < MAX_SPRITES_PER_LAYER,
+                 fmt::format("RegisterMesh: Render layer {} is full! ({} sprites)", layer,
+                             MAX_SPRITES_PER_LAYER));
+
+   // Layer is packed, so the first free slot is right after its last sprite.
+   // Sprites are instances of the layer's unit quad, drawn with firstInstance at the layer's
+   // first slot, so the instance index is the same as the index in perInstance
+   const auto layerIdx = static_cast< int32_t >(numObjects++);
+   const auto idx = layerIdx + static_cast< int32_t >(MAX_SPRITES_PER_LAYER) * layer;
+
+   uint32_t handle = {};
+   if (renderData.freeHandles.empty())
+   {
+      handle = static_cast< uint32_t >(renderData.handleToIdx.size());
+      renderData.handleToIdx.push_back(idx);
+      renderData.handleGenerations.push_back(0);
+   }
+   else
+   {
+      const auto slot = renderData.freeHandles.back();
+      renderData.freeHandles.pop_back();
+      renderData.handleToIdx.at(slot) = idx;
+      handle = slot | (renderData.handleGenerations.at(slot) << RenderInfo::HANDLE_SLOT_BITS);
+   }
+
+   renderData.idxToHandle.at(static_cast< size_t >(idx)) = handle;
+
+   ++renderData.totalNumMeshes;
+
+   SubmitMeshData(static_cast< uint32_t >(idx), textures_in, uvRect, transform, color);
+
+   return {idx, layer, layerIdx, handle};
+}
+
 } // namespace
 
 template < typename ShaderType, typename VertexType >
@@ -207,13 +604,15 @@ CreatePipeline(std::string_view vertexShader, std::string_view fragmentShader, P
    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
 
-   vk_check_error(vkCreateGraphicsPipelines(Data::vk_device, VK_NULL_HANDLE, 1, &pipelineInfo,
-                                            nullptr, &pipeline),
+   vk_check_error(vkCreateGraphicsPipelines(Data::vk_device, Data::vk_pipelineCache, 1,
+                                            &pipelineInfo, nullptr, &pipeline),
                   "failed to create graphics pipeline!");
 
    // Shader info can be destroyed after the pipeline is created
    vertexInfo.Destroy();
    fragmentInfo.Destroy();
+
+   SavePipelineCache();
 }
 
 template < typename DataT >
@@ -225,22 +624,11 @@ CreateVertexBuffer(size_t bufferSize, const std::vector< DataT >& vertices)
       return {};
    }
 
-   auto stagingBuffer = Buffer::CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                                                | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-   void* data = nullptr;
-   vmaMapMemory(Data::vk_hAllocator, stagingBuffer.allocation_, &data);
-   memcpy(data, vertices.data(), bufferSize);
-   vmaUnmapMemory(Data::vk_hAllocator, stagingBuffer.allocation_);
-
    auto vertexBuffer = Buffer::CreateBuffer(
       bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-   Buffer::CopyBuffer(stagingBuffer.buffer_, vertexBuffer.buffer_, bufferSize);
-
-   stagingBuffer.Destroy();
+   vertexBuffer.CopyDataWithStaging(vertices.data(), bufferSize);
 
    return vertexBuffer;
 }
@@ -282,22 +670,11 @@ CreateIndexBuffer(std::vector< IndexType >& indices, const size_t numObjects)
 
    const VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-   auto stagingBuffer = Buffer::CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                                                | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-   void* data = nullptr;
-   vmaMapMemory(Data::vk_hAllocator, stagingBuffer.allocation_, &data);
-   memcpy(data, indices.data(), bufferSize);
-   vmaUnmapMemory(Data::vk_hAllocator, stagingBuffer.allocation_);
-
    auto indexBuffer = Buffer::CreateBuffer(
       bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-   Buffer::CopyBuffer(stagingBuffer.buffer_, indexBuffer.buffer_, bufferSize);
-
-   stagingBuffer.Destroy();
+   indexBuffer.CopyDataWithStaging(indices.data(), bufferSize);
 
    return indexBuffer;
 }
@@ -389,6 +766,13 @@ CreateDevice()
    deviceFeatures_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
    deviceFeatures_12.pNext = &deviceFeatures_13;
    deviceFeatures_12.drawIndirectCount = VK_TRUE;
+   // Texture array is indexed per sprite and only partially written (see QuadShader)
+   deviceFeatures_12.descriptorIndexing = VK_TRUE;
+   deviceFeatures_12.runtimeDescriptorArray = VK_TRUE;
+   deviceFeatures_12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+   deviceFeatures_12.descriptorBindingPartiallyBound = VK_TRUE;
+   deviceFeatures_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+   deviceFeatures_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
 
    VkPhysicalDeviceVulkan11Features deviceFeatures_11 = {};
    deviceFeatures_11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
@@ -678,6 +1062,49 @@ CreateCommandBuffers(Application* app, uint32_t imageIndex)
          "failed to allocate command buffers!");
    }
 
+   drawPasses_.clear();
+   app->Render(drawPasses_);
+
+   // State that every pass depends on
+   auto frameKey = utils::HashValue(renderData.renderPass);
+   frameKey = utils::HashValue(renderData.swapChainExtent, frameKey);
+   frameKey = utils::HashValue(Data::resourceGeneration, frameKey);
+
+   // Frame's previous submission is finished (see Render), so its passes can be recorded again
+   auto& recordedPasses = recordedPasses_[boundApplication_].at(Data::currentFrame_);
+   passesToRecord_.clear();
+   passCommandBuffers_.clear();
+
+   for (uint32_t idx = 0; idx < drawPasses_.size(); ++idx)
+   {
+      const auto& drawPass = drawPasses_[idx];
+      while (drawPass.id >= recordedPasses.size())
+      {
+         recordedPasses.push_back(CreateRecordedPass());
+      }
+
+      auto& recordedPass = recordedPasses[drawPass.id];
+      const auto key = drawPass.key == DrawPass::ALWAYS_RECORD
+                          ? DrawPass::ALWAYS_RECORD
+                          : utils::HashValue(drawPass.key, frameKey);
+      if (key == DrawPass::ALWAYS_RECORD or key != recordedPass.key)
+      {
+         recordedPass.key = key;
+         passesToRecord_.push_back(idx);
+      }
+
+      passCommandBuffers_.push_back(recordedPass.commandBuffer);
+   }
+
+   app->GetThreadPool().ParallelForEach(
+      passesToRecord_.size(), [&recordedPasses, &renderData](size_t idx) {
+         const auto& drawPass = drawPasses_[passesToRecord_[idx]];
+         RecordPass(recordedPasses[drawPass.id], drawPass, renderData);
+      });
+
+   Data::renderStats.numPassesRecorded += passesToRecord_.size();
+   Data::renderStats.numPassesReused += drawPasses_.size() - passesToRecord_.size();
+
    VkCommandBufferBeginInfo beginInfo = {};
    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -695,32 +1122,21 @@ CreateCommandBuffers(Application* app, uint32_t imageIndex)
 
    renderPassInfo.framebuffer = renderData.swapChainFramebuffers[imageIndex];
 
-   vk_check_error(vkBeginCommandBuffer(Data::commandBuffers[Data::currentFrame_], &beginInfo), "");
-
-   vkCmdSetLineWidth(Data::commandBuffers[Data::currentFrame_], 2.0f);
-   vkCmdBeginRenderPass(Data::commandBuffers[Data::currentFrame_], &renderPassInfo,
-                        VK_SUBPASS_CONTENTS_INLINE);
-
-   VkViewport viewport = {};
-   viewport.width = static_cast< float >(renderData.swapChainExtent.width);
-   viewport.height = static_cast< float >(renderData.swapChainExtent.height);
-   viewport.minDepth = 0.0f;
-   viewport.maxDepth = 1.0f;
-
-   vkCmdSetViewport(Data::commandBuffers[Data::currentFrame_], 0, 1, &viewport);
-
-   VkRect2D scissor = {};
-   scissor.extent.width = renderData.swapChainExtent.width;
-   scissor.extent.height = renderData.swapChainExtent.height;
-   scissor.offset.x = 0;
-   scissor.offset.y = 0;
+   const auto commandBuffer = Data::commandBuffers[Data::currentFrame_];
+   vk_check_error(vkBeginCommandBuffer(commandBuffer, &beginInfo), "");
 
-   vkCmdSetScissor(Data::commandBuffers[Data::currentFrame_], 0, 1, &scissor);
+   // Everything within the render pass comes from the passes' secondary command buffers
+   vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                        VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-   app->Render(Data::commandBuffers[Data::currentFrame_]);
+   if (not passCommandBuffers_.empty())
+   {
+      vkCmdExecuteCommands(commandBuffer, static_cast< uint32_t >(passCommandBuffers_.size()),
+                           passCommandBuffers_.data());
+   }
 
-   vkCmdEndRenderPass(Data::commandBuffers[Data::currentFrame_]);
-   vk_check_error(vkEndCommandBuffer(Data::commandBuffers[Data::currentFrame_]), "");
+   vkCmdEndRenderPass(commandBuffer);
+   vk_check_error(vkEndCommandBuffer(commandBuffer), "");
 }
 
 
@@ -728,39 +1144,38 @@ void
 CreateQuadIndexBuffer()
 {
    auto& renderData = Data::renderData_.at(boundApplication_);
-
-   for (size_t layer = 0; layer < static_cast< size_t >(NUM_LAYERS); ++layer)
+   auto& indexBuffer = renderData.quadIndexBuffer;
+   if (indexBuffer.buffer_ != VK_NULL_HANDLE)
    {
-      auto& indexBuffer = renderData.indexBuffer.at(layer);
-      if (indexBuffer.buffer_ != VK_NULL_HANDLE)
-      {
-         indexBuffer.Destroy();
-      }
-
-      indexBuffer = CreateIndexBuffer< INDICES_PER_SPRITE >(renderData.indices.at(layer),
-                                                            MAX_SPRITES_PER_LAYER);
+      indexBuffer.Destroy();
    }
+
+   std::vector< IndexType > indices = {};
+   indexBuffer = CreateIndexBuffer< INDICES_PER_SPRITE >(indices, 1);
 }
 
 void
 CreateQuadVertexBuffer()
 {
    auto& renderData = Data::renderData_.at(boundApplication_);
-   auto& vertices = renderData.vertices;
-
-   for (size_t layer = 0; layer < static_cast< size_t >(NUM_LAYERS); layer++)
+   auto& vertexBuffer = renderData.quadVertexBuffer;
+   if (vertexBuffer.buffer_ != VK_NULL_HANDLE)
    {
-      auto& vertexBuffer = renderData.vertexBuffer.at(layer);
-      if (vertexBuffer.buffer_ != VK_NULL_HANDLE)
-      {
-         vertexBuffer.Destroy();
-      }
+      vertexBuffer.Destroy();
+   }
 
-      vertices.at(layer).resize(MAX_NUM_VERTICES_PER_LAYER);
-      // const auto bufferSize = sizeof(Vertex) * vertices.at(layer).size();
-      const auto bufferSize = sizeof(Vertex) * MAX_NUM_VERTICES_PER_LAYER;
-      vertexBuffer = CreateVertexBuffer(bufferSize, vertices.at(layer));
+   // Same quad as the one in Sprite::SetupSprite, layer's depth is baked into its copy
+   std::vector< Vertex > vertices = {};
+   vertices.reserve(static_cast< size_t >(NUM_LAYERS) * VERTICES_PER_SPRITE);
+   for (const auto depth : LAYERS)
+   {
+      vertices.push_back({glm::vec3{-0.5f, 0.5f, depth}, glm::vec3{0.0f, 0.0f, 0.0f}});
+      vertices.push_back({glm::vec3{0.5f, 0.5f, depth}, glm::vec3{1.0f, 0.0f, 0.0f}});
+      vertices.push_back({glm::vec3{0.5f, -0.5f, depth}, glm::vec3{1.0f, 1.0f, 0.0f}});
+      vertices.push_back({glm::vec3{-0.5f, -0.5f, depth}, glm::vec3{0.0f, 1.0f, 0.0f}});
    }
+
+   vertexBuffer = CreateVertexBuffer(sizeof(Vertex) * vertices.size(), vertices);
 }
 
 void
@@ -793,17 +1208,53 @@ CreateSyncObjects()
 void
 WaitForFence(uint32_t frame)
 {
+   if (Data::headless)
+   {
+      return;
+   }
+
    vkWaitForFences(Data::vk_device, 1, &inFlightFences_[frame], VK_TRUE, UINT64_MAX);
 }
 
 void
 CreatePipelineCache()
 {
+   pipelineCacheHeader_ = GetPipelineCacheHeader();
+
+   MappedFile cacheFile = {};
+   std::span< const std::byte > initialData = {};
+
+   std::error_code errorCode;
+   const auto fileSize = std::filesystem::file_size(PIPELINE_CACHE_PATH, errorCode);
+   if (!errorCode and fileSize > sizeof(PipelineCacheHeader))
+   {
+      cacheFile = MappedFile{PIPELINE_CACHE_PATH};
+      const auto data = cacheFile.GetData();
+
+      auto expectedHeader = pipelineCacheHeader_;
+      expectedHeader.dataSize = data.size() - sizeof(PipelineCacheHeader);
+
+      if (std::memcmp(data.data(), &expectedHeader, sizeof(PipelineCacheHeader)) == 0)
+      {
+         initialData = data.subspan(sizeof(PipelineCacheHeader));
+         Logger::Info("Loaded pipeline cache ({} bytes)", initialData.size());
+      }
+      else
+      {
+         Logger::Info("Pipeline cache was created by different driver or shaders, discarding it");
+      }
+   }
+
+   // Driver itself ignores the data if it's not compatible
    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+   pipelineCacheCreateInfo.initialDataSize = initialData.size();
+   pipelineCacheCreateInfo.pInitialData = initialData.data();
    vk_check_error(vkCreatePipelineCache(Data::vk_device, &pipelineCacheCreateInfo, nullptr,
-                                        &Data::renderData_.at(boundApplication_).pipelineCache),
-                  "");
+                                        &Data::vk_pipelineCache),
+                  "failed to create pipeline cache!");
+
+   savedPipelineCacheSize_ = initialData.size();
 }
 
 void
@@ -825,9 +1276,42 @@ GetCurrentlyBoundType()
 }
 
 void
-UpdateDescriptors()
+UpdateTextureDescriptor(TextureID id)
 {
-   updateDescriptors_ = true;
+   // Each application has its own descriptor sets, the ones that aren't bound
+   // are written once they're bound again
+   for (auto& [type, renderData] : Data::renderData_)
+   {
+      for (auto& dirtySlots : renderData.dirtyTextureSlots)
+      {
+         dirtySlots.push_back(id);
+      }
+   }
+}
+
+void
+UpdateTextureDescriptors()
+{
+   auto& dirtySlots =
+      Data::renderData_.at(boundApplication_).dirtyTextureSlots.at(Data::currentFrame_);
+   if (dirtySlots.empty())
+   {
+      return;
+   }
+
+   // Placeholder and the uploaded texture can end up in the same list
+   std::ranges::sort(dirtySlots);
+   const auto duplicates = std::ranges::unique(dirtySlots);
+   dirtySlots.erase(duplicates.begin(), duplicates.end());
+
+   // Frame's previous submission is finished (see UpdateUniformBuffer)
+   if (not Data::headless)
+   {
+      QuadShader::UpdateTextureDescriptors(Data::currentFrame_, dirtySlots);
+   }
+
+   Data::renderStats.numTextureDescriptorWrites += dirtySlots.size();
+   dirtySlots.clear();
 }
 
 void
@@ -847,6 +1331,8 @@ CreateUniformBuffer()
       ubo = Buffer::CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
                                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+      // Stays mapped until the buffer is destroyed
+      ubo.Map();
    }
 }
 
@@ -867,6 +1353,41 @@ CreatePerInstanceBuffer()
       sbo = Buffer::CreateBuffer(SSBObufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
                                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+      // Stays mapped until the buffer is destroyed
+      sbo.Map();
+   }
+}
+
+void
+CreateVisibilityBuffers()
+{
+   auto& renderData = Data::renderData_[boundApplication_];
+   constexpr VkDeviceSize visibleBufferSize = MAX_NUM_SPRITES * sizeof(uint32_t);
+   constexpr VkDeviceSize indirectBufferSize = NUM_LAYERS * sizeof(VkDrawIndexedIndirectCommand);
+
+   for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++)
+   {
+      auto& visibleBuffer = renderData.visibleInstancesBuffer.at(frame);
+      auto& indirectBuffer = renderData.indirectDrawBuffer.at(frame);
+      if (visibleBuffer.buffer_ != VK_NULL_HANDLE)
+      {
+         visibleBuffer.Destroy();
+         indirectBuffer.Destroy();
+      }
+
+      visibleBuffer = Buffer::CreateBuffer(visibleBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                              | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+      indirectBuffer = Buffer::CreateBuffer(indirectBufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                               | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+      // Both are rewritten every frame, so they stay mapped until they're destroyed
+      visibleBuffer.Map();
+      indirectBuffer.Map();
+
+      // Nothing is drawn until the first culling pass
+      memset(indirectBuffer.mappedMemory_, 0, indirectBufferSize);
    }
 }
 
@@ -875,58 +1396,78 @@ UpdateUniformBuffer()
 {
    auto& renderData = Data::renderData_.at(boundApplication_);
 
-   for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
+   // Only the current frame's copy is written, the others get theirs when they're prepared
+   RecordUpload(sizeof(UniformBufferObject));
+   if (Data::headless)
    {
-      vkWaitForFences(Data::vk_device, 1, &inFlightFences_[frame], VK_TRUE, UINT64_MAX);
+      return;
+   }
 
-      UniformBufferObject tmpUBO = {};
+   WaitForFence(Data::currentFrame_);
 
-      tmpUBO.view = renderData.viewMat;
-      tmpUBO.proj = renderData.projMat;
+   UniformBufferObject tmpUBO = {};
 
-      auto& ubo = renderData.uniformBuffers.at(frame);
+   tmpUBO.view = renderData.viewMat;
+   tmpUBO.proj = renderData.projMat;
 
-      void* data = nullptr;
-      vmaMapMemory(Data::vk_hAllocator, ubo.allocation_, &data);
-      memcpy(data, &tmpUBO, sizeof(tmpUBO));
-      vmaUnmapMemory(Data::vk_hAllocator, ubo.allocation_);
-   }
+   auto& ubo = renderData.uniformBuffers.at(Data::currentFrame_);
+   memcpy(ubo.mappedMemory_, &tmpUBO, sizeof(tmpUBO));
 }
 
 void
 UpdatePerInstanceBuffer()
 {
-   if (updatePerInstanceBuffer_ and not updatedObjects_.empty())
+   const auto frame = Data::currentFrame_;
+   auto& renderData = Data::renderData_.at(boundApplication_);
+   auto& dirty = renderData.dirtyInstances.at(frame);
+   if (dirty.empty())
    {
-      auto& renderData = Data::renderData_.at(boundApplication_);
+      return;
+   }
 
-      for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
-      {
-         vkWaitForFences(Data::vk_device, 1, &inFlightFences_[frame], VK_TRUE, UINT64_MAX);
+   auto* instances = static_cast< PerInstanceBuffer* >(renderData.ssbo.at(frame).mappedMemory_);
 
-         auto& ssbo = renderData.ssbo.at(frame);
+   // Only this frame's copy is written, so only its previous submission has to be finished
+   WaitForFence(frame);
 
-         void* data = nullptr;
-         vmaMapMemory(Data::vk_hAllocator, ssbo.allocation_, &data);
+   std::ranges::sort(dirty);
 
-         for (const auto object : updatedObjects_)
-         {
-            // NOLINTNEXTLINE
-            PerInstanceBuffer* offset = reinterpret_cast< PerInstanceBuffer* >(data) + object;
-            memcpy(offset, renderData.perInstance.data() + object, sizeof(PerInstanceBuffer));
-         }
+   // Consecutive instances are copied together
+   size_t numUploaded = 0;
+   for (auto run = dirty.begin(); run != dirty.end();)
+   {
+      auto runEnd = std::next(run);
+      while (runEnd != dirty.end() and *runEnd == *std::prev(runEnd) + 1)
+      {
+         ++runEnd;
+      }
 
-         vmaUnmapMemory(Data::vk_hAllocator, ssbo.allocation_);
+      const auto first = *run;
+      const auto count = static_cast< size_t >(std::distance(run, runEnd));
+      if (instances)
+      {
+         memcpy(instances + first, renderData.perInstance.data() + first,
+                count * sizeof(PerInstanceBuffer));
       }
 
-      updatedObjects_.clear();
-      updatePerInstanceBuffer_ = false;
+      numUploaded += count;
+      run = runEnd;
    }
+
+   const auto frameBit = static_cast< uint8_t >(1U << frame);
+   for (const auto idx : dirty)
+   {
+      renderData.instanceDirtyFrames.at(idx) &= static_cast< uint8_t >(~frameBit);
+   }
+
+   RecordUpload(numUploaded * sizeof(PerInstanceBuffer));
+   dirty.clear();
 }
 
 void
 DestroyPipeline()
 {
+   Command::WaitForUploads();
    vkDeviceWaitIdle(Data::vk_device);
 
    auto& renderData = Data::renderData_.at(boundApplication_);
@@ -964,142 +1505,150 @@ DestroyPipeline()
 
    vkDestroyPipeline(Data::vk_device, renderData.pipeline, nullptr);
    vkDestroyPipelineLayout(Data::vk_device, renderData.pipelineLayout, nullptr);
-   vkDestroyPipelineCache(Data::vk_device, renderData.pipelineCache, nullptr);
    vkDestroyRenderPass(Data::vk_device, renderData.renderPass, nullptr);
+   ++Data::resourceGeneration;
 }
 
 void
 UpdateData()
 {
-   if (updateDescriptors_)
-   {
-      QuadShader::UpdateDescriptorSets();
-      updateDescriptors_ = false;
-   }
+   // Swap placeholders with prefetched textures that are ready
+   TextureLibrary::UploadLoadedTextures();
 
    UpdateUniformBuffer();
+   UpdateTextureDescriptors();
    UpdatePerInstanceBuffer();
-
-   if (updateVertexBuffer_)
-   {
-      const std::set< int32_t > layers(renderLayersChanged_.begin(), renderLayersChanged_.end());
-      for (const auto layer : layers)
-      {
-         SetupVertexBuffer(layer);
-      }
-
-      updateVertexBuffer_ = false;
-      renderLayersChanged_.clear();
-   }
-}
-
-void
-SetupVertexBuffer(const int32_t layer)
-{
-   const auto layerCasted = static_cast< size_t >(layer);
-   auto* renderData = &Data::renderData_[boundApplication_];
-   const auto bufferSize = sizeof(Vertex) * MAX_NUM_VERTICES_PER_LAYER;
-
-   renderData->vertexBuffer.at(layerCasted) =
-      CreateVertexBuffer(bufferSize, renderData->vertices.at(layerCasted));
+   CullInstances();
 }
 
 void
 MeshDeleted(const RenderInfo& renderInfo)
 {
-   auto* renderData = &Data::renderData_[boundApplication_];
+   const auto current = GetRenderInfo(renderInfo);
+   if (current.idx < 0)
+   {
+      // Already deleted
+      return;
+   }
 
-   renderData->verticesAvail.at(static_cast< size_t >(renderInfo.layer))
-      .reset(static_cast< size_t >(renderInfo.layerIdx));
+   auto& renderData = Data::renderData_[boundApplication_];
+   auto& numObjects = renderData.numMeshes.at(static_cast< size_t >(current.layer));
 
+   const auto idx = static_cast< uint32_t >(current.idx);
+   const auto lastIdx = static_cast< uint32_t >(current.layer) * MAX_SPRITES_PER_LAYER
+                        + --numObjects;
 
-   for (uint32_t vertexIdx = 0; vertexIdx < VERTICES_PER_SPRITE; ++vertexIdx)
+   // Keep the layer packed, its last sprite takes over the freed slot
+   if (idx != lastIdx)
    {
-      const auto offset = static_cast< uint32_t >(renderInfo.layerIdx) * VERTICES_PER_SPRITE;
-
-      auto& vertex =
-         renderData->vertices.at(static_cast< uint32_t >(renderInfo.layer)).at(offset + vertexIdx);
-      vertex = Vertex{};
+      const auto movedHandle = renderData.idxToHandle.at(lastIdx);
+      renderData.perInstance.at(idx) = renderData.perInstance.at(lastIdx);
+      MoveInstanceBounds(renderData.instanceBounds, lastIdx, idx);
+      renderData.idxToHandle.at(idx) = movedHandle;
+      renderData.handleToIdx.at(movedHandle & RenderInfo::HANDLE_SLOT_MASK) =
+         static_cast< int32_t >(idx);
+
+      MarkInstanceDirty(renderData, idx);
    }
 
-   updatePerInstanceBuffer_ = true;
-   updatedObjects_.push_back(static_cast< uint32_t >(renderInfo.idx));
+   // Slot's next owner gets a new generation, so this handle stays invalid
+   const auto slot = renderInfo.handle & RenderInfo::HANDLE_SLOT_MASK;
+   auto& generation = renderData.handleGenerations.at(slot);
+   generation = (generation + 1) & (RenderInfo::INVALID_HANDLE >> RenderInfo::HANDLE_SLOT_BITS);
 
-   updateVertexBuffer_ = true;
-   renderLayersChanged_.push_back(renderInfo.layer);
+   renderData.idxToHandle.at(lastIdx) = RenderInfo::INVALID_HANDLE;
+   renderData.handleToIdx.at(slot) = -1;
+   renderData.freeHandles.push_back(slot);
+
+   --renderData.totalNumMeshes;
+   ++Data::renderStats.numMeshesDeleted;
 }
 
 RenderInfo
-MeshLoaded(const std::vector< Vertex >& vertices_in, const TextureIDs& textures_in,
-           const glm::mat4& modelMat, const glm::vec4& color)
+GetRenderInfo(const RenderInfo& renderInfo)
 {
-   auto* renderData = &Data::renderData_[boundApplication_];
-   // convert from depth value to render layer
-   const auto layer = static_cast< int32_t >(vertices_in.front().position_.z * 20.0f);
-   int32_t idx = 0;
-
-   auto& vertices = renderData->vertices.at(static_cast< size_t >(layer));
-   auto& verticesAvail = renderData->verticesAvail.at(static_cast< size_t >(layer));
-   int32_t layerIdx = {};
-
-   for (uint32_t i = 0; i < MAX_SPRITES_PER_LAYER; ++i)
+   const auto& renderData = Data::renderData_[boundApplication_];
+   const auto slot = renderInfo.handle & RenderInfo::HANDLE_SLOT_MASK;
+   if (slot >= renderData.handleToIdx.size()
+       or renderData.handleGenerations.at(slot)
+             != renderInfo.handle >> RenderInfo::HANDLE_SLOT_BITS)
    {
-      if (!verticesAvail.test(i))
-      {
-         layerIdx = static_cast< int32_t >(i);
-         verticesAvail.set(i);
-         break;
-      }
+      // Mesh was never loaded, or it was deleted and its slot was reused
+      return {-1, renderInfo.layer, -1, renderInfo.handle};
    }
 
-   auto& numObjects = renderData->numMeshes.at(static_cast< size_t >(layer));
+   const auto idx = renderData.handleToIdx.at(slot);
+   const auto layerIdx =
+      idx < 0 ? -1 : idx - static_cast< int32_t >(MAX_SPRITES_PER_LAYER) * renderInfo.layer;
 
-   idx = layerIdx + static_cast< int32_t >(MAX_SPRITES_PER_LAYER) * layer;
-   for (uint32_t vertexIdx = 0; vertexIdx < VERTICES_PER_SPRITE; ++vertexIdx)
-   {
-      const auto offset = static_cast< uint32_t >(layerIdx) * VERTICES_PER_SPRITE;
+   return {idx, renderInfo.layer, layerIdx, renderInfo.handle};
+}
 
-      auto& vertex = vertices.at(offset + vertexIdx);
-      vertex = vertices_in.at(vertexIdx);
-      vertex.texCoordsDraw_.z = static_cast< float >(idx);
-   }
+RenderInfo
+MeshLoaded(uint32_t layer, const TextureIDs& textures_in, const glm::vec4& uvRect,
+           const SpriteTransform& transform, const glm::vec4& color)
+{
+   const auto renderInfo = RegisterMesh(Data::renderData_[boundApplication_], layer, textures_in,
+                                        uvRect, transform, color);
+
+   ++Data::renderStats.numMeshesLoaded;
 
-   UpdateDescriptors();
+   return renderInfo;
+}
 
-   // Only increase the counter if we're not reusing the slot
-   if (numObjects == static_cast< uint32_t >(layerIdx))
+void
+MeshesLoaded(std::span< const MeshRegistration > meshes)
+{
+   if (meshes.empty())
    {
-      numObjects++;
+      return;
    }
 
-   ++renderData->totalNumMeshes;
+   auto& renderData = Data::renderData_[boundApplication_];
 
-   SubmitMeshData(static_cast< uint32_t >(idx), textures_in, modelMat, color);
-   updateVertexBuffer_ = true;
-   renderLayersChanged_.push_back(layer);
+   for (const auto& mesh : meshes)
+   {
+      const auto renderInfo = RegisterMesh(renderData, mesh.layer, mesh.textures, mesh.uvRect,
+                                           mesh.transform, mesh.color);
+
+      if (mesh.renderInfo)
+      {
+         *mesh.renderInfo = renderInfo;
+      }
+   }
 
-   return {idx, layer, layerIdx};
+   Data::renderStats.numMeshesLoaded += meshes.size();
 }
 
 void
-SubmitMeshData(const uint32_t idx, const TextureIDs& ids, const glm::mat4& modelMat,
-               const glm::vec4& color)
-{
-   auto& object = Data::renderData_[boundApplication_].perInstance.at(idx);
-   object.model = modelMat;
-   object.color = color;
-   object.texSamples.x = static_cast< float >(ids.at(0));
-   object.texSamples.y = static_cast< float >(ids.at(1));
-   object.texSamples.z = static_cast< float >(ids.at(2));
-   object.texSamples.w = static_cast< float >(ids.at(3));
-
-   updatePerInstanceBuffer_ = true;
-   updatedObjects_.push_back(idx);
+SubmitMeshData(const uint32_t idx, const TextureIDs& ids, const glm::vec4& uvRect,
+               const SpriteTransform& transform, const glm::vec4& color)
+{
+   auto& renderData = Data::renderData_[boundApplication_];
+   auto& object = renderData.perInstance.at(idx);
+   object.position = transform.position;
+   object.halfSize = transform.size * 0.5f;
+   object.rotation = {std::sin(transform.angle), std::cos(transform.angle)};
+   object.color = glm::packUnorm4x8(color);
+   object.textures = (static_cast< uint32_t >(ids.at(0)) & 0xFFFFU)
+                     | (static_cast< uint32_t >(ids.at(1)) << 16U);
+   object.uvRect = {glm::packUnorm2x16(glm::vec2{uvRect.x, uvRect.y}),
+                    glm::packUnorm2x16(glm::vec2{uvRect.z, uvRect.w})};
+
+   SetInstanceBounds(renderData.instanceBounds, idx, object);
+   MarkInstanceDirty(renderData, idx);
+
+   ++Data::renderStats.numMeshSubmissions;
 }
 
 void
 CreateLinePipeline()
 {
+   if (Data::headless)
+   {
+      return;
+   }
+
    LineShader::CreateDescriptorSetLayout();
    LineShader::CreateDescriptorPool();
    LineShader::CreateDescriptorSets();
@@ -1114,6 +1663,7 @@ DrawLine(const glm::vec2& start, const glm::vec2& end)
    EditorData::lineVertices_.push_back(LineVertex{glm::vec3{end, 0.0f}});
 
    ++EditorData::numLines;
+   ++Data::renderStats.numLines;
 }
 
 void
@@ -1133,6 +1683,8 @@ DrawDynamicLine(const glm::vec2& start, const glm::vec2& end)
       EditorData::lineVertices_[totalNumVtx + EditorData::curDynLineIdx++] =
          LineVertex{glm::vec3{end, 0.0f}};
    }
+
+   ++Data::renderStats.numLines;
 }
 
 void
@@ -1146,6 +1698,12 @@ UpdateLineData(uint32_t startingLine)
       const auto bufferSize = numLines * sizeof(LineVertex) * VERTICES_PER_LINE;
       const auto offset = startingLine * sizeof(LineVertex) * VERTICES_PER_LINE;
 
+      RecordUpload(bufferSize);
+      if (Data::headless)
+      {
+         return;
+      }
+
       void* data = nullptr;
       vmaMapMemory(Data::vk_hAllocator, EditorData::lineVertexBuffer.allocation_, &data);
       char* dest = static_cast< char* >(data) + offset;
@@ -1160,6 +1718,11 @@ UpdateLineData(uint32_t startingLine)
 void
 SetupLineData()
 {
+   if (Data::headless)
+   {
+      return;
+   }
+
    EditorData::lineVertexBuffer = Buffer::CreateBuffer(
       sizeof(LineVertex) * MAX_NUM_LINES * 2,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
@@ -1175,29 +1738,18 @@ CreateQuadBuffers()
    CreateQuadVertexBuffer();
    CreateQuadIndexBuffer();
    CreatePerInstanceBuffer();
+   CreateVisibilityBuffers();
 }
 
 void
 RecreateQuadPipeline()
 {
-   vkDeviceWaitIdle(Data::vk_device);
-
-   // Indirect render stuff
-   // const auto commandsSize = m_renderCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
-
-   //////  Commands + draw count
-   // const VkDeviceSize bufferSize = commandsSize + sizeof(uint32_t);
-
-   // Buffer::CreateBuffer(bufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
-   //                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-   //                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_indirectDrawsBuffer,
-   //                      m_indirectDrawsBufferMemory);
-
-   // void* data = nullptr;
-   // vkMapMemory(Data::vk_device, m_indirectDrawsBufferMemory, 0, bufferSize, 0, &data);
-   // memcpy(data, m_renderCommands.data(), static_cast< size_t >(bufferSize));
-   // memcpy(static_cast< uint8_t* >(data) + commandsSize, &m_numMeshes, sizeof(uint32_t));
+   if (Data::headless)
+   {
+      return;
+   }
 
+   vkDeviceWaitIdle(Data::vk_device);
 
    DestroyPipeline();
 
@@ -1212,25 +1764,41 @@ RecreateQuadPipeline()
 void
 FreeData(renderer::ApplicationType type, bool destroyPipeline)
 {
+   if (Data::headless)
+   {
+      // Only CPU side data exists
+      if (destroyPipeline)
+      {
+         Data::renderData_.erase(type);
+      }
+
+      if (type == ApplicationType::EDITOR)
+      {
+         EditorData::lineVertices_.clear();
+         EditorData::numGridLines = 0;
+         EditorData::numLines = 0;
+         EditorData::curDynLineIdx = 0;
+      }
+
+      return;
+   }
+
+   Command::WaitForUploads();
    vkDeviceWaitIdle(Data::vk_device);
 
    if (Data::renderData_.find(type) != Data::renderData_.end())
    {
       auto& renderData = Data::renderData_.at(type);
 
-      for (size_t layer = 0; layer < static_cast< size_t >(NUM_LAYERS); ++layer)
-      {
-         renderData.indexBuffer.at(layer).Destroy();
-         renderData.indices.at(layer).clear();
-
-         renderData.vertexBuffer.at(layer).Destroy();
-         renderData.vertices.at(layer).clear();
-      }
+      renderData.quadIndexBuffer.Destroy();
+      renderData.quadVertexBuffer.Destroy();
 
       for (size_t i = 0; i < renderData.uniformBuffers.size(); ++i)
       {
          renderData.uniformBuffers.at(i).Destroy();
          renderData.ssbo.at(i).Destroy();
+         renderData.visibleInstancesBuffer.at(i).Destroy();
+         renderData.indirectDrawBuffer.at(i).Destroy();
       }
 
       if (type == ApplicationType::EDITOR)
@@ -1258,6 +1826,7 @@ FreeData(renderer::ApplicationType type, bool destroyPipeline)
 
          vkDestroyPipeline(Data::vk_device, EditorData::linePipeline_, nullptr);
          vkDestroyPipelineLayout(Data::vk_device, EditorData::linePipelineLayout_, nullptr);
+         ++Data::resourceGeneration;
 
          EditorData::numGridLines = 0;
          EditorData::numLines = 0;
@@ -1266,8 +1835,12 @@ FreeData(renderer::ApplicationType type, bool destroyPipeline)
 
       if (destroyPipeline)
       {
+         // Pick up pipelines that were created outside of the renderer (e.g. editor's UI)
+         SavePipelineCache();
+
          renderData.perInstance.clear();
 
+         DestroyRecordedPasses(type);
          DestroyPipeline();
          Data::renderData_.erase(type);
       }
@@ -1308,15 +1881,12 @@ Initialize(GLFWwindow* windowHandle, ApplicationType type)
 
 
       vmaCreateAllocator(&allocatorInfo, &Data::vk_hAllocator);
-   }
 
-   for (uint32_t layer = 0; layer < NUM_LAYERS; ++layer)
-   {
-      renderData.vertices.at(layer).resize(MAX_NUM_VERTICES_PER_LAYER);
-      renderData.indices.at(layer).resize(MAX_NUM_INDICES_PER_LAYER);
+      // Shared by all applications, so it outlives their pipelines
+      CreatePipelineCache();
    }
 
-   renderData.perInstance.resize(MAX_NUM_SPRITES);
+   AllocateRenderData(renderData);
 
    CreateRenderPipeline();
    CreateUniformBuffer();
@@ -1324,6 +1894,35 @@ Initialize(GLFWwindow* windowHandle, ApplicationType type)
    initialized_ = true;
 }
 
+void
+InitializeHeadless(ApplicationType type)
+{
+   SetAppMarker(type);
+   Data::headless = true;
+
+   AllocateRenderData(Data::renderData_[boundApplication_]);
+
+   initialized_ = true;
+}
+
+bool
+IsHeadless()
+{
+   return Data::headless;
+}
+
+const RenderStats&
+GetRenderStats()
+{
+   return Data::renderStats;
+}
+
+void
+ResetRenderStats()
+{
+   Data::renderStats = {};
+}
+
 void
 CreateRenderPipeline()
 {
@@ -1342,17 +1941,27 @@ CreateRenderPipeline()
    CreateColorResources();
    CreateDepthResources();
    CreateFramebuffers();
-   CreatePipelineCache();
    CreateSyncObjects();
 }
 
 void
 Render(Application* app)
 {
+   ++Data::renderStats.numFrames;
+
+   if (Data::headless)
+   {
+      Data::currentFrame_ = GetNextFrame();
+      return;
+   }
+
    auto& renderData = Data::renderData_.at(boundApplication_);
 
    vkWaitForFences(Data::vk_device, 1, &inFlightFences_[Data::currentFrame_], VK_TRUE, UINT64_MAX);
 
+   // Everything uploaded since the last frame in one submission, ahead of the frame itself
+   Command::SubmitUploads();
+
    uint32_t imageIndex = {};
    vkAcquireNextImageKHR(Data::vk_device, renderData.swapChain, UINT64_MAX,
                          imageAvailableSemaphores_[Data::currentFrame_], VK_NULL_HANDLE,
@@ -4,6 +4,8 @@
 #include "vulkan_common.hpp"
 
 #include <glm/glm.hpp>
+#include <functional>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -16,11 +18,64 @@ class Application;
 
 namespace looper::renderer {
 
-struct Vertex;
+/**
+ * \brief Deferred mesh registration. Can be filled on worker threads (see
+ * \c Sprite::SetSpriteTexturedDeferred) and then committed with \c MeshesLoaded
+ */
+struct MeshRegistration
+{
+   uint32_t layer = 0;
+   TextureIDs textures = {};
+   glm::vec4 uvRect = FULL_UV_RECT;
+   SpriteTransform transform = {};
+   glm::vec4 color = {};
+
+   // Receives the mesh's RenderInfo once it's committed
+   RenderInfo* renderInfo = nullptr;
+};
+
+/**
+ * \brief Draws recorded into their own secondary command buffer (see \c CreateCommandBuffers).
+ * Pass keeps its command buffer for each frame in flight and it's only recorded again
+ * when its key changes.
+ */
+struct DrawPass
+{
+   // Key of passes that are recorded every frame
+   static constexpr uint64_t ALWAYS_RECORD = 0;
+
+   // Identifies the pass across frames, has to be unique within a frame
+   uint32_t id = 0;
+   // Hash of everything that the recorded commands depend on (bound objects, draw parameters).
+   // Render pass, its extent and destroyed resources are taken into account by the renderer.
+   uint64_t key = ALWAYS_RECORD;
+   // Records the commands (viewport, scissor and line width are already set).
+   // Called on a ThreadPool worker, while the main thread waits for it.
+   std::function< void(VkCommandBuffer) > record = {};
+};
 
 void
 Initialize(GLFWwindow* windowHandle, ApplicationType type);
 
+/**
+ * \brief Initialize the renderer without a window or GPU, no Vulkan objects are ever created.
+ * All CPU side bookkeeping (meshes, per instance data, lines, textures) works as usual,
+ * while uploads and draws are only recorded in RenderStats. Used for benchmarks and tests.
+ *
+ * \param[in] type Application that's going to use the renderer
+ */
+void
+InitializeHeadless(ApplicationType type);
+
+[[nodiscard]] bool
+IsHeadless();
+
+[[nodiscard]] const RenderStats&
+GetRenderStats();
+
+void
+ResetRenderStats();
+
 void
 CreateRenderPipeline();
 
@@ -33,19 +88,53 @@ DrawLine(const glm::vec2& start, const glm::vec2& end);
 void
 DrawDynamicLine(const glm::vec2& start, const glm::vec2& end);
 
+/**
+ * \brief Free mesh's slot. Its layer is compacted right away (layer's last sprite is moved
+ * into the freed slot), so only live sprites are drawn.
+ *
+ * \param[in] renderInfo Mesh's RenderInfo, deleting the same mesh again is a no-op
+ */
 void
 MeshDeleted(const RenderInfo& renderInfo);
 
+/**
+ * \brief Look up mesh's current slot. Sprites can be moved by \c MeshDeleted,
+ * so \c RenderInfo::idx and \c RenderInfo::layerIdx are resolved from the mesh's handle.
+ *
+ * \param[in] renderInfo RenderInfo returned when the mesh was loaded
+ * \return Up to date RenderInfo (with idx -1 if the mesh was deleted or never loaded)
+ */
+[[nodiscard]] RenderInfo
+GetRenderInfo(const RenderInfo& renderInfo);
+
+/**
+ * \brief Register a sprite (instance of the unit quad) in given render layer
+ *
+ * \param[in] layer Render layer, in range [0, NUM_LAYERS)
+ * \param[in] textures_in Sprite's textures
+ * \param[in] uvRect Region of the diffuse texture that's sampled
+ * \param[in] transform Sprite's position, size and rotation
+ * \param[in] color Sprite's color
+ *
+ * \return RenderInfo of the new mesh
+ */
 [[nodiscard]] RenderInfo
-MeshLoaded(const std::vector< Vertex >& vertices_in, const TextureIDs& textures_in,
-           const glm::mat4& modelMat, const glm::vec4& color);
+MeshLoaded(uint32_t layer, const TextureIDs& textures_in, const glm::vec4& uvRect,
+           const SpriteTransform& transform, const glm::vec4& color);
 
+/**
+ * \brief Commit batch of meshes to the currently bound RenderData in a single pass.
+ * Meshes are registered in order (same slots as calling \c MeshLoaded for each of them),
+ * in O(1) each, and descriptors are flagged for update only once.
+ *
+ * \param[in] meshes Meshes to register, each one's \c renderInfo is filled with the result
+ */
 void
-SubmitMeshData(const uint32_t idx, const TextureIDs& ids, const glm::mat4& modelMat,
-               const glm::vec4& color);
+MeshesLoaded(std::span< const MeshRegistration > meshes);
 
 void
-SetupVertexBuffer(const int32_t layer);
+SubmitMeshData(const uint32_t idx, const TextureIDs& ids, const glm::vec4& uvRect,
+               const SpriteTransform& transform, const glm::vec4& color);
 
 void
 SetAppMarker(ApplicationType type);
@@ -77,11 +166,25 @@ SetupLineData();
 void
 UpdateLineData(uint32_t startingLine = 0);
 
+/**
+ * \brief Record the frame's primary command buffer, which executes draw passes of the
+ * application (see \c Application::Render). Passes whose key changed are recorded in parallel
+ * on the application's ThreadPool, the rest reuse their command buffers.
+ *
+ * \param[in] app Application that's rendered
+ * \param[in] imageIndex Index of the swapchain image that's rendered to
+ */
 void
 CreateCommandBuffers(Application* app, uint32_t imageIndex);
 
+/**
+ * \brief Flag texture's slot of the descriptor array to be written (for each frame in flight).
+ * Slots are written in \c UpdateData, other slots are left untouched.
+ *
+ * \param[in] id Texture that was created or whose image changed
+ */
 void
-UpdateDescriptors();
+UpdateTextureDescriptor(TextureID id);
 
 void
 UpdateData();
@@ -8,12 +8,13 @@
 
 #include <algorithm>
 #include <array>
+#include <span>
 
 namespace looper::renderer {
 namespace {
 
 VkShaderModule
-CreateShaderModule(VkDevice device, const std::vector< char >& shaderByteCode)
+CreateShaderModule(VkDevice device, std::span< const std::byte > shaderByteCode)
 {
    VkShaderModuleCreateInfo createInfo = {};
    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -33,10 +34,11 @@ CreateShaderModule(VkDevice device, const std::vector< char >& shaderByteCode)
 std::pair< VertexShaderInfo, FragmentShaderInfo >
 VulkanShader::CreateShader(VkDevice device, std::string_view vertex, std::string_view fragment)
 {
-   auto* vertShaderModule =
-      CreateShaderModule(device, FileManager::ReadBinaryFile(SHADERS_DIR / vertex));
-   auto* fragShaderModule =
-      CreateShaderModule(device, FileManager::ReadBinaryFile(SHADERS_DIR / fragment));
+   // SPIR-V is passed to the driver straight from the mapping (which is at least 16-byte aligned)
+   const auto vertexFile = FileManager::MapFile(SHADERS_DIR / vertex);
+   const auto fragmentFile = FileManager::MapFile(SHADERS_DIR / fragment);
+   auto* vertShaderModule = CreateShaderModule(device, vertexFile.GetData());
+   auto* fragShaderModule = CreateShaderModule(device, fragmentFile.GetData());
 
    VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -61,14 +63,19 @@ QuadShader::CreateDescriptorPool()
 {
    auto& renderData = Data::renderData_.at(GetCurrentlyBoundType());
 
-   std::array< VkDescriptorPoolSize, 2 > poolSizes{};
+   std::array< VkDescriptorPoolSize, 3 > poolSizes{};
    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
    poolSizes[0].descriptorCount = static_cast< uint32_t >(renderData.swapChainImages.size());
    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-   poolSizes[1].descriptorCount = static_cast< uint32_t >(renderData.swapChainImages.size());
+   poolSizes[1].descriptorCount =
+      MAX_NUM_TEXTURES * static_cast< uint32_t >(renderData.swapChainImages.size());
+   // Per instance data and visible instances
+   poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+   poolSizes[2].descriptorCount = 2 * static_cast< uint32_t >(renderData.swapChainImages.size());
 
    VkDescriptorPoolCreateInfo poolInfo = {};
    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+   poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
    poolInfo.poolSizeCount = static_cast< uint32_t >(poolSizes.size());
    poolInfo.pPoolSizes = poolSizes.data();
    poolInfo.maxSets = static_cast< uint32_t >(renderData.swapChainImages.size());
@@ -102,11 +109,32 @@ QuadShader::CreateDescriptorSetLayout()
    texturesLayoutBinding.pImmutableSamplers = nullptr;
    texturesLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
+   VkDescriptorSetLayoutBinding visibleInstancesBinding = {};
+   visibleInstancesBinding.binding = 3;
+   visibleInstancesBinding.descriptorCount = 1;
+   visibleInstancesBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+   visibleInstancesBinding.pImmutableSamplers = nullptr;
+   visibleInstancesBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
    auto bindings = std::to_array< VkDescriptorSetLayoutBinding >(
-      {uboLayoutBinding, perInstanceBinding, texturesLayoutBinding});
+      {uboLayoutBinding, perInstanceBinding, texturesLayoutBinding, visibleInstancesBinding});
+
+   // Texture array is bindless, only slots of existing textures are ever written (one by one,
+   // see UpdateTextureDescriptors) and the shader only reads those
+   constexpr VkDescriptorBindingFlags texturesFlags =
+      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+      | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+   auto bindingFlags = std::to_array< VkDescriptorBindingFlags >({0, 0, texturesFlags, 0});
+
+   VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+   bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+   bindingFlagsInfo.bindingCount = static_cast< uint32_t >(bindingFlags.size());
+   bindingFlagsInfo.pBindingFlags = bindingFlags.data();
 
    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   layoutInfo.pNext = &bindingFlagsInfo;
+   layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
    layoutInfo.bindingCount = static_cast< uint32_t >(bindings.size());
    layoutInfo.pBindings = bindings.data();
 
@@ -142,14 +170,8 @@ QuadShader::UpdateDescriptorSets()
 {
    auto& renderData = renderer::Data::renderData_.at(GetCurrentlyBoundType());
 
-   // Explicit copy
-   auto viewAndSamplers = TextureLibrary::GetViewSamplerPairs();
-
-   // Fill all MAX_NUM_TEXTURES ImageViews
-   for (size_t i = viewAndSamplers.size(); i < MAX_NUM_TEXTURES; ++i)
-   {
-      viewAndSamplers.push_back(viewAndSamplers.front());
-   }
+   // Slots of textures that don't exist yet stay unwritten (the binding is partially bound)
+   const auto& viewAndSamplers = TextureLibrary::GetViewSamplerPairs();
 
    std::vector< VkDescriptorImageInfo > descriptorImageInfos(viewAndSamplers.size(),
                                                              VkDescriptorImageInfo{});
@@ -179,7 +201,12 @@ QuadShader::UpdateDescriptorSets()
       instanceBufferInfo.offset = 0;
       instanceBufferInfo.range = renderData.ssbo.at(frame).bufferSize_;
 
-      std::array< VkWriteDescriptorSet, 3 > descriptorWrites = {};
+      VkDescriptorBufferInfo visibleBufferInfo = {};
+      visibleBufferInfo.buffer = renderData.visibleInstancesBuffer.at(frame).buffer_;
+      visibleBufferInfo.offset = 0;
+      visibleBufferInfo.range = renderData.visibleInstancesBuffer.at(frame).bufferSize_;
+
+      std::array< VkWriteDescriptorSet, 4 > descriptorWrites = {};
 
       descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
       descriptorWrites[0].dstSet = renderData.descriptorSets.at(frame);
@@ -199,17 +226,73 @@ QuadShader::UpdateDescriptorSets()
 
       descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
       descriptorWrites[2].dstSet = renderData.descriptorSets.at(frame);
-      descriptorWrites[2].dstBinding = 2;
+      descriptorWrites[2].dstBinding = 3;
       descriptorWrites[2].dstArrayElement = 0;
-      descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      descriptorWrites[2].descriptorCount = static_cast< uint32_t >(viewAndSamplers.size());
-      descriptorWrites[2].pImageInfo = descriptorImageInfos.data();
-
-      vkUpdateDescriptorSets(Data::vk_device, static_cast< uint32_t >(descriptorWrites.size()),
+      descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      descriptorWrites[2].descriptorCount = 1;
+      descriptorWrites[2].pBufferInfo = &visibleBufferInfo;
+
+      descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      descriptorWrites[3].dstSet = renderData.descriptorSets.at(frame);
+      descriptorWrites[3].dstBinding = 2;
+      descriptorWrites[3].dstArrayElement = 0;
+      descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      descriptorWrites[3].descriptorCount = static_cast< uint32_t >(viewAndSamplers.size());
+      descriptorWrites[3].pImageInfo = descriptorImageInfos.data();
+
+      // Texture array is the last write, skip it when there are no textures yet
+      const auto numWrites = descriptorImageInfos.empty() ? descriptorWrites.size() - 1
+                                                          : descriptorWrites.size();
+      vkUpdateDescriptorSets(Data::vk_device, static_cast< uint32_t >(numWrites),
                              descriptorWrites.data(), 0, nullptr);
    }
 }
 
+void
+QuadShader::UpdateTextureDescriptors(uint32_t frame, std::span< const TextureID > textureIDs)
+{
+   const auto& renderData = renderer::Data::renderData_.at(GetCurrentlyBoundType());
+   const auto& viewAndSamplers = TextureLibrary::GetViewSamplerPairs();
+
+   std::vector< VkDescriptorImageInfo > descriptorImageInfos = {};
+   descriptorImageInfos.reserve(textureIDs.size());
+   std::vector< VkWriteDescriptorSet > descriptorWrites = {};
+
+   // IDs are sorted, consecutive slots are written with a single VkWriteDescriptorSet
+   for (size_t i = 0; i < textureIDs.size(); ++i)
+   {
+      const auto id = static_cast< uint32_t >(textureIDs[i]);
+      const auto& [view, sampler] = viewAndSamplers.at(id);
+      descriptorImageInfos.push_back({sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+
+      if (i > 0 and id == static_cast< uint32_t >(textureIDs[i - 1]) + 1)
+      {
+         ++descriptorWrites.back().descriptorCount;
+         continue;
+      }
+
+      VkWriteDescriptorSet write = {};
+      write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write.dstSet = renderData.descriptorSets.at(frame);
+      write.dstBinding = 2;
+      write.dstArrayElement = id;
+      write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      write.descriptorCount = 1;
+      descriptorWrites.push_back(write);
+   }
+
+   // Image infos are only pointed to once the vector doesn't grow anymore
+   size_t firstInfo = 0;
+   for (auto& write : descriptorWrites)
+   {
+      write.pImageInfo = descriptorImageInfos.data() + firstInfo;
+      firstInfo += write.descriptorCount;
+   }
+
+   vkUpdateDescriptorSets(Data::vk_device, static_cast< uint32_t >(descriptorWrites.size()),
+                          descriptorWrites.data(), 0, nullptr);
+}
+
 ///////////////////////////////////////////////////////////////////
 ///////////////////////    LINE SHADER      ///////////////////////
 ///////////////////////////////////////////////////////////////////
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "types.hpp"
+
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 
+#include <span>
 #include <string_view>
 #include <utility>
 
@@ -57,8 +60,18 @@ struct QuadShader
    static void
    CreateDescriptorSets();
 
+   // Write every binding (and slots of all existing textures) of each frame's descriptor set
    static void
    UpdateDescriptorSets();
+
+   /**
+    * \brief Write only the given slots of the texture array, in the frame's descriptor set
+    *
+    * \param[in] frame Frame in flight whose set is written (it can't be in use by the GPU)
+    * \param[in] textureIDs Sorted IDs of textures to write
+    */
+   static void
+   UpdateTextureDescriptors(uint32_t frame, std::span< const TextureID > textureIDs);
 };
 
 struct LineShader
@@ -9,23 +9,31 @@
 namespace looper::renderer {
 
 void
-Sprite::ClearData() const
+Sprite::ClearData()
 {
-   const auto transformMat = ComputeModelMat();
+   // Slot is handed over to another sprite (or stops being drawn)
+   renderer::MeshDeleted(renderInfo_);
+   renderInfo_.handle = RenderInfo::INVALID_HANDLE;
+}
 
-   renderer::SubmitMeshData(static_cast< uint32_t >(renderInfo_.idx), textures_, transformMat,
-                            {0.0f, 0.0f, 0.0f, 0.0f});
+RenderInfo
+Sprite::GetRenderInfo() const
+{
+   return renderer::GetRenderInfo(renderInfo_);
+}
 
-   renderer::MeshDeleted(renderInfo_);
+int32_t
+Sprite::GetRenderIdx() const
+{
+   return GetRenderInfo().idx;
 }
 
 
-glm::mat4
-Sprite::ComputeModelMat() const
+SpriteTransform
+Sprite::ComputeTransform() const
 {
-   return glm::translate(glm::mat4(1.0f), glm::vec3{currentState_.translateVal_, 0.0f})
-          * glm::rotate(glm::mat4(1.0f), currentState_.angle_, {0.0f, 0.0f, 1.0f})
-          * glm::scale(glm::mat4(1.0f), {size_ * currentState_.modifiers.scale, 1.0f});
+   return {currentState_.translateVal_, size_ * currentState_.modifiers.scale,
+           currentState_.angle_};
 }
 
 void
@@ -33,24 +41,34 @@ Sprite::ChangeRenderLayer(int32_t newLayer)
 {
    renderer::MeshDeleted(renderInfo_);
 
-   for (auto& vertex : vertices_)
-   {
-      vertex.position_.z = LAYERS.at(static_cast< uint32_t >(newLayer));
-   }
-
-   const auto transformMat = ComputeModelMat();
-   const auto oldLayer = renderInfo_.layer;
-
-   renderInfo_ = MeshLoaded(vertices_, textures_, transformMat, currentState_.color_);
+   renderInfo_ = MeshLoaded(static_cast< uint32_t >(newLayer), textures_, texture_->GetUVRect(),
+                            ComputeTransform(), currentState_.color_);
    changed_ = true;
-
-   SetupVertexBuffer(oldLayer);
-   SetupVertexBuffer(newLayer);
 }
 
 void
 Sprite::SetSpriteTextured(const glm::vec2& position, const glm::vec2& size,
                           const std::string& fileName, uint32_t renderLayer)
+{
+   SetupSprite(position, size, utils::StringInterner::Intern(fileName));
+
+   renderInfo_ = MeshLoaded(renderLayer, textures_, texture_->GetUVRect(), ComputeTransform(),
+                            currentState_.color_);
+}
+
+void
+Sprite::SetSpriteTexturedDeferred(const glm::vec2& position, const glm::vec2& size,
+                                  utils::StringID fileName, uint32_t renderLayer,
+                                  MeshRegistration& registration)
+{
+   SetupSprite(position, size, fileName);
+
+   registration = {renderLayer, textures_, texture_->GetUVRect(), ComputeTransform(),
+                   currentState_.color_, &renderInfo_};
+}
+
+void
+Sprite::SetupSprite(const glm::vec2& position, const glm::vec2& size, utils::StringID fileName)
 {
    changed_ = true;
 
@@ -64,34 +82,11 @@ Sprite::SetSpriteTextured(const glm::vec2& position, const glm::vec2& size,
    currentState_.scaleVal_ = glm::vec2(1.0f, 1.0f);
    currentState_.color_ = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
-
-   /*                          y -1
-                                ^
-                                |
-       x (0) [-0.5f, 0.5f]      |     x (1) [0.5f, 0.5f]
-                                |
-     -------------------------------------------------------->  x +1
-                                |
-                                |
-        x (3) [-0.5f, -0.5f]    |     x (2) [0.5f, -0.5f]
-
-   */
-   vertices_ = std::vector< renderer::Vertex >{
-      {glm::vec3{-0.5f, 0.5f, LAYERS.at(renderLayer)}, glm::vec3{0.0f, 0.0f, 1.0f}},
-      {glm::vec3{0.5f, 0.5f, LAYERS.at(renderLayer)}, glm::vec3{1.0f, 0.0f, 1.0f}},
-      {glm::vec3(0.5f, -0.5f, LAYERS.at(renderLayer)), glm::vec3{1.0f, 1.0f, 1.0f}},
-      {glm::vec3{-0.5f, -0.5f, LAYERS.at(renderLayer)}, glm::vec3{0.0f, 1.0f, 1.0f}}};
-
-   const auto transformMat = ComputeModelMat();
    ComputeBoundingBox();
 
-   textures_ = {TextureLibrary::GetTexture(fileName)->GetID(),
-                TextureLibrary::GetTexture("white.png")->GetID(),
-                TextureLibrary::GetTexture(fileName)->GetID(),
-                TextureLibrary::GetTexture(fileName)->GetID()};
-
-
-   renderInfo_ = MeshLoaded(vertices_, textures_, transformMat, currentState_.color_);
+   texture_ = TextureLibrary::GetTexture(fileName);
+   const auto textureID = texture_->GetID();
+   textures_ = {textureID, TextureLibrary::GetTexture(MASK_TEXTURE)->GetID(), textureID, textureID};
 }
 
 void
@@ -126,11 +121,14 @@ Sprite::Render()
 {
    if (changed_)
    {
-      const auto transformMat = ComputeModelMat();
       ComputeBoundingBox();
 
-      renderer::SubmitMeshData(static_cast< uint32_t >(renderInfo_.idx), textures_, transformMat,
-                               currentState_.color_);
+      const auto idx = GetRenderIdx();
+      if (idx >= 0)
+      {
+         renderer::SubmitMeshData(static_cast< uint32_t >(idx), textures_, texture_->GetUVRect(),
+                                  ComputeTransform(), currentState_.color_);
+      }
 
       changed_ = false;
    }
@@ -164,7 +162,7 @@ Sprite::GetOriginalSize() const
 std::string
 Sprite::GetTextureName() const
 {
-   return renderer::TextureLibrary::GetTexture(textures_.at(0))->GetName();
+   return texture_->GetName();
 }
 
 glm::vec2
@@ -210,7 +208,8 @@ Sprite::SetColor(const glm::vec4& color)
 void
 Sprite::SetTextureFromFile(const std::string& filePath)
 {
-   textures_[0] = renderer::TextureLibrary::GetTexture(filePath)->GetID();
+   texture_ = renderer::TextureLibrary::GetTexture(filePath);
+   textures_[0] = texture_->GetID();
    changed_ = true;
 }
 
@@ -239,6 +238,7 @@ Sprite::SetTextureID(TextureType type, TextureID newID)
    switch (type)
    {
       case TextureType::DIFFUSE_MAP: {
+         texture_ = renderer::TextureLibrary::GetTexture(newID);
          textures_[0] = newID;
       }
       break;
@@ -264,7 +264,7 @@ Sprite::SetTextureID(TextureType type, TextureID newID)
 const renderer::Texture*
 Sprite::GetTexture() const
 {
-   return renderer::TextureLibrary::GetTexture(textures_.at(0));
+   return texture_;
 }
 
 void
@@ -335,15 +335,21 @@ Sprite::ScaleUniformly(const float scaleValue)
 void
 Sprite::ComputeBoundingBox()
 {
-   const auto transformMat =
-      glm::translate(glm::mat4(1.0f), glm::vec3{currentState_.translateVal_, 0.0f})
-      * glm::rotate(glm::mat4(1.0f), currentState_.angle_, {0.0f, 0.0f, 1.0f})
-      * glm::scale(glm::mat4(1.0f), {size_, 1.0f});
+   boundingBox_ = ComputeBoundingBox(currentState_.translateVal_, size_, currentState_.angle_);
+}
+
+std::array< glm::vec2, 4 >
+Sprite::ComputeBoundingBox(const glm::vec2& position, const glm::vec2& size, float angle)
+{
+   const auto transformMat = glm::translate(glm::mat4(1.0f), glm::vec3{position, 0.0f})
+                             * glm::rotate(glm::mat4(1.0f), angle, {0.0f, 0.0f, 1.0f})
+                             * glm::scale(glm::mat4(1.0f), {size, 1.0f});
 
-   boundingBox_.at(1) = transformMat * glm::vec4(vertices_[0].position_, 1.0f);
-   boundingBox_.at(2) = transformMat * glm::vec4(vertices_[3].position_, 1.0f);
-   boundingBox_.at(0) = transformMat * glm::vec4(vertices_[1].position_, 1.0f);
-   boundingBox_.at(3) = transformMat * glm::vec4(vertices_[2].position_, 1.0f);
+   // Same corners as sprite's vertices (see SetupSprite)
+   return {transformMat * glm::vec4(0.5f, 0.5f, 0.0f, 1.0f),
+           transformMat * glm::vec4(-0.5f, 0.5f, 0.0f, 1.0f),
+           transformMat * glm::vec4(-0.5f, -0.5f, 0.0f, 1.0f),
+           transformMat * glm::vec4(0.5f, -0.5f, 0.0f, 1.0f)};
 }
 
 const std::array< glm::vec2, 4 >&
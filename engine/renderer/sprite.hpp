@@ -4,7 +4,6 @@
 #include "state_list.hpp"
 #include "texture.hpp"
 #include "types.hpp"
-#include "vertex.hpp"
 #include "vulkan_common.hpp"
 
 #include <glm/glm.hpp>
@@ -12,6 +11,8 @@
 
 namespace looper::renderer {
 
+struct MeshRegistration;
+
 class Sprite
 {
  public:
@@ -21,7 +22,7 @@ class Sprite
    };
 
    void
-   ClearData() const;
+   ClearData();
 
    // Create sprite with texture
    void
@@ -29,6 +30,17 @@ class Sprite
                      const glm::vec2& size = glm::vec2(128, 128),
                      const std::string& fileName = "Default128.png", uint32_t renderLayer = 2);
 
+   /**
+    * \brief Same as \c SetSpriteTextured, but doesn't register the mesh in the renderer.
+    * Safe to call from worker threads, as long as all used textures are already loaded.
+    *
+    * \param[out] registration Filled with mesh data, commit it with \c renderer::MeshesLoaded
+    */
+   void
+   SetSpriteTexturedDeferred(const glm::vec2& position, const glm::vec2& size,
+                             utils::StringID fileName, uint32_t renderLayer,
+                             MeshRegistration& registration);
+
    void
    SetColor(const glm::vec4& color);
 
@@ -62,8 +74,8 @@ class Sprite
    [[nodiscard]] float
    GetRotation(RotationType type = RotationType::radians) const;
 
-   [[nodiscard]] glm::mat4
-   ComputeModelMat() const;
+   [[nodiscard]] SpriteTransform
+   ComputeTransform() const;
 
    [[nodiscard]] glm::vec2&
    GetScale();
@@ -102,6 +114,19 @@ class Sprite
    [[nodiscard]] const std::array< glm::vec2, 4 >&
    GetTransformedRectangle() const;
 
+   /**
+    * \brief Compute bounding box (see \c GetTransformedRectangle) of the sprite with given
+    * transform, without creating the sprite
+    *
+    * \param[in] position Sprite's position
+    * \param[in] size Sprite's size
+    * \param[in] angle Rotation angle (in radians)
+    *
+    * \return Sprite's bounding box
+    */
+   [[nodiscard]] static std::array< glm::vec2, 4 >
+   ComputeBoundingBox(const glm::vec2& position, const glm::vec2& size, float angle);
+
    bool
    CheckIfCollidedScreenPosion(const glm::vec3& cameraPosition,
                                const glm::vec2& globalPosition) const;
@@ -124,23 +149,12 @@ class Sprite
    void
    SetModifiers(const Modifiers& mod);
 
+   // Sprite's current slot (it can be moved when other sprites are deleted)
    [[nodiscard]] RenderInfo
-   GetRenderInfo() const
-   {
-      return renderInfo_;
-   }
+   GetRenderInfo() const;
 
    [[nodiscard]] int32_t
-   GetRenderIdx() const
-   {
-      return renderInfo_.idx;
-   }
-
-   void
-   SetRenderIdx(int32_t idx)
-   {
-      renderInfo_.idx = idx;
-   }
+   GetRenderIdx() const;
 
    void
    ChangeRenderLayer(int32_t newLayer);
@@ -153,6 +167,9 @@ class Sprite
    glm::vec2 initialSize_ = {};
 
  private:
+   void
+   SetupSprite(const glm::vec2& position, const glm::vec2& size, utils::StringID fileName);
+
    void
    ComputeBoundingBox();
 
@@ -179,15 +196,19 @@ class Sprite
    StateList< State > statesQueue_ = {};
    State currentState_ = {};
 
+   // Texture used as sprite's mask
+   static inline const utils::StringID MASK_TEXTURE = utils::StringInterner::Intern("white.png");
+
    // sprite's texture
    TextureIDs textures_ = {};
+   // diffuse texture, might be a region of an atlas page (see Texture::IsAtlasRegion)
+   const Texture* texture_ = nullptr;
 
    // width and height
    glm::vec2 size_ = {};
    bool changed_ = false;
    RenderInfo renderInfo_ = {};
 
-   std::vector< renderer::Vertex > vertices_ = {};
    std::array< glm::vec2, 4 > boundingBox_ = {};
 };
 
@@ -3,23 +3,74 @@
 #include "command.hpp"
 #include "logger/logger.hpp"
 #include "renderer.hpp"
+#include "texture_atlas.hpp"
+#include "thread_pool.hpp"
 #include "time/scoped_timer.hpp"
 #include "utils/assert.hpp"
 #include "utils/file_manager.hpp"
 #include "vulkan_common.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <memory>
 #include <ranges>
 #include <string_view>
 
 namespace looper::renderer {
 
+namespace {
+
+// Memory that the device local heaps are over their budget, as reported by VMA
+VkDeviceSize
+GetHeapsOverBudget()
+{
+   if (Data::headless)
+   {
+      return 0;
+   }
+
+   const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+   vmaGetMemoryProperties(Data::vk_hAllocator, &memoryProperties);
+
+   std::array< VmaBudget, VK_MAX_MEMORY_HEAPS > budgets = {};
+   vmaGetHeapBudgets(Data::vk_hAllocator, budgets.data());
+
+   VkDeviceSize overBudget = 0;
+   for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap)
+   {
+      const auto& budget = budgets.at(heap);
+      if ((memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+          and budget.usage > budget.budget)
+      {
+         overBudget += budget.usage - budget.budget;
+      }
+   }
+
+   return overBudget;
+}
+
+} // namespace
+
 /**************************************************************************************************
  ****************************************** TEXTURE ***********************************************
  *************************************************************************************************/
 
 void
-Texture::Destroy()
+Texture::Destroy(bool waitForUploads)
 {
+   if (Data::headless)
+   {
+      return;
+   }
+
+   // Image could still be the target of an upload that's in flight
+   if (waitForUploads)
+   {
+      Command::WaitForUploads();
+   }
+
    vkDestroySampler(Data::vk_device, m_textureSampler, nullptr);
    vkDestroyImageView(Data::vk_device, m_textureImageView, nullptr);
    vmaDestroyImage(Data::vk_hAllocator, image_.textureImage_, image_.allocation_);
@@ -29,8 +80,8 @@ Texture::Texture(TextureType type, std::string_view textureName, TextureID id,
                  const TextureProperties& props)
    : id_(id), m_type(type), textureProps_(props), m_name(std::string(textureName))
 {
-   auto textureData = FileManager::LoadImageData(m_name);
-   CreateTextureImage(textureData);
+   const auto cooked = CookedTexture::Load(m_name, m_type == TextureType::DIFFUSE_MAP);
+   CreateTextureImage(cooked, 0);
 }
 
 Texture::Texture(TextureType type, std::string_view textureName, TextureID id,
@@ -40,6 +91,40 @@ Texture::Texture(TextureType type, std::string_view textureName, TextureID id,
    CreateTextureImage(data);
 }
 
+Texture::Texture(TextureType type, std::string_view textureName, TextureID id,
+                 const CookedTexture& cooked, const TextureProperties& props, uint32_t firstMip)
+   : id_(id), m_type(type), textureProps_(props), m_name(std::string(textureName))
+{
+   CreateTextureImage(cooked, firstMip);
+}
+
+Texture
+Texture::CreatePending(TextureType type, std::string_view textureName, TextureID id,
+                       const TextureProperties& props)
+{
+   Texture texture = {};
+   texture.id_ = id;
+   texture.m_type = type;
+   texture.textureProps_ = props;
+   texture.m_name = std::string(textureName);
+
+   return texture;
+}
+
+Texture
+Texture::CreateAtlasRegion(std::string_view textureName, const Texture& page,
+                           const glm::vec4& uvRect)
+{
+   Texture texture = {};
+   texture.id_ = page.id_;
+   texture.m_type = page.m_type;
+   texture.m_name = std::string(textureName);
+   texture.uvRect_ = uvRect;
+   texture.atlasRegion_ = true;
+
+   return texture;
+}
+
 void
 Texture::CreateTextureImage(const FileManager::ImageData& data)
 {
@@ -49,6 +134,13 @@ Texture::CreateTextureImage(const FileManager::ImageData& data)
       m_type == TextureType::DIFFUSE_MAP ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
    m_mips = static_cast< uint32_t >(std::floor(std::log2(std::max(m_width, m_height)))) + 1;
 
+   ++Data::renderStats.numTextureUploads;
+   Data::renderStats.bytesUploaded += static_cast< uint64_t >(m_width) * m_height * 4;
+   if (Data::headless)
+   {
+      return;
+   }
+
    image_ = CreateImage(m_width, m_height, m_mips, VK_SAMPLE_COUNT_1_BIT, m_format,
                         VK_IMAGE_TILING_OPTIMAL,
                         VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
@@ -62,9 +154,79 @@ Texture::CreateTextureImage(const FileManager::ImageData& data)
    UpdateTexture(data);
 }
 
+void
+Texture::CreateTextureImage(const CookedTexture& cooked, uint32_t firstMip)
+{
+   utils::Assert(firstMip < cooked.GetNumMips(),
+                 fmt::format("Texture {} has no mip {}!", m_name, firstMip));
+
+   const auto mips = cooked.GetMips().subspan(firstMip);
+   m_width = static_cast< uint32_t >(mips.front().size.x);
+   m_height = static_cast< uint32_t >(mips.front().size.y);
+   m_format =
+      m_type == TextureType::DIFFUSE_MAP ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+   m_mips = static_cast< uint32_t >(mips.size());
+   residentMip_ = firstMip;
+
+   // Mips are stored from the largest one, so the resident ones are the tail of the pixels
+   const auto pixelsOffset = mips.front().offset;
+   const auto pixels = cooked.GetPixels().subspan(pixelsOffset);
+
+   ++Data::renderStats.numTextureUploads;
+   Data::renderStats.bytesUploaded += pixels.size();
+   if (Data::headless)
+   {
+      return;
+   }
+
+   image_ = CreateImage(m_width, m_height, m_mips, VK_SAMPLE_COUNT_1_BIT, m_format,
+                        VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+                           | VK_IMAGE_USAGE_SAMPLED_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+
+   m_textureImageView =
+      CreateImageView(image_.textureImage_, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mips, false);
+
+   CreateTextureSampler();
+
+   std::vector< VkBufferImageCopy > regions = {};
+   regions.reserve(m_mips);
+   for (uint32_t mipLevel = 0; mipLevel < m_mips; ++mipLevel)
+   {
+      const auto& mip = mips[mipLevel];
+
+      VkBufferImageCopy region = {};
+      region.bufferOffset = mip.offset - pixelsOffset;
+      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel = mipLevel;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount = 1;
+      region.imageOffset = {0, 0, 0};
+      region.imageExtent = {static_cast< uint32_t >(mip.size.x),
+                            static_cast< uint32_t >(mip.size.y), 1};
+
+      regions.push_back(region);
+   }
+
+   TransitionImageLayout(image_.textureImage_, VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mips);
+
+   // Whole mip chain is copied straight from the (mapped) cooked texture in one go
+   Buffer::CopyDataToImageWithStaging(image_.textureImage_, pixels.data(), pixels.size(), regions);
+
+   TransitionImageLayout(image_.textureImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mips);
+}
+
 void
 Texture::UpdateTexture(const FileManager::ImageData& data) const
 {
+   if (Data::headless)
+   {
+      return;
+   }
+
    TransitionImageLayout(image_.textureImage_, VK_IMAGE_LAYOUT_UNDEFINED,
                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mips);
 
@@ -186,7 +348,7 @@ Texture::GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth,
       utils::Assert(false, "Texture image format does not support linear blitting!");
    }
 
-   VkCommandBuffer commandBuffer = Command::BeginSingleTimeCommands();
+   VkCommandBuffer commandBuffer = Command::GetUploadCommandBuffer();
 
    VkImageMemoryBarrier barrier = {};
    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -258,8 +420,6 @@ Texture::GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth,
    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
                         &barrier);
-
-   Command::EndSingleTimeCommands(commandBuffer);
 }
 
 VkDescriptorSet
@@ -330,6 +490,62 @@ Texture::GetID() const
    return id_;
 }
 
+bool
+Texture::IsLoaded() const
+{
+   // Headless textures never get an image, only their size
+   return image_.textureImage_ != VK_NULL_HANDLE or (Data::headless and m_width > 0);
+}
+
+bool
+Texture::IsAtlasRegion() const
+{
+   return atlasRegion_;
+}
+
+const glm::vec4&
+Texture::GetUVRect() const
+{
+   return uvRect_;
+}
+
+const TextureProperties&
+Texture::GetProperties() const
+{
+   return textureProps_;
+}
+
+uint32_t
+Texture::GetResidentMip() const
+{
+   return residentMip_;
+}
+
+uint32_t
+Texture::GetMipForSize(uint32_t maxSize) const
+{
+   uint32_t mip = 0;
+   while (mip + 1 < m_mips and std::max(m_width >> mip, m_height >> mip) > maxSize)
+   {
+      ++mip;
+   }
+
+   return mip;
+}
+
+VkDeviceSize
+Texture::GetMemorySize(uint32_t firstMip) const
+{
+   // RGBA8, mip sizes match the ones of CookTexture
+   VkDeviceSize size = 0;
+   for (auto mip = firstMip; mip < m_mips; ++mip)
+   {
+      size += VkDeviceSize{std::max(m_width >> mip, 1U)} * std::max(m_height >> mip, 1U) * 4;
+   }
+
+   return size;
+}
+
 void
 Texture::CreateTextureSampler()
 {
@@ -396,7 +612,7 @@ void
 Texture::TransitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
                                uint32_t mipLevels, bool cubemap)
 {
-   VkCommandBuffer commandBuffer = Command::BeginSingleTimeCommands();
+   VkCommandBuffer commandBuffer = Command::GetUploadCommandBuffer();
 
    VkImageMemoryBarrier barrier = {};
    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -438,8 +654,6 @@ Texture::TransitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLa
 
    vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1,
                         &barrier);
-
-   Command::EndSingleTimeCommands(commandBuffer);
 }
 
 /**************************************************************************************************
@@ -448,17 +662,35 @@ Texture::TransitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLa
 const Texture*
 TextureLibrary::GetTexture(TextureType type, const std::string& textureName)
 {
-   if (s_loadedTextures.find(textureName) == s_loadedTextures.end())
+   return GetTexture(type, utils::StringInterner::Intern(textureName));
+}
+
+const Texture*
+TextureLibrary::GetTexture(const std::string& textureName)
+{
+   return GetTexture(TextureType::DIFFUSE_MAP, textureName);
+}
+
+const Texture*
+TextureLibrary::GetTexture(TextureType type, utils::StringID textureName)
+{
+   // Lookup of already loaded texture doesn't modify the library,
+   // so it's safe to call it from multiple threads
+   const auto texture = s_loadedTextures.find(textureName);
+   if (texture != s_loadedTextures.end())
    {
-      SCOPED_TIMER(fmt::format("Texture: {} not found in library. Loading it", textureName));
-      LoadTexture(type, textureName);
+      return &texture->second;
    }
 
-   return &s_loadedTextures[textureName];
+   SCOPED_TIMER(fmt::format("Texture: {} not found in library. Loading it",
+                            utils::StringInterner::GetString(textureName)));
+   LoadTexture(type, textureName);
+
+   return &s_loadedTextures.at(textureName);
 }
 
 const Texture*
-TextureLibrary::GetTexture(const std::string& textureName)
+TextureLibrary::GetTexture(utils::StringID textureName)
 {
    return GetTexture(TextureType::DIFFUSE_MAP, textureName);
 }
@@ -466,81 +698,454 @@ TextureLibrary::GetTexture(const std::string& textureName)
 Texture*
 TextureLibrary::GetTexture(const TextureID id)
 {
-   for (auto& texture : s_loadedTextures)
+   const auto idx = static_cast< size_t >(id);
+   if (idx >= s_texturesByID.size() or s_texturesByID[idx] == nullptr)
    {
-      if (texture.second.GetID() == id)
-      {
-         return &texture.second;
-      }
+      utils::Assert(false, fmt::format("TextureLibrary::GetTexture (With TextureID = {}) failed! "
+                                       "Requested texture ID is not present!\n",
+                                       id));
    }
 
-   utils::Assert(true, fmt::format("TextureLibrary::GetTexture (With TextureID = {}) failed! "
-                                   "Requested texture ID is not present!\n",
-                                   id));
-
-   return nullptr;
+   return s_texturesByID[idx];
 }
 
 const Texture*
 TextureLibrary::CreateTexture(TextureType type, const std::string& textureName,
                               const TextureProperties& props)
 {
-   if (s_loadedTextures.find(textureName) == s_loadedTextures.end())
+   const auto nameID = utils::StringInterner::Intern(textureName);
+   if (!s_loadedTextures.contains(nameID))
    {
       SCOPED_TIMER(fmt::format("Creating texture {}", textureName));
-      LoadTexture(type, textureName, props);
+      LoadTexture(type, nameID, props);
    }
    else
    {
       Logger::Debug("Texture {} already loaded!", textureName);
    }
 
-   return &s_loadedTextures.at(textureName);
+   return &s_loadedTextures.at(nameID);
 }
 
 const Texture*
 TextureLibrary::CreateTexture(TextureType type, const std::string& textureName,
                               const FileManager::ImageData& data, const TextureProperties& props)
 {
-   if (s_loadedTextures.find(textureName) == s_loadedTextures.end())
+   const auto nameID = utils::StringInterner::Intern(textureName);
+   if (!s_loadedTextures.contains(nameID))
    {
       SCOPED_TIMER(fmt::format("Creating texture {}", textureName));
-      LoadTexture(type, textureName, data, props);
+      LoadTexture(type, nameID, data, props);
    }
    else
    {
       Logger::Debug("Texture {} already loaded!", textureName);
    }
 
-   return &s_loadedTextures.at(textureName);
+   return &s_loadedTextures.at(nameID);
+}
+
+const Texture*
+TextureLibrary::CreateTexture(TextureType type, const std::string& textureName,
+                              const CookedTexture& cooked, const TextureProperties& props)
+{
+   const auto nameID = utils::StringInterner::Intern(textureName);
+   if (!s_loadedTextures.contains(nameID))
+   {
+      SCOPED_TIMER(fmt::format("Creating texture {}", textureName));
+      LoadTexture(type, nameID, cooked, props);
+   }
+   else
+   {
+      Logger::Debug("Texture {} already loaded!", textureName);
+   }
+
+   return &s_loadedTextures.at(nameID);
+}
+
+void
+TextureLibrary::PrefetchTextures(ThreadPool& threadPool,
+                                 std::span< const std::string > textureNames, TextureType type,
+                                 const TextureProperties& props)
+{
+   const auto* placeholder = GetTexture(PLACEHOLDER_TEXTURE_ID);
+   const auto srgb = type == TextureType::DIFFUSE_MAP;
+
+   for (const auto& textureName : textureNames)
+   {
+      const auto nameID = utils::StringInterner::Intern(textureName);
+      if (s_loadedTextures.contains(nameID))
+      {
+         continue;
+      }
+
+      // ID (index in the descriptor array) is valid right away, it samples the placeholder
+      // until the texture is uploaded
+      const auto& texture = AddTexture(
+         nameID, Texture::CreatePending(type, textureName, currentID_++, props), true);
+      SetDescriptor(texture.GetID(), placeholder->GetImageViewAndSampler());
+
+      pendingTextures_.push_back(
+         {nameID, type, props, threadPool.enqueue([textureName, srgb] {
+             return CookedTexture::Load(textureName, srgb);
+          })});
+   }
+}
+
+void
+TextureLibrary::PrefetchAtlasTextures(ThreadPool& threadPool,
+                                      std::span< const std::string > textureNames)
+{
+   // Placeholder is referenced by its ID (e.g. as sprite's mask), so it's never packed
+   const auto* placeholder = GetTexture(PLACEHOLDER_TEXTURE_ID);
+
+   std::vector< std::string > texturesToLoad = {};
+   stl::copy_if(textureNames, std::back_inserter(texturesToLoad), [](const auto& texture) {
+      return !s_loadedTextures.contains(utils::StringInterner::Intern(texture));
+   });
+
+   // Only image headers are read here
+   std::vector< glm::ivec2 > sizes(texturesToLoad.size());
+   threadPool.ParallelFor(texturesToLoad.size(), 16,
+                          [&texturesToLoad, &sizes](size_t begin, size_t end) {
+                             for (auto i = begin; i < end; ++i)
+                             {
+                                sizes[i] = FileManager::GetImageSize(texturesToLoad[i]);
+                             }
+                          });
+
+   std::vector< std::string > largeTextures = {};
+   std::vector< AtlasImage > smallTextures = {};
+   for (size_t i = 0; i < texturesToLoad.size(); ++i)
+   {
+      if (std::max(sizes[i].x, sizes[i].y) <= ATLAS_MAX_IMAGE_SIZE)
+      {
+         smallTextures.push_back({texturesToLoad[i], sizes[i]});
+      }
+      else
+      {
+         largeTextures.push_back(texturesToLoad[i]);
+      }
+   }
+
+   PrefetchTextures(threadPool, largeTextures);
+
+   if (smallTextures.empty())
+   {
+      return;
+   }
+
+   const auto layout = std::make_shared< const AtlasLayout >(PackAtlas(smallTextures));
+   Logger::Info("TextureLibrary: Packed {} textures into {} atlas pages", smallTextures.size(),
+                layout->numPages);
+
+   std::vector< const Texture* > pages = {};
+   for (uint32_t page = 0; page < layout->numPages; ++page)
+   {
+      const auto pageName = fmt::format("atlas_page_{}", numAtlasPages_++);
+      const auto pageID = utils::StringInterner::Intern(pageName);
+      pages.push_back(&AddTexture(
+         pageID, Texture::CreatePending(TextureType::DIFFUSE_MAP, pageName, currentID_++)));
+      SetDescriptor(pages.back()->GetID(), placeholder->GetImageViewAndSampler());
+
+      pendingTextures_.push_back({pageID, TextureType::DIFFUSE_MAP, {},
+                                  threadPool.enqueue([layout, page] {
+                                     return BuildAtlasPage(*layout, page, true);
+                                  })});
+   }
+
+   for (const auto& entry : layout->entries)
+   {
+      // Regions share the ID with their page, so they're not added to the ID lookup
+      s_loadedTextures[utils::StringInterner::Intern(entry.name)] = Texture::CreateAtlasRegion(
+         entry.name, *pages.at(entry.page), GetAtlasUVRect(entry, layout->pageSize));
+   }
+}
+
+size_t
+TextureLibrary::UploadLoadedTextures(bool wait)
+{
+   auto numUploaded = 0;
+
+   for (auto it = pendingTextures_.begin(); it != pendingTextures_.end();)
+   {
+      if (!wait and it->cooked.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      {
+         ++it;
+         continue;
+      }
+
+      auto& texture = s_loadedTextures.at(it->name);
+      const auto id = texture.GetID();
+      if (texture.IsLoaded())
+      {
+         // Reloaded by UpdateResidency, frames in flight can still sample the old image
+         RetireTexture(texture);
+      }
+
+      texture = Texture{it->type, utils::StringInterner::GetString(it->name), id,
+                        it->cooked.get(), it->props, it->firstMip};
+      SetDescriptor(id, texture.GetImageViewAndSampler());
+      residency_.at(static_cast< size_t >(id)).reloading = false;
+
+      it = pendingTextures_.erase(it);
+      ++numUploaded;
+   }
+
+   if (numUploaded > 0)
+   {
+      Logger::Debug("Uploaded {} prefetched textures, {} still loading", numUploaded,
+                    pendingTextures_.size());
+   }
+
+   return pendingTextures_.size();
+}
+
+void
+TextureLibrary::MarkUsed(TextureID id)
+{
+   const auto idx = static_cast< size_t >(id);
+   if (idx < residency_.size())
+   {
+      residency_[idx].lastUsedFrame = residencyFrame_;
+   }
+}
+
+void
+TextureLibrary::UpdateResidency(ThreadPool& threadPool)
+{
+   ++residencyFrame_;
+
+   // Descriptors of every frame stop referencing the retired image within MAX_FRAMES_IN_FLIGHT
+   // frames (see renderer::UpdateTextureDescriptor), and those frames finish within as many
+   VkDeviceSize retiredMemory = 0;
+   std::erase_if(retiredTextures_, [&retiredMemory](auto& retired) {
+      if (retired.frame + 2 * MAX_FRAMES_IN_FLIGHT > residencyFrame_)
+      {
+         retiredMemory += retired.texture.GetMemorySize();
+         return false;
+      }
+
+      // Uploads are submitted ahead of each frame, so any upload to it is finished by now
+      retired.texture.Destroy(false);
+      return true;
+   });
+
+   // Memory that evictions in flight will release
+   VkDeviceSize evictingMemory = 0;
+   for (const auto& pending : pendingTextures_)
+   {
+      if (pending.firstMip > 0)
+      {
+         const auto& texture = s_loadedTextures.at(pending.name);
+         evictingMemory += texture.GetMemorySize() - texture.GetMemorySize(pending.firstMip);
+      }
+   }
+
+   VkDeviceSize residentMemory = 0;
+   std::vector< const Texture* > evictable = {};
+   for (size_t idx = 0; idx < s_texturesByID.size(); ++idx)
+   {
+      const auto* texture = s_texturesByID[idx];
+      if (texture == nullptr)
+      {
+         continue;
+      }
+
+      residentMemory += texture->GetMemorySize();
+
+      const auto& residency = residency_[idx];
+      if (not residency.streamable or residency.reloading or not texture->IsLoaded())
+      {
+         continue;
+      }
+
+      if (residency.lastUsedFrame + 1 >= residencyFrame_)
+      {
+         // Sampled by the last frame
+         if (texture->GetResidentMip() > 0)
+         {
+            ReloadTexture(threadPool, *texture, 0);
+            ++Data::renderStats.numTexturesStreamedIn;
+         }
+      }
+      else if (texture->GetResidentMip() == 0
+               and residency.lastUsedFrame + MIN_UNUSED_FRAMES <= residencyFrame_
+               and texture->GetMipForSize(EVICTED_TEXTURE_SIZE) > 0)
+      {
+         evictable.push_back(texture);
+      }
+   }
+
+   const auto releasedMemory = evictingMemory + retiredMemory;
+   const auto projectedMemory = residentMemory - std::min(residentMemory, evictingMemory);
+   const auto heapsOverBudget = GetHeapsOverBudget();
+
+   auto overBudget = std::max(projectedMemory, memoryBudget_) - memoryBudget_;
+   overBudget = std::max(overBudget, heapsOverBudget - std::min(heapsOverBudget, releasedMemory));
+   if (overBudget == 0)
+   {
+      return;
+   }
+
+   // Least recently used first
+   stl::sort(evictable, {}, [](const Texture* texture) {
+      return residency_[static_cast< size_t >(texture->GetID())].lastUsedFrame;
+   });
+
+   uint32_t numEvicted = 0;
+   for (const auto* texture : evictable)
+   {
+      if (overBudget == 0)
+      {
+         break;
+      }
+
+      const auto evictedMip = texture->GetMipForSize(EVICTED_TEXTURE_SIZE);
+      const auto saved = texture->GetMemorySize() - texture->GetMemorySize(evictedMip);
+      ReloadTexture(threadPool, *texture, evictedMip);
+
+      overBudget -= std::min(overBudget, saved);
+      ++numEvicted;
+   }
+
+   Data::renderStats.numTexturesEvicted += numEvicted;
+   if (numEvicted > 0)
+   {
+      Logger::Debug("TextureLibrary: Evicting {} textures, {} KiB still over budget", numEvicted,
+                    overBudget / 1024);
+   }
+}
+
+void
+TextureLibrary::SetMemoryBudget(VkDeviceSize budget)
+{
+   memoryBudget_ = budget;
+}
+
+VkDeviceSize
+TextureLibrary::GetMemoryBudget()
+{
+   return memoryBudget_;
+}
+
+VkDeviceSize
+TextureLibrary::GetResidentMemory()
+{
+   VkDeviceSize residentMemory = 0;
+   for (const auto* texture : s_texturesByID)
+   {
+      if (texture != nullptr)
+      {
+         residentMemory += texture->GetMemorySize();
+      }
+   }
+
+   return residentMemory;
 }
 
 void
 TextureLibrary::Clear()
 {
    s_loadedTextures.clear();
+   s_texturesByID.clear();
+   pendingTextures_.clear();
+   residency_.clear();
+   retiredTextures_.clear();
 }
 
 void
-TextureLibrary::LoadTexture(TextureType type, std::string_view textureName,
-                            const TextureProperties& props)
+TextureLibrary::ReloadTexture(ThreadPool& threadPool, const Texture& texture, uint32_t firstMip)
+{
+   residency_.at(static_cast< size_t >(texture.GetID())).reloading = true;
+
+   const auto srgb = texture.GetType() == TextureType::DIFFUSE_MAP;
+   pendingTextures_.push_back({utils::StringInterner::Intern(texture.GetName()),
+                               texture.GetType(), texture.GetProperties(),
+                               threadPool.enqueue([textureName = texture.GetName(), srgb] {
+                                  return CookedTexture::Load(textureName, srgb);
+                               }),
+                               firstMip});
+}
+
+void
+TextureLibrary::RetireTexture(const Texture& texture)
+{
+   retiredTextures_.push_back({texture, residencyFrame_});
+}
+
+Texture&
+TextureLibrary::AddTexture(utils::StringID textureName, Texture&& texture, bool streamable)
+{
+   // Map nodes are never moved, so the pointers in the ID lookup stay valid
+   auto& tex = s_loadedTextures[textureName] = std::move(texture);
+
+   const auto idx = static_cast< size_t >(tex.GetID());
+   utils::Assert(idx < MAX_NUM_TEXTURES,
+                 fmt::format("TextureLibrary: Too many textures (max {})", MAX_NUM_TEXTURES));
+
+   if (idx >= s_texturesByID.size())
+   {
+      s_texturesByID.resize(idx + 1, nullptr);
+      residency_.resize(idx + 1);
+   }
+   s_texturesByID[idx] = &tex;
+   // New textures count as used, so they aren't evicted right away
+   residency_[idx] = {residencyFrame_, streamable, false};
+
+   return tex;
+}
+
+void
+TextureLibrary::SetDescriptor(TextureID id, const std::pair< VkImageView, VkSampler >& viewSampler)
 {
-   s_loadedTextures[std::string{textureName}] = {type, textureName, currentID_++, props};
-   const auto& tex = s_loadedTextures[std::string{textureName}];
-   viewSamplerPairs_.push_back(tex.GetImageViewAndSampler());
+   const auto idx = static_cast< size_t >(id);
+   if (idx >= viewSamplerPairs_.size())
+   {
+      viewSamplerPairs_.resize(idx + 1);
+      slotVersions_.resize(idx + 1);
+   }
+   viewSamplerPairs_[idx] = viewSampler;
+   ++slotVersions_[idx];
 
-   UpdateDescriptors();
+   // Only this slot of the texture array is written
+   UpdateTextureDescriptor(id);
 }
 
 void
-TextureLibrary::LoadTexture(TextureType type, std::string_view textureName,
+TextureLibrary::LoadTexture(TextureType type, utils::StringID textureName,
+                            const TextureProperties& props)
+{
+   const auto& tex = AddTexture(
+      textureName,
+      Texture{type, utils::StringInterner::GetString(textureName), currentID_++, props}, true);
+   SetDescriptor(tex.GetID(), tex.GetImageViewAndSampler());
+}
+
+void
+TextureLibrary::LoadTexture(TextureType type, utils::StringID textureName,
                             const FileManager::ImageData& data, const TextureProperties& props)
 {
-   s_loadedTextures[std::string{textureName}] = {type, textureName, currentID_++, data, props};
-   const auto& tex = s_loadedTextures[std::string{textureName}];
-   viewSamplerPairs_.push_back(tex.GetImageViewAndSampler());
+   const auto& tex = AddTexture(
+      textureName,
+      Texture{type, utils::StringInterner::GetString(textureName), currentID_++, data, props});
+   SetDescriptor(tex.GetID(), tex.GetImageViewAndSampler());
+}
 
-   UpdateDescriptors();
+void
+TextureLibrary::LoadTexture(TextureType type, utils::StringID textureName,
+                            const CookedTexture& cooked, const TextureProperties& props)
+{
+   const auto& tex = AddTexture(
+      textureName,
+      Texture{type, utils::StringInterner::GetString(textureName), currentID_++, cooked, props});
+   SetDescriptor(tex.GetID(), tex.GetImageViewAndSampler());
+}
+
+bool
+TextureLibrary::IsTextureLoaded(const std::string& textureName)
+{
+   return s_loadedTextures.contains(utils::StringInterner::Intern(textureName));
 }
 
 const std::vector< std::pair< VkImageView, VkSampler > >&
@@ -549,6 +1154,13 @@ TextureLibrary::GetViewSamplerPairs()
    return viewSamplerPairs_;
 }
 
+uint32_t
+TextureLibrary::GetSlotVersion(TextureID id)
+{
+   const auto idx = static_cast< size_t >(id);
+   return idx < slotVersions_.size() ? slotVersions_[idx] : 0;
+}
+
 uint32_t
 TextureLibrary::GetNumTextures()
 {
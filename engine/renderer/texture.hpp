@@ -2,14 +2,23 @@
 
 #include "file_manager.hpp"
 #include "texture.hpp"
+#include "texture_cache.hpp"
 #include "types.hpp"
+#include "utils/string_interner.hpp"
 
+#include <future>
+#include <span>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
+namespace looper {
+class ThreadPool;
+} // namespace looper
+
 namespace looper::renderer {
 
 struct TextureProperties
@@ -36,11 +45,31 @@ class Texture
            const TextureProperties& props = {});
    Texture(TextureType type, std::string_view textureName, TextureID id,
            const FileManager::ImageData& data, const TextureProperties& props = {});
+   // Image holds mips [firstMip, numMips) of the cooked texture (see TextureLibrary residency)
+   Texture(TextureType type, std::string_view textureName, TextureID id,
+           const CookedTexture& cooked, const TextureProperties& props = {},
+           uint32_t firstMip = 0);
 
    Texture() = default;
 
+   // Texture that only reserves its ID, image is created once it's loaded
+   // (see TextureLibrary::PrefetchTextures)
+   static Texture
+   CreatePending(TextureType type, std::string_view textureName, TextureID id,
+                 const TextureProperties& props = {});
+
+   // Texture that shares the image (and ID) of the atlas page, sprites sample its region
+   static Texture
+   CreateAtlasRegion(std::string_view textureName, const Texture& page, const glm::vec4& uvRect);
+
+   /**
+    * \brief Destroy the image, its view and sampler.
+    *
+    * \param[in] waitForUploads Wait for uploads in flight, which could still write the image.
+    *                           Can be skipped if the image wasn't uploaded to for a few frames.
+    */
    void
-   Destroy();
+   Destroy(bool waitForUploads = true);
 
    void
    UpdateTexture(const FileManager::ImageData& data) const;
@@ -97,10 +126,40 @@ class Texture
    [[nodiscard]] TextureID
    GetID() const;
 
+   // Whether the image is created (false while the texture is being prefetched)
+   [[nodiscard]] bool
+   IsLoaded() const;
+
+   [[nodiscard]] bool
+   IsAtlasRegion() const;
+
+   // Offset (xy) and scale (zw) of texture coordinates within the image
+   [[nodiscard]] const glm::vec4&
+   GetUVRect() const;
+
+   [[nodiscard]] const TextureProperties&
+   GetProperties() const;
+
+   // Mip of the full resolution texture that is the image's top level (0 unless it's evicted)
+   [[nodiscard]] uint32_t
+   GetResidentMip() const;
+
+   // First mip of the image that's at most maxSize in both dimensions (or the last one)
+   [[nodiscard]] uint32_t
+   GetMipForSize(uint32_t maxSize) const;
+
+   // Device memory taken by the image's mips [firstMip, numMips)
+   [[nodiscard]] VkDeviceSize
+   GetMemorySize(uint32_t firstMip = 0) const;
+
  private:
    void
    CreateTextureImage(const FileManager::ImageData& data);
 
+   // Uploads mips [firstMip, numMips) of the cooked texture, no mipmaps are generated on the GPU
+   void
+   CreateTextureImage(const CookedTexture& cooked, uint32_t firstMip);
+
  private:
    TextureID id_ = {};
    TextureType m_type = {};
@@ -112,18 +171,33 @@ class Texture
    uint32_t m_mips = {};
    uint32_t m_width = {};
    uint32_t m_height = {};
+   uint32_t residentMip_ = 0;
    std::string m_name = "default_texture_name";
+   glm::vec4 uvRect_ = FULL_UV_RECT;
+   bool atlasRegion_ = false;
 };
 
 class TextureLibrary
 {
  public:
+   // Sampled by textures that are still being prefetched
+   static constexpr std::string_view PLACEHOLDER_TEXTURE = "white.png";
+   static inline const utils::StringID PLACEHOLDER_TEXTURE_ID =
+      utils::StringInterner::Intern(PLACEHOLDER_TEXTURE);
+
    static const Texture*
    GetTexture(TextureType type, const std::string& textureName);
 
    static const Texture*
    GetTexture(const std::string& textureName);
 
+   // Same as the string versions, but skips hashing the name
+   static const Texture*
+   GetTexture(TextureType type, utils::StringID textureName);
+
+   static const Texture*
+   GetTexture(utils::StringID textureName);
+
    static Texture*
    GetTexture(const TextureID id);
 
@@ -135,9 +209,102 @@ class TextureLibrary
    CreateTexture(TextureType type, const std::string& textureName,
                  const FileManager::ImageData& data, const TextureProperties& props = {});
 
+   static const Texture*
+   CreateTexture(TextureType type, const std::string& textureName, const CookedTexture& cooked,
+                 const TextureProperties& props = {});
+
+   [[nodiscard]] static bool
+   IsTextureLoaded(const std::string& textureName);
+
+   /**
+    * \brief Start loading textures on the ThreadPool. Each texture gets its ID right away
+    * and samples the placeholder texture until it's uploaded (see \c UploadLoadedTextures).
+    * Textures that are already loaded (or being loaded) are skipped.
+    *
+    * \param[in] threadPool Pool that loads the textures
+    * \param[in] textureNames Textures to load
+    * \param[in] type Type of the textures
+    * \param[in] props Sampler properties of the textures
+    */
+   static void
+   PrefetchTextures(ThreadPool& threadPool, std::span< const std::string > textureNames,
+                    TextureType type = TextureType::DIFFUSE_MAP,
+                    const TextureProperties& props = {});
+
+   /**
+    * \brief Same as \c PrefetchTextures, but small diffuse textures (see ATLAS_MAX_IMAGE_SIZE)
+    * are packed into atlas pages, so they share texture slots. Each packed texture is a region
+    * of its page (see \c Texture::IsAtlasRegion), pages are built on the ThreadPool.
+    *
+    * \param[in] threadPool Pool that loads the textures
+    * \param[in] textureNames Textures to load
+    */
+   static void
+   PrefetchAtlasTextures(ThreadPool& threadPool, std::span< const std::string > textureNames);
+
+   /**
+    * \brief Upload prefetched textures that finished loading and swap them with the placeholder.
+    * Has to be called from the main thread.
+    *
+    * \param[in] wait Whether to wait for textures that are still loading
+    *
+    * \return Number of textures that are still loading
+    */
+   static size_t
+   UploadLoadedTextures(bool wait = false);
+
+   /**
+    * \brief Mark the texture as sampled by the frame that's being prepared
+    * (see \c UpdateResidency). Called by the renderer for every visible sprite.
+    *
+    * \param[in] id Texture to mark
+    */
+   static void
+   MarkUsed(TextureID id);
+
+   /**
+    * \brief Keep textures within the memory budget (see \c SetMemoryBudget). When it's exceeded
+    * (or VMA reports that device memory is over its budget), textures that weren't used for
+    * the longest time are evicted to their low resolution mips. Evicted textures that are used
+    * again are streamed back in full resolution. Both are reloaded from the texture cache on
+    * the ThreadPool and swapped in by \c UploadLoadedTextures.
+    * Only textures loaded from the cache by name can be evicted. Has to be called from the
+    * main thread, once per frame (before \c renderer::UpdateData).
+    *
+    * \param[in] threadPool Pool that reloads the textures
+    */
+   static void
+   UpdateResidency(ThreadPool& threadPool);
+
+   /**
+    * \brief Set the cap on device memory taken by textures
+    *
+    * \param[in] budget Memory budget in bytes
+    */
+   static void
+   SetMemoryBudget(VkDeviceSize budget);
+
+   [[nodiscard]] static VkDeviceSize
+   GetMemoryBudget();
+
+   // Device memory taken by all loaded textures
+   [[nodiscard]] static VkDeviceSize
+   GetResidentMemory();
+
    static const std::vector< std::pair< VkImageView, VkSampler > >&
    GetViewSamplerPairs();
 
+   /**
+    * \brief Get the version of texture's slot, it changes whenever the slot points at a new
+    * image view (e.g. texture was uploaded, evicted or streamed back)
+    *
+    * \param[in] id Texture ID
+    *
+    * \return Slot's version
+    */
+   [[nodiscard]] static uint32_t
+   GetSlotVersion(TextureID id);
+
    [[nodiscard]] static uint32_t
    GetNumTextures();
 
@@ -145,17 +312,79 @@ class TextureLibrary
    Clear();
 
  private:
+   // Stores the texture and adds it to the ID lookup. Streamable textures can be reloaded
+   // from the texture cache by their name (see UpdateResidency)
+   static Texture&
+   AddTexture(utils::StringID textureName, Texture&& texture, bool streamable = false);
+
+   // Load the texture again on the ThreadPool, with mips [firstMip, numMips)
+   static void
+   ReloadTexture(ThreadPool& threadPool, const Texture& texture, uint32_t firstMip);
+
+   // Image is destroyed once no frame in flight can sample it
    static void
-   LoadTexture(TextureType type, std::string_view textureName, const TextureProperties& props = {});
+   RetireTexture(const Texture& texture);
+
+   // Point texture's descriptor slot at the given view and sampler
+   static void
+   SetDescriptor(TextureID id, const std::pair< VkImageView, VkSampler >& viewSampler);
+
+   static void
+   LoadTexture(TextureType type, utils::StringID textureName,
+               const TextureProperties& props = {});
+
+   static void
+   LoadTexture(TextureType type, utils::StringID textureName, const FileManager::ImageData& data,
+               const TextureProperties& props = {});
 
    static void
-   LoadTexture(TextureType type, std::string_view textureName, const FileManager::ImageData& data,
+   LoadTexture(TextureType type, utils::StringID textureName, const CookedTexture& cooked,
                const TextureProperties& props = {});
 
  private:
-   static inline std::unordered_map< std::string, Texture > s_loadedTextures = {};
+   struct PendingTexture
+   {
+      utils::StringID name = {};
+      TextureType type = {};
+      TextureProperties props = {};
+      std::future< CookedTexture > cooked = {};
+      uint32_t firstMip = 0;
+   };
+
+   struct TextureResidency
+   {
+      uint64_t lastUsedFrame = 0;
+      bool streamable = false;
+      // Reload is in flight (see ReloadTexture)
+      bool reloading = false;
+   };
+
+   struct RetiredTexture
+   {
+      Texture texture = {};
+      uint64_t frame = 0;
+   };
+
+   // Default cap on texture memory (see SetMemoryBudget)
+   static constexpr VkDeviceSize DEFAULT_MEMORY_BUDGET = VkDeviceSize{1024} * 1024 * 1024;
+   // Evicted textures keep the mips that are at most this size
+   static constexpr uint32_t EVICTED_TEXTURE_SIZE = 64;
+   // Textures used in the last frames aren't evicted, so visible ones don't keep bouncing
+   static constexpr uint64_t MIN_UNUSED_FRAMES = 30;
+
+   static inline std::unordered_map< utils::StringID, Texture > s_loadedTextures = {};
+   // Indexed by TextureID, atlas regions aren't here as they share the ID with their page
+   static inline std::vector< Texture* > s_texturesByID = {};
+   static inline std::vector< PendingTexture > pendingTextures_ = {};
+   // Indexed by TextureID
+   static inline std::vector< TextureResidency > residency_ = {};
+   static inline std::vector< RetiredTexture > retiredTextures_ = {};
+   static inline uint64_t residencyFrame_ = 0;
+   static inline VkDeviceSize memoryBudget_ = DEFAULT_MEMORY_BUDGET;
    static inline std::vector< std::pair< VkImageView, VkSampler > > viewSamplerPairs_ = {};
+   static inline std::vector< uint32_t > slotVersions_ = {};
    static inline TextureID currentID_ = 0;
+   static inline uint32_t numAtlasPages_ = 0;
 };
 
 } // namespace looper::renderer
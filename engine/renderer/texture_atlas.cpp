@@ -0,0 +1,267 @@
+#include "texture_atlas.hpp"
+#include "logger/logger.hpp"
+#include "utils/assert.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace looper::renderer {
+
+namespace {
+
+constexpr size_t NUM_CHANNELS = 4;
+
+int32_t
+AlignUp(int32_t value, int32_t alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
+
+// Size of the atlas slot (image with its padding), keeps every slot aligned to ATLAS_PADDING
+glm::ivec2
+GetSlotSize(const glm::ivec2& imageSize)
+{
+   return {AlignUp(imageSize.x + 2 * ATLAS_PADDING, ATLAS_PADDING),
+           AlignUp(imageSize.y + 2 * ATLAS_PADDING, ATLAS_PADDING)};
+}
+
+// Copy the image into the page and extrude its border into the padding
+void
+BlitPadded(const uint8_t* image, const glm::ivec2& imageSize, uint8_t* page,
+           const glm::ivec2& pageSize, const glm::ivec2& position)
+{
+   const auto imageStride = static_cast< size_t >(imageSize.x) * NUM_CHANNELS;
+   const auto pageStride = static_cast< size_t >(pageSize.x) * NUM_CHANNELS;
+
+   for (int32_t y = -ATLAS_PADDING; y < imageSize.y + ATLAS_PADDING; ++y)
+   {
+      const auto srcY = static_cast< size_t >(std::clamp(y, 0, imageSize.y - 1));
+      const auto* srcRow = image + srcY * imageStride;
+      auto* dstRow = page + static_cast< size_t >(position.y + y) * pageStride
+                     + static_cast< size_t >(position.x) * NUM_CHANNELS;
+
+      std::memcpy(dstRow, srcRow, imageStride);
+
+      for (int32_t x = 1; x <= ATLAS_PADDING; ++x)
+      {
+         std::memcpy(dstRow - static_cast< size_t >(x) * NUM_CHANNELS, srcRow, NUM_CHANNELS);
+         std::memcpy(dstRow + imageStride + static_cast< size_t >(x - 1) * NUM_CHANNELS,
+                     srcRow + imageStride - NUM_CHANNELS, NUM_CHANNELS);
+      }
+   }
+}
+
+} // namespace
+
+/**************************************************************************************************
+ ***************************************** AtlasPacker ********************************************
+ *************************************************************************************************/
+AtlasPacker::AtlasPacker(const glm::ivec2& pageSize)
+   : pageSize_(pageSize), skyline_({SkylineNode{0, 0, pageSize.x}})
+{
+}
+
+std::optional< glm::ivec2 >
+AtlasPacker::Insert(const glm::ivec2& size)
+{
+   auto bestBottom = std::numeric_limits< int32_t >::max();
+   auto bestWidth = std::numeric_limits< int32_t >::max();
+   auto bestIdx = skyline_.size();
+
+   for (size_t i = 0; i < skyline_.size(); ++i)
+   {
+      const auto y = Fit(i, size);
+      if (y < 0)
+      {
+         continue;
+      }
+
+      // Bottom-left rule, ties are broken by the narrowest node
+      const auto bottom = y + size.y;
+      if (bottom < bestBottom or (bottom == bestBottom and skyline_[i].width < bestWidth))
+      {
+         bestBottom = bottom;
+         bestWidth = skyline_[i].width;
+         bestIdx = i;
+      }
+   }
+
+   if (bestIdx == skyline_.size())
+   {
+      return std::nullopt;
+   }
+
+   const glm::ivec2 position = {skyline_[bestIdx].x, bestBottom - size.y};
+   AddLevel(bestIdx, {position.x, bestBottom, size.x});
+
+   return position;
+}
+
+int32_t
+AtlasPacker::Fit(size_t nodeIdx, const glm::ivec2& size) const
+{
+   if (skyline_[nodeIdx].x + size.x > pageSize_.x)
+   {
+      return -1;
+   }
+
+   auto y = skyline_[nodeIdx].y;
+   auto widthLeft = size.x;
+
+   for (auto i = nodeIdx; widthLeft > 0; ++i)
+   {
+      y = std::max(y, skyline_[i].y);
+      if (y + size.y > pageSize_.y)
+      {
+         return -1;
+      }
+
+      widthLeft -= skyline_[i].width;
+   }
+
+   return y;
+}
+
+void
+AtlasPacker::AddLevel(size_t nodeIdx, const SkylineNode& node)
+{
+   skyline_.insert(skyline_.begin() + static_cast< std::ptrdiff_t >(nodeIdx), node);
+
+   // Shrink (or remove) nodes covered by the new one
+   for (auto i = nodeIdx + 1; i < skyline_.size();)
+   {
+      const auto& previous = skyline_[i - 1];
+      auto& current = skyline_[i];
+      const auto overlap = previous.x + previous.width - current.x;
+
+      if (overlap <= 0)
+      {
+         break;
+      }
+
+      current.x += overlap;
+      current.width -= overlap;
+
+      if (current.width > 0)
+      {
+         break;
+      }
+
+      skyline_.erase(skyline_.begin() + static_cast< std::ptrdiff_t >(i));
+   }
+
+   // Merge neighbouring nodes at the same height
+   for (size_t i = 0; i + 1 < skyline_.size();)
+   {
+      if (skyline_[i].y == skyline_[i + 1].y)
+      {
+         skyline_[i].width += skyline_[i + 1].width;
+         skyline_.erase(skyline_.begin() + static_cast< std::ptrdiff_t >(i + 1));
+      }
+      else
+      {
+         ++i;
+      }
+   }
+}
+
+/**************************************************************************************************
+ ****************************************** Functions *********************************************
+ *************************************************************************************************/
+AtlasLayout
+PackAtlas(std::span< const AtlasImage > images, const glm::ivec2& pageSize)
+{
+   AtlasLayout layout = {pageSize, 0, std::vector< AtlasEntry >(images.size())};
+
+   // Tallest images first, that's where the skyline wastes the least space
+   std::vector< size_t > order(images.size());
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(), [images](const auto left, const auto right) {
+      return images[left].size.y > images[right].size.y
+             or (images[left].size.y == images[right].size.y
+                 and images[left].size.x > images[right].size.x);
+   });
+
+   std::vector< AtlasPacker > pages = {};
+
+   for (const auto idx : order)
+   {
+      const auto& image = images[idx];
+      const auto slotSize = GetSlotSize(image.size);
+      utils::Assert(slotSize.x <= pageSize.x and slotSize.y <= pageSize.y,
+                    fmt::format("Image {} doesn't fit into the atlas page!", image.name));
+
+      std::optional< glm::ivec2 > slot = std::nullopt;
+      uint32_t page = 0;
+      for (; page < pages.size(); ++page)
+      {
+         slot = pages[page].Insert(slotSize);
+         if (slot)
+         {
+            break;
+         }
+      }
+
+      // Doesn't fit into any of the pages, open a new one
+      if (!slot)
+      {
+         slot = pages.emplace_back(pageSize).Insert(slotSize);
+      }
+
+      layout.entries[idx] = {image.name, page, *slot + glm::ivec2{ATLAS_PADDING, ATLAS_PADDING},
+                             image.size};
+   }
+
+   layout.numPages = static_cast< uint32_t >(pages.size());
+
+   return layout;
+}
+
+glm::vec4
+GetAtlasUVRect(const AtlasEntry& entry, const glm::ivec2& pageSize)
+{
+   const auto page = glm::vec2(pageSize);
+   return {glm::vec2(entry.position) / page, glm::vec2(entry.size) / page};
+}
+
+CookedTexture
+BuildAtlasPage(const AtlasLayout& layout, uint32_t page, bool srgb)
+{
+   const auto numBytes = static_cast< size_t >(layout.pageSize.x)
+                         * static_cast< size_t >(layout.pageSize.y) * NUM_CHANNELS;
+
+   FileManager::ImageData pageImage = {
+      // NOLINTNEXTLINE
+      FileManager::ImageHandleType(new uint8_t[numBytes](), [](uint8_t* ptr) { delete[] ptr; }),
+      layout.pageSize, static_cast< int32_t >(NUM_CHANNELS)};
+
+   for (const auto& entry : layout.entries)
+   {
+      if (entry.page != page)
+      {
+         continue;
+      }
+
+      // Only the first mip of the (cached) image is used, page's mips are generated below
+      const auto image = CookedTexture::Load(entry.name, srgb);
+      if (image.GetSize() != entry.size)
+      {
+         Logger::Warn("Atlas: {} changed its size while building the atlas, skipping it!",
+                      entry.name);
+         continue;
+      }
+
+      // NOLINTNEXTLINE
+      const auto* pixels = reinterpret_cast< const uint8_t* >(image.GetPixels().data());
+      BlitPadded(pixels, entry.size, pageImage.m_bytes.get(), layout.pageSize, entry.position);
+   }
+
+   // Atlas pages are built from cooked images, so they aren't cached themselves
+   return CookedTexture::FromData(CookTexture(pageImage, 0, srgb, ATLAS_NUM_MIPS));
+}
+
+} // namespace looper::renderer
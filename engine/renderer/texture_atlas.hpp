@@ -0,0 +1,120 @@
+#pragma once
+
+#include "texture_cache.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace looper::renderer {
+
+/*
+ * Small sprite images are packed into atlas pages, so that they share a single texture slot
+ * (see MAX_NUM_TEXTURES). Each image is surrounded by ATLAS_PADDING pixels of its extruded
+ * border and placed at a multiple of ATLAS_PADDING, so that the first ATLAS_NUM_MIPS mip levels
+ * of the page don't bleed neighbouring images into each other.
+ */
+constexpr glm::ivec2 ATLAS_PAGE_SIZE = {2048, 2048};
+constexpr int32_t ATLAS_MAX_IMAGE_SIZE = 256;
+constexpr int32_t ATLAS_PADDING = 4;
+constexpr uint32_t ATLAS_NUM_MIPS = 3;
+
+/**
+ * \brief Skyline (bottom-left) rectangle packer for a single atlas page
+ */
+class AtlasPacker
+{
+ public:
+   explicit AtlasPacker(const glm::ivec2& pageSize);
+
+   /**
+    * \brief Find space for the rectangle and reserve it
+    *
+    * \param[in] size Size of the rectangle
+    *
+    * \return Position of the rectangle, or empty if it doesn't fit
+    */
+   [[nodiscard]] std::optional< glm::ivec2 >
+   Insert(const glm::ivec2& size);
+
+ private:
+   struct SkylineNode
+   {
+      int32_t x = 0;
+      int32_t y = 0;
+      int32_t width = 0;
+   };
+
+   // Returns height at which the rectangle fits, starting at the given node (or -1)
+   [[nodiscard]] int32_t
+   Fit(size_t nodeIdx, const glm::ivec2& size) const;
+
+   void
+   AddLevel(size_t nodeIdx, const SkylineNode& node);
+
+   glm::ivec2 pageSize_ = {};
+   std::vector< SkylineNode > skyline_ = {};
+};
+
+struct AtlasImage
+{
+   std::string name = {};
+   glm::ivec2 size = {};
+};
+
+struct AtlasEntry
+{
+   std::string name = {};
+   uint32_t page = 0;
+   // Position and size of the image itself (without padding) in the page
+   glm::ivec2 position = {};
+   glm::ivec2 size = {};
+};
+
+struct AtlasLayout
+{
+   glm::ivec2 pageSize = {};
+   uint32_t numPages = 0;
+   std::vector< AtlasEntry > entries = {};
+};
+
+/**
+ * \brief Pack images into as few atlas pages as possible
+ *
+ * \param[in] images Images to pack, each one has to fit into the page (see ATLAS_MAX_IMAGE_SIZE)
+ * \param[in] pageSize Size of the atlas page
+ *
+ * \return Layout of the atlas, entries are in the same order as \c images
+ */
+[[nodiscard]] AtlasLayout
+PackAtlas(std::span< const AtlasImage > images, const glm::ivec2& pageSize = ATLAS_PAGE_SIZE);
+
+/**
+ * \brief Get texture coordinates of the entry within its page
+ *
+ * \param[in] entry Atlas entry
+ * \param[in] pageSize Size of the atlas page
+ *
+ * \return Offset (xy) and scale (zw) of texture coordinates
+ */
+[[nodiscard]] glm::vec4
+GetAtlasUVRect(const AtlasEntry& entry, const glm::ivec2& pageSize);
+
+/**
+ * \brief Compose the atlas page from (cooked) images and generate its mips.
+ * Doesn't require the renderer, so it can be called from worker threads.
+ *
+ * \param[in] layout Atlas layout
+ * \param[in] page Page to build
+ * \param[in] srgb Whether the images hold sRGB colors
+ *
+ * \return Cooked atlas page
+ */
+[[nodiscard]] CookedTexture
+BuildAtlasPage(const AtlasLayout& layout, uint32_t page, bool srgb);
+
+} // namespace looper::renderer
@@ -0,0 +1,340 @@
+#include "texture_cache.hpp"
+#include "logger/logger.hpp"
+#include "utils/asset_archive.hpp"
+#include "utils/assert.hpp"
+#include "utils/hash.hpp"
+#include "utils/time/scoped_timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace looper::renderer {
+
+static_assert(std::is_trivially_copyable_v< CookedTextureHeader >);
+static_assert(std::is_trivially_copyable_v< CookedMipRecord >);
+static_assert(sizeof(CookedTextureHeader) % 8 == 0);
+
+namespace {
+
+// Staging buffer offsets of RGBA8 mips have to be a multiple of 4, keep them SIMD friendly too
+constexpr size_t SECTION_ALIGNMENT = 16;
+constexpr size_t NUM_CHANNELS = 4;
+constexpr size_t LINEAR_TO_SRGB_STEPS = 4096;
+
+size_t
+AlignOffset(size_t offset)
+{
+   return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+size_t
+GetNumBytes(const glm::ivec2& size)
+{
+   return static_cast< size_t >(size.x) * static_cast< size_t >(size.y) * NUM_CHANNELS;
+}
+
+const std::array< float, 256 >&
+GetSrgbToLinearTable()
+{
+   static const auto table = [] {
+      std::array< float, 256 > ret = {};
+      for (size_t i = 0; i < ret.size(); ++i)
+      {
+         const auto value = static_cast< float >(i) / 255.0f;
+         ret[i] = value <= 0.04045f ? value / 12.92f
+                                    : std::pow((value + 0.055f) / 1.055f, 2.4f);
+      }
+      return ret;
+   }();
+
+   return table;
+}
+
+const std::array< uint8_t, LINEAR_TO_SRGB_STEPS >&
+GetLinearToSrgbTable()
+{
+   static const auto table = [] {
+      std::array< uint8_t, LINEAR_TO_SRGB_STEPS > ret = {};
+      for (size_t i = 0; i < ret.size(); ++i)
+      {
+         const auto value = static_cast< float >(i) / static_cast< float >(ret.size() - 1);
+         const auto srgb = value <= 0.0031308f ? value * 12.92f
+                                               : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+         ret[i] = static_cast< uint8_t >(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+      }
+      return ret;
+   }();
+
+   return table;
+}
+
+/*
+ * 2x2 box filter, same footprint as the linear blit used by Texture::GenerateMipmaps.
+ * Rows are processed as flat byte arrays, so that the compiler can auto-vectorize it.
+ */
+void
+DownsampleLinear(const uint8_t* src, const glm::ivec2& srcSize, uint8_t* dst,
+                 const glm::ivec2& dstSize)
+{
+   const auto srcStride = static_cast< size_t >(srcSize.x) * NUM_CHANNELS;
+   const auto stepX = srcSize.x > 1 ? NUM_CHANNELS : 0;
+   const auto stepY = srcSize.y > 1 ? srcStride : 0;
+   const auto dstStride = static_cast< size_t >(dstSize.x) * NUM_CHANNELS;
+
+   for (int32_t y = 0; y < dstSize.y; ++y)
+   {
+      const auto* row0 = src + static_cast< size_t >(y) * 2 * stepY;
+      const auto* row1 = row0 + stepY;
+      auto* dstRow = dst + static_cast< size_t >(y) * dstStride;
+
+      for (size_t x = 0; x < dstStride; ++x)
+      {
+         const auto srcIdx = (x / NUM_CHANNELS) * 2 * stepX + x % NUM_CHANNELS;
+         const auto sum = static_cast< uint32_t >(row0[srcIdx]) + row0[srcIdx + stepX]
+                          + row1[srcIdx] + row1[srcIdx + stepX];
+         dstRow[x] = static_cast< uint8_t >((sum + 2) / 4);
+      }
+   }
+}
+
+void
+DownsampleSrgb(const uint8_t* src, const glm::ivec2& srcSize, uint8_t* dst,
+               const glm::ivec2& dstSize)
+{
+   const auto& toLinear = GetSrgbToLinearTable();
+   const auto& toSrgb = GetLinearToSrgbTable();
+   constexpr auto maxIdx = static_cast< float >(LINEAR_TO_SRGB_STEPS - 1);
+
+   const auto srcStride = static_cast< size_t >(srcSize.x) * NUM_CHANNELS;
+   const auto stepX = srcSize.x > 1 ? NUM_CHANNELS : 0;
+   const auto stepY = srcSize.y > 1 ? srcStride : 0;
+   const auto dstStride = static_cast< size_t >(dstSize.x) * NUM_CHANNELS;
+
+   for (int32_t y = 0; y < dstSize.y; ++y)
+   {
+      const auto* row0 = src + static_cast< size_t >(y) * 2 * stepY;
+      const auto* row1 = row0 + stepY;
+      auto* dstPixel = dst + static_cast< size_t >(y) * dstStride;
+
+      for (int32_t x = 0; x < dstSize.x; ++x, dstPixel += NUM_CHANNELS)
+      {
+         const auto* p0 = row0 + static_cast< size_t >(x) * 2 * stepX;
+         const auto* p1 = row1 + static_cast< size_t >(x) * 2 * stepX;
+
+         for (size_t c = 0; c < 3; ++c)
+         {
+            const auto linear = (toLinear[p0[c]] + toLinear[p0[c + stepX]] + toLinear[p1[c]]
+                                 + toLinear[p1[c + stepX]])
+                                * 0.25f;
+            dstPixel[c] = toSrgb[static_cast< size_t >(linear * maxIdx + 0.5f)];
+         }
+
+         // Alpha is stored linearly
+         const auto alpha =
+            static_cast< uint32_t >(p0[3]) + p0[3 + stepX] + p1[3] + p1[3 + stepX];
+         dstPixel[3] = static_cast< uint8_t >((alpha + 2) / 4);
+      }
+   }
+}
+
+} // namespace
+
+/**************************************************************************************************
+ **************************************** CookedTexture *******************************************
+ *************************************************************************************************/
+CookedTexture
+CookedTexture::Load(std::string_view textureName, bool srgb)
+{
+   const auto pathToImage = IMAGES_DIR / textureName;
+   const auto sourceHash = ComputeTextureSourceHash(pathToImage);
+   const auto cookedPath = GetCookedTexturePath(textureName);
+
+   CookedTexture texture = {};
+
+   std::error_code errorCode;
+   const auto fileSize = std::filesystem::file_size(cookedPath, errorCode);
+   if (!errorCode and fileSize >= sizeof(CookedTextureHeader))
+   {
+      texture.mappedFile_ = std::make_unique< MappedFile >(cookedPath);
+      if (texture.SetData(texture.mappedFile_->GetData())
+          and texture.header_->sourceHash == sourceHash
+          and texture.header_->srgb == static_cast< uint32_t >(srgb))
+      {
+         return texture;
+      }
+
+      texture.header_ = nullptr;
+      texture.mappedFile_.reset();
+   }
+
+   SCOPED_TIMER(fmt::format("Cooking texture {}", textureName));
+
+   const auto image = FileManager::LoadImageData(textureName);
+   texture.cookedData_ = CookTexture(image, sourceHash, srgb);
+   texture.SetData(texture.cookedData_);
+
+   std::filesystem::create_directories(cookedPath.parent_path(), errorCode);
+   if (!FileManager::SaveBinaryFileAtomic(cookedPath.string(), texture.cookedData_))
+   {
+      Logger::Warn("Cooked texture couldn't be saved to {}!", cookedPath.string());
+   }
+
+   return texture;
+}
+
+CookedTexture
+CookedTexture::FromData(std::vector< std::byte > cookedData)
+{
+   CookedTexture texture = {};
+   texture.cookedData_ = std::move(cookedData);
+   utils::Assert(texture.SetData(texture.cookedData_), "Invalid cooked texture data!");
+
+   return texture;
+}
+
+bool
+CookedTexture::SetData(std::span< const std::byte > data)
+{
+   if (data.size() < sizeof(CookedTextureHeader))
+   {
+      return false;
+   }
+
+   // NOLINTNEXTLINE
+   const auto* header = reinterpret_cast< const CookedTextureHeader* >(data.data());
+
+   const auto valid =
+      header->magic == COOKED_TEXTURE_MAGIC and header->version == COOKED_TEXTURE_VERSION
+      and header->numMips > 0
+      and header->mipsOffset + header->numMips * sizeof(CookedMipRecord) <= data.size()
+      and header->pixelsOffset + header->pixelsSize <= data.size();
+
+   if (!valid)
+   {
+      return false;
+   }
+
+   header_ = header;
+   data_ = data;
+
+   return true;
+}
+
+bool
+CookedTexture::IsValid() const
+{
+   return header_ != nullptr;
+}
+
+glm::ivec2
+CookedTexture::GetSize() const
+{
+   return header_->size;
+}
+
+uint32_t
+CookedTexture::GetNumMips() const
+{
+   return header_->numMips;
+}
+
+std::span< const CookedMipRecord >
+CookedTexture::GetMips() const
+{
+   // NOLINTNEXTLINE
+   return {reinterpret_cast< const CookedMipRecord* >(data_.data() + header_->mipsOffset),
+           header_->numMips};
+}
+
+std::span< const std::byte >
+CookedTexture::GetPixels() const
+{
+   return data_.subspan(header_->pixelsOffset, header_->pixelsSize);
+}
+
+/**************************************************************************************************
+ ****************************************** Functions *********************************************
+ *************************************************************************************************/
+std::filesystem::path
+GetCookedTexturePath(std::string_view textureName)
+{
+   auto cookedPath = TEXTURE_CACHE_DIR / textureName;
+   cookedPath += COOKED_TEXTURE_EXTENSION;
+
+   return cookedPath;
+}
+
+uint64_t
+ComputeTextureSourceHash(const std::filesystem::path& pathToImage)
+{
+   utils::Assert(AssetArchive::Find(pathToImage) or std::filesystem::exists(pathToImage),
+                 fmt::format("Texture {} doesn't exist!", pathToImage.string()));
+
+   const auto image = FileManager::MapFile(pathToImage);
+   return utils::HashBytes(image.GetData());
+}
+
+std::vector< std::byte >
+CookTexture(const FileManager::ImageData& image, uint64_t sourceHash, bool srgb, uint32_t maxMips)
+{
+   // Same mip count as Texture::CreateTextureImage
+   const auto numMips = std::min(
+      static_cast< uint32_t >(std::floor(std::log2(std::max(image.m_size.x, image.m_size.y)))) + 1,
+      std::max(maxMips, 1U));
+
+   std::vector< CookedMipRecord > mips(numMips);
+   auto mipSize = image.m_size;
+   uint64_t pixelsSize = 0;
+   for (auto& mip : mips)
+   {
+      mip.size = mipSize;
+      mip.offset = AlignOffset(pixelsSize);
+      mip.numBytes = GetNumBytes(mipSize);
+      pixelsSize = mip.offset + mip.numBytes;
+
+      mipSize = glm::max(mipSize / 2, glm::ivec2{1, 1});
+   }
+
+   CookedTextureHeader header = {};
+   header.sourceHash = sourceHash;
+   header.size = image.m_size;
+   header.numMips = numMips;
+   header.srgb = static_cast< uint32_t >(srgb);
+   header.mipsOffset = AlignOffset(sizeof(CookedTextureHeader));
+   header.pixelsOffset = AlignOffset(header.mipsOffset + mips.size() * sizeof(CookedMipRecord));
+   header.pixelsSize = pixelsSize;
+
+   std::vector< std::byte > buffer(header.pixelsOffset + header.pixelsSize);
+   std::memcpy(buffer.data(), &header, sizeof(CookedTextureHeader));
+   std::memcpy(buffer.data() + header.mipsOffset, mips.data(),
+               mips.size() * sizeof(CookedMipRecord));
+
+   // NOLINTNEXTLINE
+   auto* pixels = reinterpret_cast< uint8_t* >(buffer.data() + header.pixelsOffset);
+   std::memcpy(pixels, image.m_bytes.get(), mips.front().numBytes);
+
+   for (size_t i = 1; i < mips.size(); ++i)
+   {
+      const auto& src = mips[i - 1];
+      const auto& dst = mips[i];
+
+      if (srgb)
+      {
+         DownsampleSrgb(pixels + src.offset, src.size, pixels + dst.offset, dst.size);
+      }
+      else
+      {
+         DownsampleLinear(pixels + src.offset, src.size, pixels + dst.offset, dst.size);
+      }
+   }
+
+   return buffer;
+}
+
+} // namespace looper::renderer
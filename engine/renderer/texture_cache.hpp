@@ -0,0 +1,145 @@
+#pragma once
+
+#include "utils/file_manager.hpp"
+#include "utils/mapped_file.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace looper::renderer {
+
+/*
+ * Cooked texture (.dgtex) is a texture with its whole mip chain already generated, stored in
+ * TEXTURE_CACHE_DIR. It's keyed by the hash of the source image file, so whenever the source
+ * changes, it's cooked again. Warm loads only map the cooked file and copy it to the staging
+ * buffer, without decoding the image or generating mipmaps on the GPU.
+ *
+ * Layout (all sections are 16-byte aligned, little endian):
+ * [CookedTextureHeader][CookedMipRecord * numMips][RGBA8 pixels of all mips]
+ *
+ * Mip sizes match the ones used by Texture::GenerateMipmaps (each level is half of the previous
+ * one, rounded down, but at least 1). Mips of sRGB textures are filtered in linear space.
+ */
+constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58544744; // "DGTX"
+constexpr uint32_t COOKED_TEXTURE_VERSION = 1;
+constexpr std::string_view COOKED_TEXTURE_EXTENSION = ".dgtex";
+
+struct CookedTextureHeader
+{
+   uint32_t magic = COOKED_TEXTURE_MAGIC;
+   uint32_t version = COOKED_TEXTURE_VERSION;
+   uint64_t sourceHash = 0;
+
+   glm::ivec2 size = {};
+   uint32_t numMips = 0;
+   uint32_t srgb = 0;
+
+   uint64_t mipsOffset = 0;
+   uint64_t pixelsOffset = 0;
+   uint64_t pixelsSize = 0;
+};
+
+struct CookedMipRecord
+{
+   glm::ivec2 size = {};
+   // Relative to the beginning of the pixels section
+   uint64_t offset = 0;
+   uint64_t numBytes = 0;
+};
+
+/**
+ * \brief Cooked texture, either mapped from the cache or (if it couldn't be saved) held in memory
+ */
+class CookedTexture
+{
+ public:
+   CookedTexture() = default;
+
+   /**
+    * \brief Load the texture from the cache. If it's missing or out of date,
+    * the source image is decoded, cooked and saved to the cache.
+    * Doesn't require the renderer, so it can be called from worker threads.
+    *
+    * \param[in] textureName Name of the image (relative to IMAGES_DIR)
+    * \param[in] srgb Whether the texture holds sRGB colors
+    *
+    * \return Cooked texture
+    */
+   static CookedTexture
+   Load(std::string_view textureName, bool srgb);
+
+   /**
+    * \brief Wrap cooked texture data that isn't stored in the cache (see \c CookTexture)
+    *
+    * \param[in] cookedData Cooked texture data
+    *
+    * \return Cooked texture
+    */
+   static CookedTexture
+   FromData(std::vector< std::byte > cookedData);
+
+   [[nodiscard]] bool
+   IsValid() const;
+
+   [[nodiscard]] glm::ivec2
+   GetSize() const;
+
+   [[nodiscard]] uint32_t
+   GetNumMips() const;
+
+   [[nodiscard]] std::span< const CookedMipRecord >
+   GetMips() const;
+
+   // Pixels of all mips, ready to be copied to the staging buffer
+   [[nodiscard]] std::span< const std::byte >
+   GetPixels() const;
+
+ private:
+   // Returns false if the data is not a valid cooked texture
+   bool
+   SetData(std::span< const std::byte > data);
+
+   std::unique_ptr< MappedFile > mappedFile_ = nullptr;
+   std::vector< std::byte > cookedData_ = {};
+   const CookedTextureHeader* header_ = nullptr;
+   std::span< const std::byte > data_ = {};
+};
+
+[[nodiscard]] std::filesystem::path
+GetCookedTexturePath(std::string_view textureName);
+
+/**
+ * \brief Compute the hash of the source image file, used to check whether the cooked
+ * texture is up to date
+ *
+ * \param[in] pathToImage Path to the source image
+ *
+ * \return 64-bit FNV-1a hash
+ */
+[[nodiscard]] uint64_t
+ComputeTextureSourceHash(const std::filesystem::path& pathToImage);
+
+/**
+ * \brief Generate the whole mip chain of the image (box filter) and pack it into
+ * the cooked texture format
+ *
+ * \param[in] image Decoded RGBA8 image
+ * \param[in] sourceHash Hash of the source image (see \c ComputeTextureSourceHash)
+ * \param[in] srgb Whether the image holds sRGB colors (filtered in linear space)
+ * \param[in] maxMips Maximum number of mip levels to generate
+ *
+ * \return Cooked texture data
+ */
+[[nodiscard]] std::vector< std::byte >
+CookTexture(const FileManager::ImageData& image, uint64_t sourceHash, bool srgb,
+            uint32_t maxMips = std::numeric_limits< uint32_t >::max());
+
+} // namespace looper::renderer
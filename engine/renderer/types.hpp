@@ -70,6 +70,9 @@ using TextureMaps = std::array< std::string, 4 >;
 using TextureID = int32_t;
 using TextureIDs = std::array< TextureID, 4 >;
 
+// Offset (xy) and scale (zw) of texture coordinates, covers the whole texture
+constexpr glm::vec4 FULL_UV_RECT = {0.0f, 0.0f, 1.0f, 1.0f};
+
 struct UniformBufferObject
 {
    alignas(16) glm::mat4 proj = {};
@@ -77,13 +80,38 @@ struct UniformBufferObject
    glm::vec4 cameraPos = {};
 };
 
+/**
+ * \brief Sprite's 2D transform. Unit quad is scaled to \c size, rotated by \c angle (radians)
+ * and centered at \c position
+ */
+struct SpriteTransform
+{
+   glm::vec2 position = {};
+   glm::vec2 size = {};
+   float angle = 0.0f;
+};
+
+/**
+ * \brief Packed per sprite data (std430 compatible, mirrored in default.vert).
+ * The model matrix is rebuilt in the vertex shader, layer comes from the quad's depth.
+ */
 struct PerInstanceBuffer
 {
-   alignas(16) glm::mat4 model = {};
-   glm::vec4 color = {};
-   glm::vec4 texSamples = {};
+   glm::vec2 position = {};
+   glm::vec2 halfSize = {};
+   // sin and cos of the rotation angle
+   glm::vec2 rotation = {0.0f, 1.0f};
+   // RGBA8 (glm::packUnorm4x8)
+   uint32_t color = 0;
+   // Diffuse (low 16 bits) and extra (high 16 bits) texture IDs
+   uint32_t textures = 0;
+   // Sprite's region of the texture (see TextureLibrary::PrefetchAtlasTextures),
+   // offset (x) and scale (y) packed as 2x unorm16 (glm::packUnorm2x16)
+   glm::uvec2 uvRect = {0x00000000U, 0xFFFFFFFFU};
 };
 
+static_assert(sizeof(PerInstanceBuffer) == 40);
+
 using IndexType = uint32_t;
 
 } // namespace looper::renderer
@@ -20,7 +20,7 @@ struct LineVertex
 struct Vertex
 {
    glm::vec3 position_;
-   glm::vec3 texCoordsDraw_; // texcoords and drawID
+   glm::vec3 texCoordsDraw_; // texcoords (z is unused, sprites are drawn as instances)
 
    static VkVertexInputBindingDescription
    getBindingDescription();
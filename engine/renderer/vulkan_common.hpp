@@ -6,8 +6,9 @@
 #include "vertex.hpp"
 
 #include <array>
-#include <bitset>
+#include <bit>
 #include <fmt/format.h>
+#include <limits>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -123,10 +124,9 @@ inline constexpr std::array< float, NUM_LAYERS > LAYERS = {LAYER_0, LAYER_1, LAY
 static constexpr uint32_t VERTICES_PER_SPRITE = 4;
 static constexpr uint32_t INDICES_PER_SPRITE = 6;
 static constexpr uint32_t MAX_SPRITES_PER_LAYER = 100000;
-static constexpr size_t MAX_NUM_VERTICES_PER_LAYER = MAX_SPRITES_PER_LAYER * VERTICES_PER_SPRITE;
-static constexpr size_t MAX_NUM_INDICES_PER_LAYER = MAX_SPRITES_PER_LAYER * INDICES_PER_SPRITE;
 static constexpr size_t MAX_NUM_SPRITES = MAX_SPRITES_PER_LAYER * NUM_LAYERS;
-static constexpr uint32_t MAX_NUM_TEXTURES = 256;
+// Size of the (bindless) texture array, sprites can address 16 bits worth of IDs
+static constexpr uint32_t MAX_NUM_TEXTURES = 16384;
 static constexpr uint32_t INDICES_PER_LINE = 2;
 static constexpr uint32_t VERTICES_PER_LINE = 2;
 inline constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
@@ -148,6 +148,19 @@ struct RenderInfo
 
    // index in given layer
    int32_t layerIdx;
+
+   // Stable identifier of the mesh. Layers are compacted when meshes are deleted, so idx and
+   // layerIdx can change (see renderer::GetRenderInfo), the handle stays the same
+   uint32_t handle = INVALID_HANDLE;
+
+   static constexpr uint32_t INVALID_HANDLE = std::numeric_limits< uint32_t >::max();
+
+   // Handle is the mesh's slot in RenderData::handleToIdx and the slot's generation (upper
+   // bits), which changes every time the slot is freed. Handles of deleted meshes never
+   // resolve to the mesh that reused their slot.
+   static constexpr uint32_t HANDLE_SLOT_BITS =
+      static_cast< uint32_t >(std::bit_width(MAX_NUM_SPRITES));
+   static constexpr uint32_t HANDLE_SLOT_MASK = (1U << HANDLE_SLOT_BITS) - 1U;
 };
 
 struct PushConstBlock
@@ -156,6 +169,51 @@ struct PushConstBlock
    glm::vec2 translate = {};
 };
 
+/*
+ * Counters of the work that was handed to the renderer, and of the GPU work that it resulted in.
+ * Recorded in both normal and headless mode (where the GPU work is only counted).
+ */
+struct RenderStats
+{
+   uint64_t numMeshesLoaded = 0;
+   uint64_t numMeshesDeleted = 0;
+   uint64_t numMeshSubmissions = 0;
+   uint64_t numLines = 0;
+   uint64_t numFrames = 0;
+
+   uint64_t numBuffersCreated = 0;
+   uint64_t numBufferUploads = 0;
+   uint64_t numTextureUploads = 0;
+   uint64_t bytesUploaded = 0;
+   // Command buffers submitted by Command::SubmitUploads
+   uint64_t numUploadBatches = 0;
+   // Texture slots written to the descriptor array
+   uint64_t numTextureDescriptorWrites = 0;
+   // Textures dropped to their low resolution mips, and streamed back
+   // (see TextureLibrary::UpdateResidency)
+   uint64_t numTexturesEvicted = 0;
+   uint64_t numTexturesStreamedIn = 0;
+   // Draw passes recorded into their secondary command buffers, and the ones that reused them
+   uint64_t numPassesRecorded = 0;
+   uint64_t numPassesReused = 0;
+
+   // Sprites that passed (or failed) the view culling, summed over all frames
+   uint64_t numInstancesVisible = 0;
+   uint64_t numInstancesCulled = 0;
+};
+
+/*
+ * World space AABB of each sprite (indexed the same as RenderData::perInstance).
+ * Kept as separate arrays, so the culling sweep reads them linearly.
+ */
+struct InstanceBounds
+{
+   std::vector< float > minX = {};
+   std::vector< float > minY = {};
+   std::vector< float > maxX = {};
+   std::vector< float > maxY = {};
+};
+
 struct RenderData
 {
    // Store this in case we have window minimized (to prevent extent being 0x0)
@@ -167,19 +225,36 @@ struct RenderData
    //              RENDER LAYERS (from near 0.0 to far -0.9              //
    ////////////////////////////////////////////////////////////////////////
 
-   // Vertex
-   std::array< std::vector< Vertex >, NUM_LAYERS > vertices = {};
-   std::array< std::bitset< MAX_SPRITES_PER_LAYER >, NUM_LAYERS > verticesAvail = {};
-
-   std::array< Buffer, NUM_LAYERS > vertexBuffer = {};
-
-   // Index
-   std::array< std::vector< IndexType >, NUM_LAYERS > indices = {};
-   std::array< Buffer, NUM_LAYERS > indexBuffer = {};
+   // Every sprite is an instance of the unit quad. Buffer holds a copy of the quad for each layer
+   // (VERTICES_PER_SPRITE vertices, at layer's depth) and instances start at the layer's first
+   // slot. Only visible sprites are drawn, see visibleInstances below.
+   Buffer quadVertexBuffer = {};
+   Buffer quadIndexBuffer = {};
 
+   // Layers are kept packed, live sprites of each layer take slots [0, numMeshes[layer]).
+   // Deleting a sprite moves the layer's last one into its slot, so new sprites always go
+   // right after the last one and holes are never drawn.
    std::array< uint32_t, NUM_LAYERS > numMeshes = {};
    uint32_t totalNumMeshes = {};
 
+   // Remap table between mesh handles (RenderInfo::handle) and perInstance indices
+   // (-1 for deleted meshes), updated whenever a sprite is moved by the compaction
+   std::vector< int32_t > handleToIdx = {};
+   std::vector< uint32_t > idxToHandle = {};
+   // Current generation of each handle slot, and the slots that can be reused
+   std::vector< uint32_t > handleGenerations = {};
+   std::vector< uint32_t > freeHandles = {};
+
+   // Result of the view culling (done each frame in renderer::UpdateData). Visible sprites of
+   // each layer are listed from layer * MAX_SPRITES_PER_LAYER, the vertex shader reads
+   // perInstance through this list. Layers are drawn with indirect commands:
+   // {INDICES_PER_SPRITE, numVisible[layer], 0, layer * VERTICES_PER_SPRITE,
+   //  layer * MAX_SPRITES_PER_LAYER}
+   // stored in draw order (far layer first), so layer's command is NUM_LAYERS - 1 - layer.
+   InstanceBounds instanceBounds = {};
+   std::vector< uint32_t > visibleInstances = {};
+   std::array< uint32_t, NUM_LAYERS > numVisible = {};
+
    /////////////////////////////////////
    //           VULKAN DATA           //
    /////////////////////////////////////
@@ -188,9 +263,24 @@ struct RenderData
    std::vector< PerInstanceBuffer > perInstance = {};
    std::array< Buffer, MAX_FRAMES_IN_FLIGHT > ssbo = {};
 
+   // Per instance data that changed, tracked for each frame in flight. Frame's copy of the SSBO
+   // is only written once that frame is prepared again, so no other frame has to be waited for.
+   std::array< std::vector< uint32_t >, MAX_FRAMES_IN_FLIGHT > dirtyInstances = {};
+   // Bit per frame in flight, set while the instance is in that frame's dirty list
+   std::vector< uint8_t > instanceDirtyFrames = {};
+
+   // SSBO (visibleInstances) and VkDrawIndexedIndirectCommand for each layer
+   std::array< Buffer, MAX_FRAMES_IN_FLIGHT > visibleInstancesBuffer = {};
+   std::array< Buffer, MAX_FRAMES_IN_FLIGHT > indirectDrawBuffer = {};
+
    // UBO (UniformBufferObject)
    std::vector< Buffer > uniformBuffers{MAX_FRAMES_IN_FLIGHT};
 
+   // Texture slots (TextureIDs) that changed, tracked for each frame in flight. Frame's
+   // descriptor set is only written once that frame is prepared again, so it's never in use
+   // by the GPU (see renderer::UpdateTextureDescriptor)
+   std::array< std::vector< TextureID >, MAX_FRAMES_IN_FLIGHT > dirtyTextureSlots = {};
+
    VkSurfaceKHR surface = VK_NULL_HANDLE;
    GLFWwindow* windowHandle = nullptr;
 
@@ -210,7 +300,6 @@ struct RenderData
 
    VkRenderPass renderPass = VK_NULL_HANDLE;
    VkPipeline pipeline = VK_NULL_HANDLE;
-   VkPipelineCache pipelineCache = VK_NULL_HANDLE;
    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 
    VkImage depthImage = VK_NULL_HANDLE;
@@ -239,11 +328,20 @@ struct Data
    inline static VkPhysicalDevice vk_physicalDevice = VK_NULL_HANDLE;
    inline static VkQueue vk_graphicsQueue = {};
    inline static VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+   // Persisted across runs (see PIPELINE_CACHE_PATH)
+   inline static VkPipelineCache vk_pipelineCache = VK_NULL_HANDLE;
+
+   // No Vulkan objects are created, GPU work is only recorded in renderStats
+   inline static bool headless = false;
+   inline static RenderStats renderStats = {};
 
    inline static VkCommandPool commandPool = {};
    inline static std::vector< VkCommandBuffer > commandBuffers = {};
 
    inline static std::unordered_map< ApplicationType, RenderData > renderData_ = {};
+   // Bumped whenever a buffer or a pipeline is destroyed, so recorded draw passes
+   // (which could reference them) are recorded again
+   inline static uint64_t resourceGeneration = 0;
 
    inline static uint32_t currentFrame_ = {};
 };
@@ -0,0 +1,236 @@
+#include "asset_archive.hpp"
+#include "file_manager.hpp"
+#include "mapped_file.hpp"
+#include "utils/assert.hpp"
+#include "utils/time/scoped_timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace looper {
+
+static_assert(std::is_trivially_copyable_v< AssetArchiveHeader >);
+static_assert(std::is_trivially_copyable_v< AssetArchiveEntry >);
+static_assert(sizeof(AssetArchiveHeader) % ASSET_ARCHIVE_ALIGNMENT == 0);
+
+namespace {
+
+struct MountedArchive
+{
+   std::unique_ptr< MappedFile > mappedFile = nullptr;
+   std::span< const AssetArchiveEntry > entries = {};
+   std::string_view names = {};
+};
+
+MountedArchive&
+GetMountedArchive()
+{
+   static MountedArchive archive = {};
+   return archive;
+}
+
+// Derived data, specific to the machine that generated it (see TEXTURE_CACHE_DIR)
+constexpr std::string_view CACHE_DIR_NAME = "cache";
+
+size_t
+AlignOffset(size_t offset)
+{
+   return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(ASSET_ARCHIVE_ALIGNMENT - 1);
+}
+
+// Name of the file in the archive, or empty if it's outside of the assets tree
+std::string
+GetArchiveName(const std::filesystem::path& pathToFile)
+{
+   const auto relativePath =
+      std::filesystem::absolute(pathToFile).lexically_normal().lexically_relative(ASSETS_DIR);
+
+   if (relativePath.empty() or *relativePath.begin() == "..")
+   {
+      return {};
+   }
+
+   return relativePath.generic_string();
+}
+
+std::string_view
+GetEntryName(const AssetArchiveEntry& entry, std::string_view names)
+{
+   return names.substr(entry.nameOffset, entry.nameLength);
+}
+
+} // namespace
+
+/**************************************************************************************************
+ ***************************************** AssetArchive *******************************************
+ *************************************************************************************************/
+bool
+AssetArchive::Mount(const std::filesystem::path& pathToArchive)
+{
+   std::error_code errorCode;
+   const auto fileSize = std::filesystem::file_size(pathToArchive, errorCode);
+   if (errorCode or fileSize < sizeof(AssetArchiveHeader))
+   {
+      Logger::Info("AssetArchive: {} not found, using loose asset files", pathToArchive.string());
+      return false;
+   }
+
+   // Files are read in whatever order the game needs them
+   auto mappedFile =
+      std::make_unique< MappedFile >(pathToArchive, MappedFile::AccessPattern::RANDOM);
+   const auto data = mappedFile->GetData();
+
+   // NOLINTNEXTLINE
+   const auto* header = reinterpret_cast< const AssetArchiveHeader* >(data.data());
+   const auto valid =
+      header->magic == ASSET_ARCHIVE_MAGIC and header->version == ASSET_ARCHIVE_VERSION
+      and header->entriesOffset + header->numEntries * sizeof(AssetArchiveEntry) <= data.size()
+      and header->namesOffset + header->namesSize <= data.size();
+
+   if (!valid)
+   {
+      Logger::Warn("AssetArchive: {} is not a valid asset archive!", pathToArchive.string());
+      return false;
+   }
+
+   // NOLINTNEXTLINE
+   const auto* entries = reinterpret_cast< const AssetArchiveEntry* >(
+      data.data() + header->entriesOffset);
+   const auto* names = reinterpret_cast< const char* >(data.data() + header->namesOffset);
+
+   auto& archive = GetMountedArchive();
+   archive.entries = {entries, header->numEntries};
+   archive.names = {names, header->namesSize};
+   archive.mappedFile = std::move(mappedFile);
+
+   Logger::Info("AssetArchive: Mounted {} ({} files)", pathToArchive.string(),
+                archive.entries.size());
+
+   return true;
+}
+
+void
+AssetArchive::Unmount()
+{
+   GetMountedArchive() = {};
+}
+
+bool
+AssetArchive::IsMounted()
+{
+   return GetMountedArchive().mappedFile != nullptr;
+}
+
+std::optional< std::span< const std::byte > >
+AssetArchive::Find(const std::filesystem::path& pathToFile)
+{
+   const auto& archive = GetMountedArchive();
+   if (!archive.mappedFile)
+   {
+      return std::nullopt;
+   }
+
+   const auto name = GetArchiveName(pathToFile);
+   if (name.empty())
+   {
+      return std::nullopt;
+   }
+
+   const auto getName = [&archive](const AssetArchiveEntry& entry) {
+      return GetEntryName(entry, archive.names);
+   };
+   const auto entry =
+      std::ranges::lower_bound(archive.entries, std::string_view{name}, {}, getName);
+
+   if (entry == archive.entries.end() or GetEntryName(*entry, archive.names) != name)
+   {
+      return std::nullopt;
+   }
+
+   const auto data = archive.mappedFile->GetData();
+   utils::Assert(entry->offset + entry->size <= data.size(),
+                 fmt::format("AssetArchive: {} is out of bounds!", name));
+
+   return data.subspan(entry->offset, entry->size);
+}
+
+/**************************************************************************************************
+ ****************************************** Functions *********************************************
+ *************************************************************************************************/
+std::vector< std::byte >
+BuildAssetArchive(const std::filesystem::path& assetsDir)
+{
+   SCOPED_TIMER(fmt::format("Building asset archive from {}", assetsDir.string()));
+
+   std::vector< std::pair< std::string, std::filesystem::path > > files = {};
+   for (auto it = std::filesystem::recursive_directory_iterator(assetsDir);
+        it != std::filesystem::recursive_directory_iterator(); ++it)
+   {
+      const auto name = it->path().lexically_relative(assetsDir).generic_string();
+      if (it->is_directory() and name == CACHE_DIR_NAME)
+      {
+         it.disable_recursion_pending();
+         continue;
+      }
+
+      if (it->is_regular_file() and it->path().extension() != ".tmp")
+      {
+         files.emplace_back(name, it->path());
+      }
+   }
+
+   std::ranges::sort(files);
+
+   std::vector< AssetArchiveEntry > entries(files.size());
+   std::string names = {};
+   for (size_t i = 0; i < files.size(); ++i)
+   {
+      entries[i].nameOffset = static_cast< uint32_t >(names.size());
+      entries[i].nameLength = static_cast< uint32_t >(files[i].first.size());
+      names += files[i].first;
+   }
+
+   AssetArchiveHeader header = {};
+   header.numEntries = static_cast< uint32_t >(entries.size());
+   header.namesSize = static_cast< uint32_t >(names.size());
+   header.entriesOffset = AlignOffset(sizeof(AssetArchiveHeader));
+   header.namesOffset =
+      AlignOffset(header.entriesOffset + entries.size() * sizeof(AssetArchiveEntry));
+
+   auto offset = AlignOffset(header.namesOffset + names.size());
+   for (size_t i = 0; i < files.size(); ++i)
+   {
+      entries[i].offset = offset;
+      entries[i].size = std::filesystem::file_size(files[i].second);
+      offset = AlignOffset(offset + entries[i].size);
+   }
+
+   std::vector< std::byte > buffer(offset);
+   std::memcpy(buffer.data(), &header, sizeof(AssetArchiveHeader));
+   std::memcpy(buffer.data() + header.entriesOffset, entries.data(),
+               entries.size() * sizeof(AssetArchiveEntry));
+   std::memcpy(buffer.data() + header.namesOffset, names.data(), names.size());
+
+   for (size_t i = 0; i < files.size(); ++i)
+   {
+      std::ifstream fileHandle(files[i].second, std::ios::binary);
+      utils::Assert(fileHandle.is_open(),
+                    fmt::format("BuildAssetArchive: {} can't be opened!", files[i].first));
+
+      // NOLINTNEXTLINE
+      fileHandle.read(reinterpret_cast< char* >(buffer.data() + entries[i].offset),
+                      static_cast< std::streamsize >(entries[i].size));
+   }
+
+   Logger::Info("BuildAssetArchive: Packed {} files ({} bytes)", files.size(), buffer.size());
+
+   return buffer;
+}
+
+} // namespace looper
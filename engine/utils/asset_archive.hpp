@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace looper {
+
+/*
+ * Asset archive (.dgpak) packs the whole assets tree into a single file. It's mapped into memory
+ * once, and every file is served as a view into the mapping, so reading an asset doesn't open
+ * any files or copy any data.
+ *
+ * Layout (all sections are 16-byte aligned, little endian):
+ * [AssetArchiveHeader][AssetArchiveEntry * numEntries][Names][File data]
+ *
+ * Entries are sorted by their names, which are paths relative to ASSETS_DIR (with '/'
+ * separators), so the lookup is a binary search.
+ */
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x4B504744; // "DGPK"
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+constexpr size_t ASSET_ARCHIVE_ALIGNMENT = 16;
+
+struct AssetArchiveHeader
+{
+   uint32_t magic = ASSET_ARCHIVE_MAGIC;
+   uint32_t version = ASSET_ARCHIVE_VERSION;
+   uint32_t numEntries = 0;
+   uint32_t namesSize = 0;
+
+   uint64_t entriesOffset = 0;
+   uint64_t namesOffset = 0;
+};
+
+struct AssetArchiveEntry
+{
+   // Relative to the beginning of the names section
+   uint32_t nameOffset = 0;
+   uint32_t nameLength = 0;
+   // Relative to the beginning of the archive
+   uint64_t offset = 0;
+   uint64_t size = 0;
+};
+
+/**
+ * \brief Archive that's currently used by FileManager. Reads of files that aren't in the archive
+ * (or all reads, if no archive is mounted) fall back to loose files in ASSETS_DIR.
+ */
+class AssetArchive
+{
+ public:
+   /**
+    * \brief Map the archive and serve assets from it. Has to be called before any other
+    * thread reads the assets.
+    *
+    * \param[in] pathToArchive Path to the archive
+    *
+    * \return True if the archive was mounted, false if it's missing or invalid
+    */
+   static bool
+   Mount(const std::filesystem::path& pathToArchive);
+
+   static void
+   Unmount();
+
+   [[nodiscard]] static bool
+   IsMounted();
+
+   /**
+    * \brief Find the file in the mounted archive. Safe to call from multiple threads.
+    *
+    * \param[in] pathToFile Path to the file (inside ASSETS_DIR)
+    *
+    * \return View of the file's data (valid until the archive is unmounted),
+    *         or empty if it's not in the archive
+    */
+   [[nodiscard]] static std::optional< std::span< const std::byte > >
+   Find(const std::filesystem::path& pathToFile);
+};
+
+/**
+ * \brief Pack all files from the assets tree into the archive. Cached (derived) data
+ * and temporary files are skipped.
+ *
+ * \param[in] assetsDir Root of the assets tree
+ *
+ * \return Archive data
+ */
+[[nodiscard]] std::vector< std::byte >
+BuildAssetArchive(const std::filesystem::path& assetsDir);
+
+} // namespace looper
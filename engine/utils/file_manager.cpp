@@ -1,100 +1,121 @@
 #include "file_manager.hpp"
+#include "asset_archive.hpp"
 #include "utils/assert.hpp"
 
 #define STB_IMAGE_STATIC
 #define STB_IMAGE_IMPLEMENTATION
 
+#include <algorithm>
 #include <fstream>
 #include <stb_image.h>
 
 #if defined(_WIN32)
 #define NOMINMAX
 #include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif //  WIN
 
 namespace looper {
 
+MappedFile
+FileManager::MapFile(const std::filesystem::path& path, MappedFile::AccessPattern accessPattern)
+{
+   if (const auto archived = AssetArchive::Find(path))
+   {
+      utils::Assert(!archived->empty(),
+                    fmt::format("FileManager::MapFile -> {} is empty!", path.string()));
+      return MappedFile{*archived};
+   }
+
+   return MappedFile{path, accessPattern};
+}
+
 std::vector< char >
 FileManager::ReadBinaryFile(const std::filesystem::path& path)
 {
-   return ReadBinaryFile(std::string_view{path.string()});
+   const auto file = MapFile(path);
+
+   // NOLINTNEXTLINE
+   const auto* data = reinterpret_cast< const char* >(file.GetData().data());
+   return {data, data + file.GetData().size()};
 }
 
 std::vector< char >
 FileManager::ReadBinaryFile(std::string_view fileName)
 {
-   std::ifstream fileHandle(fileName.data(), std::ios::binary);
-
-   utils::Assert(fileHandle.is_open(),
-                 fmt::format("FileManager::ReadBinaryFile -> {} can't be opened!", fileName));
-
-   const auto size = std::filesystem::file_size(fileName);
-
-   utils::Assert(size, fmt::format("FileManager::ReadBinaryFile -> {} is empty!", fileName));
-
-   std::vector< char > buffer(size);
-
-   fileHandle.read(buffer.data(), static_cast< std::streamsize >(size));
-
-   return buffer;
+   return ReadBinaryFile(std::filesystem::path{fileName});
 }
 
 std::string
 FileManager::ReadFile(const std::string& fileName, FileType /*type*/)
 {
-   std::ifstream fileHandle = {};
-   fileHandle.open(fileName.c_str(), std::ifstream::in);
+   const auto file = MapFile(fileName);
 
-   if (!fileHandle.is_open())
-   {
-      Logger::Fatal("FileManager::ReadFile -> {} can't be opened!", fileName);
-   }
-
-   std::string returnVal((std::istreambuf_iterator< char >(fileHandle)),
-                         std::istreambuf_iterator< char >());
-   fileHandle.close();
-
-   if (returnVal.empty())
-   {
-      Logger::Fatal("FileManager::ReadFile -> {} is empty!", fileName);
-   }
-
-   return returnVal;
+   // NOLINTNEXTLINE
+   return {reinterpret_cast< const char* >(file.GetData().data()), file.GetData().size()};
 }
 
 FileManager::ImageData
 FileManager::LoadImageData(std::string_view fileName)
 {
-   const auto pathToImage = std::filesystem::path(IMAGES_DIR / fileName).string();
+   const auto pathToImage = std::filesystem::path(IMAGES_DIR / fileName);
    const int force_channels = STBI_rgb_alpha;
    int w = 0;
    int h = 0;
    int n = 0;
 
-   ImageHandleType textureData(stbi_load(pathToImage.c_str(), &w, &h, &n, force_channels),
-                               stbi_image_free);
+   // Decoded straight from the mapping, without reading the file into a buffer first
+   const auto file = MapFile(pathToImage);
+   const auto data = file.GetData();
+
+   // NOLINTNEXTLINE
+   const auto* bytes = reinterpret_cast< const stbi_uc* >(data.data());
+   ImageHandleType textureData(
+      stbi_load_from_memory(bytes, static_cast< int >(data.size()), &w, &h, &n, force_channels),
+      stbi_image_free);
 
    if (!textureData)
    {
-      Logger::Fatal("FileManager::LoadImage -> {} can't be opened!", pathToImage);
+      Logger::Fatal("FileManager::LoadImage -> {} can't be decoded!", pathToImage.string());
    }
 
    return {std::move(textureData), {w, h}, n};
 }
 
-nlohmann::json
-FileManager::LoadJsonFile(std::string_view pathToFile)
+glm::ivec2
+FileManager::GetImageSize(std::string_view fileName)
 {
-   std::ifstream jsonFile(std::string{pathToFile});
+   const auto pathToImage = std::filesystem::path(IMAGES_DIR / fileName);
+   int w = 0;
+   int h = 0;
+   int n = 0;
 
-   if (!jsonFile.is_open())
+   // Only the pages holding the image header are read
+   const auto file = MapFile(pathToImage, MappedFile::AccessPattern::RANDOM);
+   const auto data = file.GetData();
+
+   // NOLINTNEXTLINE
+   if (stbi_info_from_memory(reinterpret_cast< const stbi_uc* >(data.data()),
+                             static_cast< int >(data.size()), &w, &h, &n)
+       == 0)
    {
-      Logger::Fatal("FileManager::LoadJsonFile -> {} can't be opened!",
-                   pathToFile);
+      Logger::Fatal("FileManager::GetImageSize -> {} can't be decoded!", pathToImage.string());
    }
 
-   nlohmann::json json;
-   jsonFile >> json;
+   return {w, h};
+}
+
+nlohmann::json
+FileManager::LoadJsonFile(std::string_view pathToFile)
+{
+   const auto file = MapFile(pathToFile);
+
+   // Parsed in place, instead of through a stream
+   // NOLINTNEXTLINE
+   const auto* data = reinterpret_cast< const char* >(file.GetData().data());
+   auto json = nlohmann::json::parse(data, data + file.GetData().size());
 
    if (json.is_null())
    {
@@ -112,6 +133,118 @@ FileManager::SaveJsonFile(std::string_view pathToFile, const nlohmann::json& jso
    jsonFile << json;
 }
 
+void
+FileManager::SaveBinaryFile(std::string_view pathToFile, std::span< const std::byte > data)
+{
+   std::ofstream fileHandle(std::string{pathToFile}, std::ios::binary | std::ios::trunc);
+
+   utils::Assert(fileHandle.is_open(),
+                 fmt::format("FileManager::SaveBinaryFile -> {} can't be opened!", pathToFile));
+
+   // NOLINTNEXTLINE
+   fileHandle.write(reinterpret_cast< const char* >(data.data()),
+                    static_cast< std::streamsize >(data.size()));
+}
+
+bool
+FileManager::SaveBinaryFileAtomic(std::string_view pathToFile, std::span< const std::byte > data,
+                                  std::atomic< float >* progress)
+{
+   // Data is written in chunks, so that the progress can be reported
+   constexpr size_t CHUNK_SIZE = 1024 * 1024;
+
+   const auto path = std::filesystem::path{pathToFile};
+   auto tempPath = path;
+   tempPath += ".tmp";
+
+   // Leave the old file untouched and don't leave partially written data behind
+   const auto discardTempFile = [&tempPath] {
+      std::error_code errorCode;
+      std::filesystem::remove(tempPath, errorCode);
+      return false;
+   };
+
+   {
+      std::ofstream fileHandle(tempPath, std::ios::binary | std::ios::trunc);
+      if (!fileHandle.is_open())
+      {
+         Logger::Warn("FileManager::SaveBinaryFileAtomic -> {} can't be opened!",
+                      tempPath.string());
+         return discardTempFile();
+      }
+
+      for (size_t offset = 0; offset < data.size(); offset += CHUNK_SIZE)
+      {
+         const auto size = std::min(CHUNK_SIZE, data.size() - offset);
+
+         // NOLINTNEXTLINE
+         fileHandle.write(reinterpret_cast< const char* >(data.data() + offset),
+                          static_cast< std::streamsize >(size));
+
+         if (progress)
+         {
+            progress->store(static_cast< float >(offset + size)
+                            / static_cast< float >(data.size()));
+         }
+      }
+
+      if (!fileHandle.flush())
+      {
+         Logger::Warn("FileManager::SaveBinaryFileAtomic -> Writing {} failed!", tempPath.string());
+         fileHandle.close();
+         return discardTempFile();
+      }
+   }
+
+   if (!SyncFile(tempPath))
+   {
+      Logger::Warn("FileManager::SaveBinaryFileAtomic -> Flushing {} to disk failed!",
+                   tempPath.string());
+      return discardTempFile();
+   }
+
+   // Replaces the old file in a single step
+   std::error_code errorCode;
+   std::filesystem::rename(tempPath, path, errorCode);
+   if (errorCode)
+   {
+      Logger::Warn("FileManager::SaveBinaryFileAtomic -> {} can't be replaced ({})!", pathToFile,
+                   errorCode.message());
+      return discardTempFile();
+   }
+
+   return true;
+}
+
+bool
+FileManager::SyncFile(const std::filesystem::path& pathToFile)
+{
+#if defined(_WIN32)
+   auto* fileHandle =
+      CreateFileW(pathToFile.wstring().c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (fileHandle == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   const auto synced = FlushFileBuffers(fileHandle) != 0;
+   CloseHandle(fileHandle);
+#else
+   // NOLINTNEXTLINE
+   const auto fileHandle = open(pathToFile.c_str(), O_WRONLY);
+   if (fileHandle == -1)
+   {
+      return false;
+   }
+
+   const auto synced = fsync(fileHandle) == 0;
+   close(fileHandle);
+#endif
+
+   return synced;
+}
+
 std::string
 FileManager::FileDialog(const std::filesystem::path& defaultPath,
                         const std::vector< std::pair< std::string, std::string > >& fileTypes,
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "logger.hpp"
+#include "mapped_file.hpp"
 
+#include <atomic>
 #include <filesystem>
 #include <glm/glm.hpp>
 #undef max
 #undef min
 #include <nlohmann/json.hpp>
+#include <span>
 #include <string_view>
 
 namespace looper {
@@ -18,6 +21,10 @@ const auto LEVELS_DIR = ASSETS_DIR / "levels" / "";
 const auto FONTS_DIR = ASSETS_DIR / "fonts" / "";
 const auto SHADERS_DIR = ASSETS_DIR / "shaders" / "";
 const auto IMAGES_DIR = ASSETS_DIR / "images" / "";
+const auto TEXTURE_CACHE_DIR = ASSETS_DIR / "cache" / "textures" / "";
+const auto PIPELINE_CACHE_PATH = ASSETS_DIR / "cache" / "pipeline_cache.bin";
+// Packed assets tree (see asset_archive.hpp), built by AssetCooker
+const auto ASSET_ARCHIVE_PATH = ROOT_DIR / "assets.dgpak";
 // NOLINTEND
 class FileManager
 {
@@ -38,6 +45,19 @@ class FileManager
       TEXT
    };
 
+   /**
+    * \brief Map the file into memory. Files from the mounted asset archive (see asset_archive.hpp)
+    * are served straight from the archive's mapping.
+    *
+    * \param[in] path Path to the file
+    * \param[in] accessPattern How the file is going to be read
+    *
+    * \return Mapped file
+    */
+   static MappedFile
+   MapFile(const std::filesystem::path& path,
+           MappedFile::AccessPattern accessPattern = MappedFile::AccessPattern::SEQUENTIAL);
+
    static std::vector< char >
    ReadBinaryFile(const std::filesystem::path& path);
 
@@ -50,12 +70,44 @@ class FileManager
    static ImageData
    LoadImageData(std::string_view fileName);
 
+   // Read image's size from its header, without decoding it
+   static glm::ivec2
+   GetImageSize(std::string_view fileName);
+
    static nlohmann::json
    LoadJsonFile(std::string_view pathToFile);
 
    static void
    SaveJsonFile(std::string_view pathToFile, const nlohmann::json& json);
 
+   static void
+   SaveBinaryFile(std::string_view pathToFile, std::span< const std::byte > data);
+
+   /**
+    * \brief Write data to a temporary file and rename it over \c pathToFile, so that the file
+    * is either fully replaced or left untouched. Can be called from worker threads.
+    *
+    * \param[in] pathToFile Path to the file
+    * \param[in] data Data to write
+    * \param[out] progress Optional, updated with the fraction of data that's written
+    *
+    * \return True if the file was written
+    */
+   static bool
+   SaveBinaryFileAtomic(std::string_view pathToFile, std::span< const std::byte > data,
+                        std::atomic< float >* progress = nullptr);
+
+   /**
+    * \brief Flush file's data from OS caches to the disk. Has to be done before the file is
+    * renamed over another one, otherwise the rename can reach the disk before the data.
+    *
+    * \param[in] pathToFile Path to the existing file
+    *
+    * \return True if the data is on the disk
+    */
+   static bool
+   SyncFile(const std::filesystem::path& pathToFile);
+
    /**
     * \brief Return file path to selected file
     *
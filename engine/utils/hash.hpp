@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace looper::utils {
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+constexpr uint64_t FNV_PRIME = 0x100000001B3;
+
+/**
+ * \brief Compute 64-bit FNV-1a hash of given data. Hashes can be chained by passing
+ * the previous result as \c hash.
+ *
+ * \param[in] data Data to hash
+ * \param[in] hash Initial hash value
+ *
+ * \return Hash value
+ */
+[[nodiscard]] inline uint64_t
+HashBytes(std::span< const std::byte > data, uint64_t hash = FNV_OFFSET_BASIS)
+{
+   for (const auto byte : data)
+   {
+      hash = (hash ^ static_cast< uint8_t >(byte)) * FNV_PRIME;
+   }
+
+   return hash;
+}
+
+template < typename T >
+[[nodiscard]] uint64_t
+HashValue(const T& value, uint64_t hash = FNV_OFFSET_BASIS)
+{
+   static_assert(std::is_trivially_copyable_v< T >);
+
+   return HashBytes(std::as_bytes(std::span< const T, 1 >{&value, 1}), hash);
+}
+
+} // namespace looper::utils
@@ -0,0 +1,183 @@
+#include "mapped_file.hpp"
+#include "utils/assert.hpp"
+
+#include <fmt/format.h>
+
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace looper {
+
+namespace {
+
+// Smallest page size of supported platforms, touching every page brings the whole file in
+constexpr size_t PREFETCH_STRIDE = 4096;
+
+} // namespace
+
+MappedFile::MappedFile(const std::filesystem::path& path, AccessPattern accessPattern)
+   : owned_(true)
+{
+#if defined(_WIN32)
+   const auto flags = accessPattern == AccessPattern::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN
+                                                                 : FILE_FLAG_RANDOM_ACCESS;
+   fileHandle_ = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, flags, nullptr);
+   utils::Assert(fileHandle_ != INVALID_HANDLE_VALUE,
+                 fmt::format("MappedFile: {} can't be opened!", path.string()));
+
+   LARGE_INTEGER fileSize = {};
+   GetFileSizeEx(fileHandle_, &fileSize);
+   size_ = static_cast< size_t >(fileSize.QuadPart);
+   utils::Assert(size_ > 0, fmt::format("MappedFile: {} is empty!", path.string()));
+
+   mappingHandle_ = CreateFileMappingW(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   utils::Assert(mappingHandle_ != nullptr,
+                 fmt::format("MappedFile: {} can't be mapped!", path.string()));
+
+   data_ = static_cast< const std::byte* >(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+#else
+   const auto fileDescriptor = open(path.c_str(), O_RDONLY); // NOLINT
+   utils::Assert(fileDescriptor != -1,
+                 fmt::format("MappedFile: {} can't be opened!", path.string()));
+
+   struct stat fileStat = {};
+   fstat(fileDescriptor, &fileStat);
+   size_ = static_cast< size_t >(fileStat.st_size);
+   utils::Assert(size_ > 0, fmt::format("MappedFile: {} is empty!", path.string()));
+
+   auto* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+   // Mapping stays valid after the descriptor is closed
+   close(fileDescriptor);
+
+   utils::Assert(mapped != MAP_FAILED, // NOLINT
+                 fmt::format("MappedFile: {} can't be mapped!", path.string()));
+
+   madvise(mapped, size_,
+           accessPattern == AccessPattern::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+   data_ = static_cast< const std::byte* >(mapped);
+#endif
+
+   utils::Assert(data_ != nullptr, fmt::format("MappedFile: {} can't be mapped!", path.string()));
+}
+
+MappedFile::MappedFile(std::span< const std::byte > view) : data_(view.data()), size_(view.size())
+{
+}
+
+MappedFile::~MappedFile()
+{
+   Release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+   *this = std::move(other);
+}
+
+MappedFile&
+MappedFile::operator=(MappedFile&& other) noexcept
+{
+   if (this != &other)
+   {
+      Release();
+
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      owned_ = std::exchange(other.owned_, false);
+      prefetch_ = std::move(other.prefetch_);
+#if defined(_WIN32)
+      fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+      mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+   }
+
+   return *this;
+}
+
+std::span< const std::byte >
+MappedFile::GetData() const
+{
+   return {data_, size_};
+}
+
+void
+MappedFile::Prefetch()
+{
+   if (!data_ or prefetch_.valid())
+   {
+      return;
+   }
+
+#if !defined(_WIN32)
+   if (owned_)
+   {
+      // NOLINTNEXTLINE
+      madvise(const_cast< std::byte* >(data_), size_, MADV_WILLNEED);
+   }
+#endif
+
+   prefetch_ = std::async(std::launch::async, [data = data_, size = size_] {
+      // Page faults are taken here, instead of on the thread that reads the file
+      auto sum = std::byte{};
+      for (size_t offset = 0; offset < size; offset += PREFETCH_STRIDE)
+      {
+         sum |= *static_cast< const volatile std::byte* >(data + offset);
+      }
+      static_cast< void >(sum);
+   });
+}
+
+void
+MappedFile::Release()
+{
+   if (prefetch_.valid())
+   {
+      prefetch_.wait();
+   }
+
+   if (owned_)
+   {
+#if defined(_WIN32)
+      if (data_)
+      {
+         UnmapViewOfFile(data_);
+      }
+      if (mappingHandle_)
+      {
+         CloseHandle(mappingHandle_);
+      }
+      if (fileHandle_ and fileHandle_ != INVALID_HANDLE_VALUE)
+      {
+         CloseHandle(fileHandle_);
+      }
+#else
+      if (data_)
+      {
+         // NOLINTNEXTLINE
+         munmap(const_cast< std::byte* >(data_), size_);
+      }
+#endif
+   }
+
+   data_ = nullptr;
+   size_ = 0;
+   owned_ = false;
+   prefetch_ = {};
+#if defined(_WIN32)
+   fileHandle_ = nullptr;
+   mappingHandle_ = nullptr;
+#endif
+}
+
+} // namespace looper
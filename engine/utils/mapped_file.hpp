@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <span>
+
+namespace looper {
+
+/**
+ * \brief Read-only memory mapping of a file. The mapping is released on destruction.
+ * Files are read in place, without copying them into intermediate buffers.
+ */
+class MappedFile
+{
+ public:
+   // Hint for the kernel's read-ahead
+   enum class AccessPattern
+   {
+      SEQUENTIAL = 0,
+      RANDOM
+   };
+
+   explicit MappedFile(const std::filesystem::path& path,
+                       AccessPattern accessPattern = AccessPattern::SEQUENTIAL);
+
+   // View of data that's owned by someone else (e.g. file in the asset archive)
+   explicit MappedFile(std::span< const std::byte > view);
+
+   MappedFile() = default;
+   ~MappedFile();
+
+   MappedFile(const MappedFile&) = delete;
+   MappedFile&
+   operator=(const MappedFile&) = delete;
+   MappedFile(MappedFile&& other) noexcept;
+   MappedFile&
+   operator=(MappedFile&& other) noexcept;
+
+   [[nodiscard]] std::span< const std::byte >
+   GetData() const;
+
+   /**
+    * \brief Start reading the whole file into memory on a background thread, so that later
+    * accesses don't stall on disk reads. The mapping waits for it before it's released.
+    */
+   void
+   Prefetch();
+
+ private:
+   void
+   Release();
+
+   const std::byte* data_ = nullptr;
+   size_t size_ = 0;
+   bool owned_ = false;
+   std::future< void > prefetch_ = {};
+
+#if defined(_WIN32)
+   void* fileHandle_ = nullptr;
+   void* mappingHandle_ = nullptr;
+#endif
+};
+
+} // namespace looper
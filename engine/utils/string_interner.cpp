@@ -0,0 +1,92 @@
+#include "string_interner.hpp"
+#include "assert.hpp"
+
+#include <fmt/format.h>
+
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace looper::utils {
+
+namespace {
+
+struct StringTable
+{
+   std::shared_mutex mutex = {};
+   // Deque never moves its elements, so the views used as keys stay valid
+   std::deque< std::string > strings = {};
+   std::unordered_map< std::string_view, StringID > ids = {};
+};
+
+// Constructed on first use, so it's safe to intern strings during static initialization
+StringTable&
+GetTable()
+{
+   static StringTable table = {};
+   return table;
+}
+
+} // namespace
+
+StringID
+StringInterner::Intern(std::string_view string)
+{
+   auto& table = GetTable();
+
+   {
+      const std::shared_lock lock(table.mutex);
+      const auto it = table.ids.find(string);
+      if (it != table.ids.end())
+      {
+         return it->second;
+      }
+   }
+
+   const std::unique_lock lock(table.mutex);
+
+   // Some other thread might have added it in the meantime
+   const auto it = table.ids.find(string);
+   if (it != table.ids.end())
+   {
+      return it->second;
+   }
+
+   utils::Assert(table.strings.size() < std::numeric_limits< uint32_t >::max(),
+                 "StringInterner: Too many strings!");
+
+   const auto id = static_cast< StringID >(table.strings.size());
+   const auto& interned = table.strings.emplace_back(string);
+   table.ids.emplace(interned, id);
+
+   return id;
+}
+
+const std::string&
+StringInterner::GetString(StringID id)
+{
+   auto& table = GetTable();
+   const std::shared_lock lock(table.mutex);
+
+   const auto idx = static_cast< size_t >(id);
+   // Lookups are frequent, so the message is only formatted for invalid IDs
+   if (idx >= table.strings.size())
+   {
+      utils::Assert(false, fmt::format("StringInterner: Invalid string ID {}!", idx));
+   }
+
+   return table.strings[idx];
+}
+
+size_t
+StringInterner::GetNumStrings()
+{
+   auto& table = GetTable();
+   const std::shared_lock lock(table.mutex);
+
+   return table.strings.size();
+}
+
+} // namespace looper::utils
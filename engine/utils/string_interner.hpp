@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace looper::utils {
+
+/*
+ * Compact handle of an interned string. Equal strings share the same ID, so comparing or hashing
+ * the names (textures, objects, editor groups) is a single integer operation, and objects don't
+ * hold their own copy of the string.
+ */
+enum class StringID : uint32_t
+{
+};
+
+/**
+ * \brief Global, thread-safe string table. Interned strings are never freed, so references
+ * returned by \c GetString stay valid for the lifetime of the application.
+ */
+class StringInterner
+{
+ public:
+   /**
+    * \brief Get ID of the string, adding it to the table if it's not there yet
+    *
+    * \param[in] string String to intern
+    *
+    * \return ID of the string
+    */
+   [[nodiscard]] static StringID
+   Intern(std::string_view string);
+
+   /**
+    * \brief Get the string with given ID
+    *
+    * \param[in] id ID returned by \c Intern
+    *
+    * \return Interned string
+    */
+   [[nodiscard]] static const std::string&
+   GetString(StringID id);
+
+   [[nodiscard]] static size_t
+   GetNumStrings();
+};
+
+} // namespace looper::utils
@@ -1,11 +1,19 @@
 #include "game.hpp"
+#include "renderer/renderer.hpp"
+#include "utils/asset_archive.hpp"
+#include "utils/file_manager.hpp"
 
 int
 main(int /* argc */, char** /* argv */)
 {
+   // Falls back to loose asset files if the archive isn't built
+   looper::AssetArchive::Mount(looper::ASSET_ARCHIVE_PATH);
+
    looper::Game game;
    game.Init("GameInit.json");
    game.MainLoop();
 
+   looper::renderer::FreeData(looper::renderer::ApplicationType::GAME, true);
+
    return EXIT_SUCCESS;
 }
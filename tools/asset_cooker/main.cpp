@@ -0,0 +1,40 @@
+#include "logger/logger.hpp"
+#include "utils/asset_archive.hpp"
+#include "utils/file_manager.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <span>
+
+// Packs the assets tree into the asset archive (see asset_archive.hpp).
+// Usage: AssetCooker [output file] [assets directory]
+int
+main(int argc, char** argv)
+{
+   const auto args = std::span< char* >{argv, static_cast< size_t >(argc)};
+   if (args.size() > 3)
+   {
+      looper::Logger::Warn("Usage: {} [output file] [assets directory]", args[0]);
+      return EXIT_FAILURE;
+   }
+
+   const auto outputPath =
+      args.size() > 1 ? std::filesystem::path{args[1]} : looper::ASSET_ARCHIVE_PATH;
+   const auto assetsDir = args.size() > 2 ? std::filesystem::path{args[2]} : looper::ASSETS_DIR;
+
+   if (!std::filesystem::is_directory(assetsDir))
+   {
+      looper::Logger::Warn("Assets directory {} doesn't exist!", assetsDir.string());
+      return EXIT_FAILURE;
+   }
+
+   const auto archive = looper::BuildAssetArchive(assetsDir);
+   if (!looper::FileManager::SaveBinaryFileAtomic(outputPath.string(), archive))
+   {
+      return EXIT_FAILURE;
+   }
+
+   looper::Logger::Info("Asset archive saved to {}", outputPath.string());
+
+   return EXIT_SUCCESS;
+}
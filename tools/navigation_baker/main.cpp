@@ -0,0 +1,34 @@
+#include "logger/logger.hpp"
+#include "navigation_bake.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <span>
+
+// Bakes navigation data (see navigation_bake.hpp) for given level files, without the renderer.
+// Usage: NavigationBaker <level file>...
+int
+main(int argc, char** argv)
+{
+   const auto args = std::span< char* >{argv, static_cast< size_t >(argc)};
+   if (args.size() < 2)
+   {
+      looper::Logger::Warn("Usage: {} <level file>...", args[0]);
+      return EXIT_FAILURE;
+   }
+
+   auto success = true;
+   for (const auto* pathToLevel : args.subspan(1))
+   {
+      if (!std::filesystem::exists(pathToLevel))
+      {
+         looper::Logger::Warn("Level file {} doesn't exist!", pathToLevel);
+         success = false;
+         continue;
+      }
+
+      success = looper::BakeNavigationFile(pathToLevel) and success;
+   }
+
+   return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+#include "application.hpp"
+#include "logger/logger.hpp"
+#include "renderer/renderer.hpp"
+#include "renderer/texture.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Size of the view that sprites are culled against
+constexpr glm::ivec2 VIEW_SIZE = {1920, 1080};
+
+// Application without a window, that loads levels with the headless renderer
+class HeadlessApplication : public looper::Application
+{
+ public:
+   HeadlessApplication()
+   {
+      looper::renderer::InitializeHeadless(looper::renderer::ApplicationType::GAME);
+   }
+
+   // Load the whole level at once and place the camera on the player
+   void
+   LoadLevel(const std::string& pathToLevel)
+   {
+      StartLevelLoading(pathToLevel);
+      FinishLevelLoading();
+      looper::renderer::TextureLibrary::UploadLoadedTextures(true);
+
+      camera_.Create(glm::vec3(currentLevel_->GetPlayer().GetCenteredPosition(), 0.0f),
+                     VIEW_SIZE);
+      camera_.SetLevelSize(currentLevel_->GetSize());
+   }
+
+   void
+   RenderFrame()
+   {
+      auto& renderData = looper::renderer::GetRenderData();
+      renderData.viewMat = camera_.GetViewMatrix();
+      renderData.projMat = camera_.GetProjectionMatrix();
+
+      looper::renderer::UpdateData();
+      looper::renderer::Render(this);
+   }
+
+   void
+   Render(std::vector< looper::renderer::DrawPass >& /* passes */) override
+   {
+   }
+
+   void
+   MainLoop() override
+   {
+   }
+
+   [[nodiscard]] glm::vec2
+   GetWindowSize() const override
+   {
+      return VIEW_SIZE;
+   }
+
+   [[nodiscard]] const glm::mat4&
+   GetProjection() const override
+   {
+      return camera_.GetProjectionMatrix();
+   }
+
+   [[nodiscard]] const glm::mat4&
+   GetViewMatrix() const override
+   {
+      return camera_.GetViewMatrix();
+   }
+
+   [[nodiscard]] float
+   GetZoomLevel() const override
+   {
+      return camera_.GetZoomLevel();
+   }
+
+ protected:
+   [[nodiscard]] bool
+   IsRunning() const override
+   {
+      return false;
+   }
+};
+
+bool
+Check(bool condition, std::string_view pathToLevel, std::string_view description)
+{
+   if (!condition)
+   {
+      looper::Logger::Warn("{}: {}!", pathToLevel, description);
+   }
+
+   return condition;
+}
+
+bool
+CheckLevel(const std::string& pathToLevel)
+{
+   HeadlessApplication application;
+   looper::renderer::ResetRenderStats();
+   application.LoadLevel(pathToLevel);
+
+   const auto loadStats = looper::renderer::GetRenderStats();
+   const auto numMeshes = looper::renderer::GetRenderData().totalNumMeshes;
+
+   // Single frame with the camera on the player
+   looper::renderer::ResetRenderStats();
+   application.RenderFrame();
+   const auto frameStats = looper::renderer::GetRenderStats();
+
+   looper::Logger::Info(
+      "{}: {} meshes loaded ({} live), {} textures uploaded, {} bytes uploaded while loading",
+      pathToLevel, loadStats.numMeshesLoaded, numMeshes, loadStats.numTextureUploads,
+      loadStats.bytesUploaded);
+   looper::Logger::Info("{}: {} sprites visible, {} culled, {} bytes uploaded in the frame",
+                        pathToLevel, frameStats.numInstancesVisible,
+                        frameStats.numInstancesCulled, frameStats.bytesUploaded);
+
+   auto success = Check(numMeshes > 0, pathToLevel, "No meshes were loaded");
+   success = Check(loadStats.numMeshesLoaded >= numMeshes, pathToLevel,
+                   "Live meshes weren't all registered through MeshLoaded")
+             and success;
+   success = Check(loadStats.bytesUploaded > 0, pathToLevel, "Nothing was uploaded") and success;
+   success = Check(frameStats.numInstancesVisible > 0, pathToLevel,
+                   "Nothing is visible around the player")
+             and success;
+   success = Check(frameStats.numInstancesVisible + frameStats.numInstancesCulled == numMeshes,
+                   pathToLevel, "Culling didn't consider every mesh")
+             and success;
+
+   return success;
+}
+
+} // namespace
+
+// Loads given level files with the headless renderer (see renderer::InitializeHeadless)
+// and checks the work that was handed to the renderer (see renderer::RenderStats).
+// Usage: RenderCheck <level file>...
+int
+main(int argc, char** argv)
+{
+   const auto args = std::span< char* >{argv, static_cast< size_t >(argc)};
+   if (args.size() < 2)
+   {
+      looper::Logger::Warn("Usage: {} <level file>...", args[0]);
+      return EXIT_FAILURE;
+   }
+
+   auto success = true;
+   for (const auto* pathToLevel : args.subspan(1))
+   {
+      if (!std::filesystem::exists(pathToLevel))
+      {
+         looper::Logger::Warn("Level file {} doesn't exist!", pathToLevel);
+         success = false;
+         continue;
+      }
+
+      success = CheckLevel(pathToLevel) and success;
+
+      // Next level starts with a clean renderer
+      looper::renderer::FreeData(looper::renderer::ApplicationType::GAME, true);
+   }
+
+   return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}